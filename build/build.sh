@@ -8,4 +8,4 @@ LIB_PATH="-L/mingw64/lib"
 LIBS="-lglew32 -lglfw3 -lgdi32 -lopengl32"
 
 # Compilez le programme en incluant les fichiers sources d'ImGui
-g++ -o main_scene ../src/main.cpp ../include/imgui.cpp ../include/imgui_draw.cpp ../include/imgui_tables.cpp ../include/imgui_widgets.cpp ../include/imgui_impl_glfw.cpp ../include/imgui_impl_opengl3.cpp ../include/tiny_obj_loader.cc $INCLUDE_PATH $LIB_PATH $LIBS
+g++ -o main_scene ../src/main.cpp ../src/shader_utils.cpp ../src/scene_renderer.cpp ../src/shader_variants.cpp ../src/color_grading.cpp ../src/materials.cpp ../src/sdf_scene.cpp ../src/scene_editor.cpp ../src/static_field.cpp ../src/dynamic_resolution.cpp ../src/cpu/thread_pool.cpp ../src/headless.cpp ../src/image_io.cpp ../src/uniform_ring.cpp ../src/program_cache.cpp ../src/shader_compiler.cpp ../src/gpu_profiler.cpp ../src/benchmark.cpp ../src/scene_picking.cpp ../include/imgui.cpp ../include/imgui_draw.cpp ../include/imgui_tables.cpp ../include/imgui_widgets.cpp ../include/imgui_impl_glfw.cpp ../include/imgui_impl_opengl3.cpp ../include/tiny_obj_loader.cc $INCLUDE_PATH $LIB_PATH $LIBS
@@ -8,4 +8,4 @@ LIB_PATH="-L/mingw64/lib"
 LIBS="-lglew32 -lglfw3 -lgdi32 -lopengl32"
 
 # Compilez le programme en incluant les fichiers sources d'ImGui
-g++ -o tinyobj_loader ../src/tinyobj.cpp ../include/imgui.cpp ../include/imgui_draw.cpp ../include/imgui_tables.cpp ../include/imgui_widgets.cpp ../include/imgui_impl_glfw.cpp ../include/imgui_impl_opengl3.cpp ../include/tiny_obj_loader.cc $INCLUDE_PATH $LIB_PATH $LIBS
+g++ -o tinyobj_loader ../src/tinyobj.cpp ../src/uniform_ring.cpp ../src/program_cache.cpp ../src/gpu_profiler.cpp ../include/imgui.cpp ../include/imgui_draw.cpp ../include/imgui_tables.cpp ../include/imgui_widgets.cpp ../include/imgui_impl_glfw.cpp ../include/imgui_impl_opengl3.cpp ../include/tiny_obj_loader.cc $INCLUDE_PATH $LIB_PATH $LIBS
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+# Microbenchmark du portage CPU de la scène (scalaire, SSE 4x, AVX2 8x)
+# -march=native active les jeux d'instructions SIMD disponibles sur la machine
+g++ -std=c++17 -O3 -march=native -o cpu_bench ../src/cpu/cpu_bench.cpp ../src/image_io.cpp
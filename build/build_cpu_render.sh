@@ -0,0 +1,4 @@
+#!/bin/bash
+
+# Rendu CPU multithread par tuiles (paquets SIMD choisis selon -march=native)
+g++ -std=c++17 -O3 -march=native -pthread -o cpu_render ../src/cpu/cpu_render_main.cpp ../src/cpu/cpu_renderer.cpp ../src/cpu/thread_pool.cpp ../src/image_io.cpp
@@ -0,0 +1,16 @@
+#!/bin/bash
+
+# Compilation Linux de main_scene avec le mode hors écran (--headless egl|osmesa)
+INCLUDE_PATH="-Iinclude"
+
+# HEADLESS_EGL active le contexte EGL surfaceless, HEADLESS_OSMESA le contexte OSMesa
+DEFINES="-DHEADLESS_EGL"
+LIBS="-lGLEW -lglfw -lEGL -lGL"
+
+if [ "$1" == "--osmesa" ]; then
+    DEFINES="$DEFINES -DHEADLESS_OSMESA"
+    LIBS="$LIBS -lOSMesa"
+fi
+
+# Compilez le programme en incluant les fichiers sources d'ImGui
+g++ -std=c++17 -O2 -pthread $DEFINES -o main_scene ../src/main.cpp ../src/shader_utils.cpp ../src/scene_renderer.cpp ../src/shader_variants.cpp ../src/color_grading.cpp ../src/materials.cpp ../src/sdf_scene.cpp ../src/scene_editor.cpp ../src/static_field.cpp ../src/dynamic_resolution.cpp ../src/cpu/thread_pool.cpp ../src/headless.cpp ../src/image_io.cpp ../src/uniform_ring.cpp ../src/program_cache.cpp ../src/shader_compiler.cpp ../src/gpu_profiler.cpp ../src/benchmark.cpp ../src/scene_picking.cpp ../include/imgui.cpp ../include/imgui_draw.cpp ../include/imgui_tables.cpp ../include/imgui_widgets.cpp ../include/imgui_impl_glfw.cpp ../include/imgui_impl_opengl3.cpp $INCLUDE_PATH $LIBS
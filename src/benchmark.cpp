@@ -0,0 +1,212 @@
+#include "benchmark.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// À incrémenter quand les colonnes du fichier changent
+static const char* const kRecordingHeader = "# main_scene input recording v1";
+
+void startInputRecording(InputRecorder& recorder) {
+    recorder.active = true;
+    recorder.start = std::chrono::steady_clock::now();
+    recorder.recording.samples.clear();
+}
+
+void recordInputSample(InputRecorder& recorder, const SceneParams& params, int width, int height) {
+    if (!recorder.active || width <= 0 || height <= 0) {
+        return;
+    }
+    InputSample sample;
+    sample.clock = std::chrono::duration<double>(std::chrono::steady_clock::now() - recorder.start).count();
+    sample.time = params.time;
+    sample.mouseU = params.mouseX / width;
+    sample.mouseV = params.mouseY / height;
+    sample.fov = params.fov;
+    sample.objectPosition = params.objectPosition;
+    sample.objectRotation = glm::vec3(params.objectRotationX, params.objectRotationY, params.objectRotationZ);
+    recorder.recording.samples.push_back(sample);
+}
+
+bool saveInputRecording(const InputRecording& recording, const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << kRecordingHeader << "\n"
+         << "# clock time mouseU mouseV fov positionX positionY positionZ rotationX rotationY rotationZ\n";
+    // 17 chiffres pour clock (double) et 9 pour le reste (float) : les valeurs sont relues au bit près
+    for (const InputSample& s : recording.samples) {
+        file << std::setprecision(17) << s.clock << std::setprecision(9) << " " << s.time << " " << s.mouseU << " "
+             << s.mouseV << " " << s.fov << " " << s.objectPosition.x << " " << s.objectPosition.y << " "
+             << s.objectPosition.z << " " << s.objectRotation.x << " " << s.objectRotation.y << " "
+             << s.objectRotation.z << "\n";
+    }
+    return (bool)file;
+}
+
+bool loadInputRecording(const std::string& path, InputRecording& recording) {
+    std::ifstream file(path);
+    std::string line;
+    if (!file || !std::getline(file, line) || line != kRecordingHeader) {
+        return false;
+    }
+    recording.samples.clear();
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream in(line);
+        InputSample s;
+        in >> s.clock >> s.time >> s.mouseU >> s.mouseV >> s.fov >> s.objectPosition.x >> s.objectPosition.y
+           >> s.objectPosition.z >> s.objectRotation.x >> s.objectRotation.y >> s.objectRotation.z;
+        if (!in || (!recording.samples.empty() && s.clock < recording.samples.back().clock)) {
+            return false;
+        }
+        recording.samples.push_back(s);
+    }
+    return !recording.samples.empty();
+}
+
+double inputRecordingDuration(const InputRecording& recording) {
+    if (recording.samples.empty()) {
+        return 0.0;
+    }
+    return recording.samples.back().clock - recording.samples.front().clock;
+}
+
+void applyInputRecording(const InputRecording& recording, double clock, int width, int height, SceneParams& params) {
+    const std::vector<InputSample>& samples = recording.samples;
+    if (samples.empty()) {
+        return;
+    }
+    // Premier échantillon strictement après clock ; avant le premier ou après le dernier, l'état est figé
+    clock += samples.front().clock;
+    auto next = std::upper_bound(samples.begin(), samples.end(), clock,
+                                 [](double value, const InputSample& s) { return value < s.clock; });
+    const InputSample& a = next == samples.begin() ? samples.front() : *(next - 1);
+    const InputSample& b = next == samples.end() ? samples.back() : *next;
+    float t = b.clock > a.clock ? (float)((clock - a.clock) / (b.clock - a.clock)) : 0.0f;
+
+    params.time = glm::mix(a.time, b.time, t);
+    params.mouseX = glm::mix(a.mouseU, b.mouseU, t) * width;
+    params.mouseY = glm::mix(a.mouseV, b.mouseV, t) * height;
+    params.fov = glm::mix(a.fov, b.fov, t);
+    params.objectPosition = glm::mix(a.objectPosition, b.objectPosition, t);
+    glm::vec3 rotation = glm::mix(a.objectRotation, b.objectRotation, t);
+    params.objectRotationX = rotation.x;
+    params.objectRotationY = rotation.y;
+    params.objectRotationZ = rotation.z;
+}
+
+// Rang le plus proche : plus petite valeur dont au moins percent % des mesures sont inférieures ou égales
+static double percentile(const std::vector<double>& sorted, double percent) {
+    size_t rank = (size_t)std::ceil(percent / 100.0 * sorted.size());
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+FrameTimeStats computeFrameTimeStats(std::vector<double> frameMs) {
+    FrameTimeStats stats;
+    if (frameMs.empty()) {
+        return stats;
+    }
+    std::sort(frameMs.begin(), frameMs.end());
+    stats.frames = (int)frameMs.size();
+    double sum = 0.0;
+    for (double ms : frameMs) {
+        sum += ms;
+    }
+    stats.mean = sum / frameMs.size();
+    stats.p50 = percentile(frameMs, 50.0);
+    stats.p95 = percentile(frameMs, 95.0);
+    stats.p99 = percentile(frameMs, 99.0);
+    stats.min = frameMs.front();
+    stats.max = frameMs.back();
+    return stats;
+}
+
+static std::string jsonString(const std::string& value) {
+    std::string escaped = "\"";
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+static void writeStats(std::ostream& out, const FrameTimeStats& stats) {
+    out << "{ \"frames\": " << stats.frames << ", \"mean\": " << stats.mean << ", \"p50\": " << stats.p50
+        << ", \"p95\": " << stats.p95 << ", \"p99\": " << stats.p99 << ", \"min\": " << stats.min
+        << ", \"max\": " << stats.max << " }";
+}
+
+static double changePercent(double value, double baseline) {
+    return baseline > 0.0 ? (value - baseline) / baseline * 100.0 : 0.0;
+}
+
+bool writeBenchmarkReport(const std::string& path, const BenchmarkReport& report, const FrameTimeStats* baseline) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << std::fixed << std::setprecision(4);
+    file << "{\n"
+         << "  \"recording\": " << jsonString(report.recording) << ",\n"
+         << "  \"width\": " << report.width << ",\n"
+         << "  \"height\": " << report.height << ",\n"
+         << "  \"timestep\": " << report.timestep << ",\n"
+         << "  \"warmupFrames\": " << report.warmupFrames << ",\n"
+         << "  \"frameMs\": ";
+    writeStats(file, report.frameMs);
+    if (baseline) {
+        file << ",\n  \"baselineFrameMs\": ";
+        writeStats(file, *baseline);
+        file << ",\n  \"changePercent\": { \"mean\": " << changePercent(report.frameMs.mean, baseline->mean)
+             << ", \"p50\": " << changePercent(report.frameMs.p50, baseline->p50)
+             << ", \"p95\": " << changePercent(report.frameMs.p95, baseline->p95)
+             << ", \"p99\": " << changePercent(report.frameMs.p99, baseline->p99) << " }";
+    }
+    file << "\n}\n";
+    return (bool)file;
+}
+
+// Valeur numérique de "key" dans l'objet JSON text, sans analyseur complet : le rapport est écrit par ce module
+static bool readJsonNumber(const std::string& text, const std::string& key, double& value) {
+    size_t pos = text.find("\"" + key + "\"");
+    if (pos == std::string::npos || (pos = text.find(':', pos)) == std::string::npos) {
+        return false;
+    }
+    const char* start = text.c_str() + pos + 1;
+    char* end = nullptr;
+    value = std::strtod(start, &end);
+    return end != start;
+}
+
+bool readBenchmarkBaseline(const std::string& path, FrameTimeStats& baseline) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    // Seul l'objet "frameMs" est lu, pas celui de la référence d'un rapport déjà comparé
+    size_t begin = text.find("\"frameMs\"");
+    size_t end = begin == std::string::npos ? std::string::npos : text.find('}', begin);
+    if (end == std::string::npos) {
+        return false;
+    }
+    std::string stats = text.substr(begin, end - begin);
+    double frames = 0.0;
+    bool ok = readJsonNumber(stats, "frames", frames) && readJsonNumber(stats, "mean", baseline.mean)
+        && readJsonNumber(stats, "p50", baseline.p50) && readJsonNumber(stats, "p95", baseline.p95)
+        && readJsonNumber(stats, "p99", baseline.p99) && readJsonNumber(stats, "min", baseline.min)
+        && readJsonNumber(stats, "max", baseline.max);
+    baseline.frames = (int)frames;
+    return ok;
+}
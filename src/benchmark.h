@@ -0,0 +1,80 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <glm/glm.hpp>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "scene_params.h"
+
+// Pas de temps par défaut de la relecture, en secondes d'enregistrement par image
+const double kDefaultReplayTimestep = 1.0 / 60.0;
+
+// État des entrées et de l'interface à un instant de l'enregistrement
+struct InputSample {
+    double clock = 0.0; // Secondes depuis le début de l'enregistrement
+    float time = 0.0f;  // iTime
+    float mouseU = 0.5f; // iMouse normalisée (0..1, origine en bas à gauche), indépendante de la résolution
+    float mouseV = 0.5f;
+    float fov = 55.0f;
+    glm::vec3 objectPosition = glm::vec3(0.0f);
+    glm::vec3 objectRotation = glm::vec3(0.0f); // Degrés, autour de X, Y et Z
+};
+
+// Échantillons par ordre de clock croissant
+struct InputRecording {
+    std::vector<InputSample> samples;
+};
+
+// Enregistrement en cours dans la fenêtre, un échantillon par image rendue
+struct InputRecorder {
+    bool active = false;
+    std::chrono::steady_clock::time_point start;
+    InputRecording recording;
+};
+
+void startInputRecording(InputRecorder& recorder);
+
+// Ajoute l'état de params ; width x height est la taille en pixels dans laquelle iMouse est exprimée
+void recordInputSample(InputRecorder& recorder, const SceneParams& params, int width, int height);
+
+// Format texte : une ligne d'en-tête puis une ligne par échantillon
+bool saveInputRecording(const InputRecording& recording, const std::string& path);
+bool loadInputRecording(const std::string& path, InputRecording& recording);
+
+// Durée couverte par l'enregistrement, en secondes
+double inputRecordingDuration(const InputRecording& recording);
+
+// Remplace iTime, iMouse, le FOV, la position et les rotations de params par l'état enregistré à l'instant
+// clock, interpolé entre les deux échantillons voisins. iMouse est convertie en pixels de width x height.
+void applyInputRecording(const InputRecording& recording, double clock, int width, int height, SceneParams& params);
+
+// Répartition des temps d'image, en ms. Les centiles sont au rang le plus proche.
+struct FrameTimeStats {
+    int frames = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+FrameTimeStats computeFrameTimeStats(std::vector<double> frameMs);
+
+// Rapport JSON d'une mesure, comparé à une mesure de référence si baseline est non nul
+struct BenchmarkReport {
+    std::string recording; // Fichier relu, vide pour une plage de iTime
+    int width = 0;
+    int height = 0;
+    double timestep = 0.0;
+    int warmupFrames = 0;
+    FrameTimeStats frameMs;
+};
+
+bool writeBenchmarkReport(const std::string& path, const BenchmarkReport& report, const FrameTimeStats* baseline);
+
+// Relit les temps d'image d'un rapport écrit par writeBenchmarkReport
+bool readBenchmarkBaseline(const std::string& path, FrameTimeStats& baseline);
+
+#endif
@@ -0,0 +1,78 @@
+#include "color_grading.h"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+bool colorGradingActive(const SceneParams& params) {
+    return params.sepiaEnabled || params.hueShiftEnabled || params.gammaCorrectionEnabled;
+}
+
+glm::vec3 gradeColor(glm::vec3 col, const SceneParams& params) {
+    // Sépia
+    if (params.sepiaEnabled) {
+        col = glm::vec3(glm::dot(col, glm::vec3(0.393f, 0.769f, 0.189f)),
+                        glm::dot(col, glm::vec3(0.349f, 0.686f, 0.168f)),
+                        glm::dot(col, glm::vec3(0.272f, 0.534f, 0.131f)));
+    }
+
+    // Changement de teinte : col * mat3(c0, c1, c2) en GLSL, soit le produit scalaire avec chaque colonne
+    if (params.hueShiftEnabled) {
+        float angle = 1.0f;
+        float s = std::sin(angle);
+        float c = std::cos(angle);
+        glm::vec3 c0(0.213f + c * 0.787f - s * 0.213f, 0.213f - c * 0.213f + s * 0.143f, 0.213f - c * 0.213f - s * 0.787f);
+        glm::vec3 c1(0.715f - c * 0.715f - s * 0.715f, 0.715f + c * 0.285f + s * 0.140f, 0.715f - c * 0.715f + s * 0.715f);
+        glm::vec3 c2(0.072f - c * 0.072f + s * 0.928f, 0.072f - c * 0.072f - s * 0.283f, 0.072f + c * 0.928f + s * 0.072f);
+        col = glm::vec3(glm::dot(col, c0), glm::dot(col, c1), glm::dot(col, c2));
+    }
+
+    // Correction gamma. La vignette, qui dépend de la position, est appliquée après la LUT par le shader
+    if (params.gammaCorrectionEnabled) {
+        col = glm::pow(glm::max(col, glm::vec3(0.0f)), glm::vec3(1.0f / 2.2f));
+    }
+    return col;
+}
+
+void updateColorGrading(ColorGrading& grading, const SceneParams& params) {
+    if (grading.texture != 0 && grading.sepiaEnabled == params.sepiaEnabled &&
+        grading.hueShiftEnabled == params.hueShiftEnabled && grading.gammaCorrectionEnabled == params.gammaCorrectionEnabled) {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<float> texels((size_t)kColorLutSize * kColorLutSize * kColorLutSize * 3);
+    size_t index = 0;
+    for (int b = 0; b < kColorLutSize; ++b) {
+        for (int g = 0; g < kColorLutSize; ++g) {
+            for (int r = 0; r < kColorLutSize; ++r) {
+                // Inverse de la coordonnée sqrt(couleur / kColorLutRange) du shader
+                glm::vec3 shaped = glm::vec3(r, g, b) / (float)(kColorLutSize - 1);
+                glm::vec3 graded = gradeColor(shaped * shaped * kColorLutRange, params);
+                texels[index++] = graded.x;
+                texels[index++] = graded.y;
+                texels[index++] = graded.z;
+            }
+        }
+    }
+
+    if (grading.texture == 0) {
+        glGenTextures(1, &grading.texture);
+    }
+    glBindTexture(GL_TEXTURE_3D, grading.texture);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB16F, kColorLutSize, kColorLutSize, kColorLutSize, 0, GL_RGB, GL_FLOAT, texels.data());
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    grading.sepiaEnabled = params.sepiaEnabled;
+    grading.hueShiftEnabled = params.hueShiftEnabled;
+    grading.gammaCorrectionEnabled = params.gammaCorrectionEnabled;
+    grading.bakeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void destroyColorGrading(ColorGrading& grading) {
+    glDeleteTextures(1, &grading.texture);
+    grading = ColorGrading();
+}
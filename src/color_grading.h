@@ -0,0 +1,36 @@
+#ifndef COLOR_GRADING_H
+#define COLOR_GRADING_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include "scene_params.h"
+
+// Échantillons par axe de la LUT
+const int kColorLutSize = 33;
+// Couleur linéaire maximale couverte par la LUT : les modèles d'éclairage dépassent 1 (ambiante + diffuse + spéculaire)
+const float kColorLutRange = 4.0f;
+
+// LUT 3D des post-traitements qui ne dépendent pas de la position du pixel (sépia, teinte, gamma).
+// Elle est indexée par sqrt(couleur / kColorLutRange), plus précis que l'espace linéaire dans les ombres,
+// et recalculée sur le CPU quand un de ces réglages change.
+struct ColorGrading {
+    GLuint texture = 0;
+    bool sepiaEnabled = false;
+    bool hueShiftEnabled = false;
+    bool gammaCorrectionEnabled = false;
+    double bakeMilliseconds = 0.0;
+};
+
+// Vrai si params active au moins un opérateur de la LUT
+bool colorGradingActive(const SceneParams& params);
+
+// Chaîne des opérateurs, appliquée à une couleur linéaire dans l'ordre de l'ancien postProcess du shader.
+// Un nouvel opérateur ajouté ici ne coûte rien par pixel.
+glm::vec3 gradeColor(glm::vec3 col, const SceneParams& params);
+
+// Recalcule et envoie la LUT si les réglages de params ont changé depuis le dernier calcul
+void updateColorGrading(ColorGrading& grading, const SceneParams& params);
+
+void destroyColorGrading(ColorGrading& grading);
+
+#endif
@@ -0,0 +1,238 @@
+// Microbenchmark du portage CPU de la scène : rayons primaires par seconde pour chaque largeur de paquet,
+// et vérification que les paquets SSE/AVX2 donnent le même matériau et la même distance que le scalaire.
+// Avec --gpu-gbuffer, le scalaire est aussi vérifié contre le G-buffer écrit par main_scene --headless --gbuffer.
+
+#include "cpu_scene.h"
+#include "../image_io.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+// Écarts admis par défaut entre le portage et le G-buffer du shader : écart relatif de distance d'un pixel de
+// même matériau, et part des pixels hors tolérance (matériau différent ou distance trop éloignée)
+const float kDefaultGpuTolerance = 1e-3f;
+const double kDefaultMaxMismatchPercent = 0.1;
+
+struct BenchFrame {
+    int width = 800;
+    int height = 600;
+    int count = 0;             // Nombre de pixels arrondi au multiple de kMaxLanes
+    std::vector<float> fragX;
+    std::vector<float> fragY;
+    cpu::Camera camera;
+    cpu::SceneConstants constants;
+};
+
+struct BenchResult {
+    std::vector<float> ids;
+    std::vector<float> dists;
+    double seconds = 0.0;
+};
+
+struct HitComparison {
+    int idMismatches = 0;
+    int distMismatches = 0; // Pixels de même matériau dont la distance s'écarte de plus de la tolérance
+    float maxError = 0.0f;
+};
+
+BenchFrame makeFrame(const SurfaceView& view) {
+    BenchFrame frame;
+    int width = view.width;
+    int height = view.height;
+    frame.width = width;
+    frame.height = height;
+    int pixels = width * height;
+    frame.count = (pixels + cpu::kMaxLanes - 1) / cpu::kMaxLanes * cpu::kMaxLanes;
+
+    frame.fragX.resize(frame.count);
+    frame.fragY.resize(frame.count);
+    for (int i = 0; i < frame.count; ++i) {
+        int p = i < pixels ? i : pixels - 1; // Remplissage du dernier paquet
+        frame.fragX[i] = (p % width) + 0.5f;
+        frame.fragY[i] = (p / width) + 0.5f;
+    }
+
+    frame.camera = cpu::makeCamera(view.mouseX, view.mouseY, (float)width, (float)height, view.fov * cpu::kDeg2Rad);
+
+    cpu::SceneState state;
+    state.time = view.time;
+    for (int axis = 0; axis < 3; ++axis) {
+        state.objectPosition[axis] = view.objectPosition[axis];
+    }
+    state.objectRotationX = view.objectRotation[0] * cpu::kDeg2Rad;
+    state.objectRotationY = view.objectRotation[1] * cpu::kDeg2Rad;
+    state.objectRotationZ = view.objectRotation[2] * cpu::kDeg2Rad;
+    frame.constants = cpu::makeSceneConstants(state);
+    return frame;
+}
+
+template <int W>
+BenchResult runMarch(const BenchFrame& frame, int repeat) {
+    using F = typename cpu::Lanes<W>::Float;
+
+    BenchResult result;
+    result.ids.resize(frame.count);
+    result.dists.resize(frame.count);
+
+    cpu::Vec3<F> r0 = cpu::broadcast<F>(frame.camera.r0.x, frame.camera.r0.y, frame.camera.r0.z);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+        for (int i = 0; i < frame.count; i += W) {
+            cpu::Vec3<F> rD = cpu::cameraRays<W>(frame.camera, &frame.fragX[i], &frame.fragY[i]);
+            cpu::Hit<W> hit = cpu::march<W>(r0, rD, frame.constants);
+            hit.id.store(&result.ids[i]);
+            hit.dist.store(&result.dists[i]);
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeat;
+    return result;
+}
+
+// Avec relative, l'écart de distance est rapporté à max(1, distance de référence) : le seuil de contact de la
+// marche est atteint à une fraction de pas près, qui croît avec la distance sur les surfaces vues en biais
+HitComparison compareHits(const BenchFrame& frame, const BenchResult& result, const BenchResult& reference,
+                          float tolerance, bool relative = false) {
+    HitComparison comparison;
+    int pixels = frame.width * frame.height;
+    for (int i = 0; i < pixels; ++i) {
+        if (result.ids[i] != reference.ids[i]) {
+            ++comparison.idMismatches;
+            continue;
+        }
+        float error = std::abs(result.dists[i] - reference.dists[i]);
+        if (relative) {
+            error /= std::max(1.0f, reference.dists[i]);
+        }
+        comparison.maxError = std::max(comparison.maxError, error);
+        if (error > tolerance) {
+            ++comparison.distMismatches;
+        }
+    }
+    return comparison;
+}
+
+void printComparison(const char* against, const HitComparison& comparison) {
+    std::cout << "   vs " << against << ": " << comparison.idMismatches << " id / " << comparison.distMismatches
+              << " distance mismatches, max error " << std::scientific << std::setprecision(2) << comparison.maxError;
+}
+
+// G-buffer du shader (distance, matériau) réarrangé comme un résultat de runMarch
+BenchResult gpuResult(const BenchFrame& frame, const std::vector<float>& surface) {
+    BenchResult result;
+    result.ids.resize(frame.count);
+    result.dists.resize(frame.count);
+    for (int i = 0; i < frame.width * frame.height; ++i) {
+        result.dists[i] = surface[2 * i];
+        result.ids[i] = surface[2 * i + 1];
+    }
+    return result;
+}
+
+void report(const char* name, const BenchFrame& frame, const BenchResult& result, const BenchResult* reference, float tolerance) {
+    double rays = (double)frame.width * frame.height;
+    std::cout << std::setw(8) << name
+              << std::fixed << std::setprecision(2)
+              << std::setw(12) << rays / result.seconds / 1e6 << " Mrays/s"
+              << std::setw(12) << result.seconds * 1000.0 << " ms/frame";
+
+    if (reference) {
+        printComparison("scalar", compareHits(frame, result, *reference, tolerance));
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int width = 800, height = 600;
+    int repeat = 3;
+    float time = 0.0f;
+    float tolerance = 1e-3f;
+    std::string gpuPath;
+    float gpuTolerance = kDefaultGpuTolerance;
+    double maxMismatchPercent = kDefaultMaxMismatchPercent;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                std::cerr << "Invalid size: " << argv[i] << std::endl;
+                return -1;
+            }
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--time" && i + 1 < argc) {
+            time = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--gpu-gbuffer" && i + 1 < argc) {
+            gpuPath = argv[++i];
+        } else if (arg == "--gpu-tolerance" && i + 1 < argc) {
+            gpuTolerance = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--max-mismatch" && i + 1 < argc) {
+            maxMismatchPercent = std::strtod(argv[++i], nullptr);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--size WxH] [--repeat N] [--time T] [--tolerance EPS]\n"
+                      << "       [--gpu-gbuffer FILE] [--gpu-tolerance EPS] [--max-mismatch PCT]" << std::endl;
+            return -1;
+        }
+    }
+
+    // Vue par défaut : souris au centre de l'image, FOV par défaut de main_scene. Avec --gpu-gbuffer, la vue
+    // est celle de l'image du G-buffer.
+    SurfaceView view;
+    view.width = width;
+    view.height = height;
+    view.time = time;
+    view.mouseX = width * 0.5f;
+    view.mouseY = height * 0.5f;
+    std::vector<float> surface;
+    if (!gpuPath.empty() && !readSurfaceBuffer(gpuPath, view, surface)) {
+        std::cerr << "Failed to read the G-buffer " << gpuPath << std::endl;
+        return -1;
+    }
+
+    BenchFrame frame = makeFrame(view);
+    std::cout << "Primary rays, " << view.width << "x" << view.height << ", iTime " << view.time << ", " << repeat
+              << " repetitions" << std::endl;
+
+    BenchResult scalar = runMarch<1>(frame, repeat);
+    report("scalar", frame, scalar, nullptr, tolerance);
+
+#if defined(__SSE4_1__)
+    BenchResult sse = runMarch<4>(frame, repeat);
+    report("SSE 4x", frame, sse, &scalar, tolerance);
+#else
+    std::cout << "  SSE 4x  not compiled (build with -msse4.1 or -march=native)" << std::endl;
+#endif
+
+#if defined(__AVX2__)
+    BenchResult avx = runMarch<8>(frame, repeat);
+    report("AVX2 8x", frame, avx, &scalar, tolerance);
+#else
+    std::cout << " AVX2 8x  not compiled (build with -mavx2 or -march=native)" << std::endl;
+#endif
+
+    // Portage contre le shader : quelques pixels diffèrent toujours, sur les silhouettes où un rayon rase une
+    // surface et à l'horizon où la marche s'arrête faute de pas ; l'arrondi des deux marches y suffit à
+    // changer le matériau ou le pas d'arrêt. Le test porte donc sur la part de ces pixels.
+    if (!surface.empty()) {
+        HitComparison comparison = compareHits(frame, scalar, gpuResult(frame, surface), gpuTolerance, true);
+        double percent = 100.0 * (comparison.idMismatches + comparison.distMismatches)
+            / ((double)frame.width * frame.height);
+        bool passed = percent <= maxMismatchPercent;
+        std::cout << std::setw(8) << "scalar";
+        printComparison("GPU", comparison);
+        std::cout << " (relative, tolerance " << std::setprecision(1) << gpuTolerance << "), " << std::fixed
+                  << std::setprecision(3) << percent << " % of pixels  " << (passed ? "PASS" : "FAIL") << std::endl;
+        return passed ? 0 : 1;
+    }
+    return 0;
+}
@@ -0,0 +1,248 @@
+// Rendu CPU multithread de la scène de main_scene, pour les machines de rendu sans GPU.
+// Écrit les images au format PPM et affiche, pour chaque image, le coût des tuiles et l'utilisation des threads.
+
+#include "cpu_renderer.h"
+#include "../image_io.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../../include/stb_image.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    int width = 800;
+    int height = 600;
+    int threads = 0; // 0 : std::thread::hardware_concurrency()
+    int tileSize = 16;
+    float timeStart = 0.0f;
+    float timeEnd = 10.0f;
+    int frames = 1;
+    float mouseU = 0.5f;
+    float mouseV = 0.5f;
+    float relaxation = 1.0f;
+    std::string outputDir = "frames_cpu";
+    bool writeFrames = true;
+    std::string tileCsv;
+    bool scaling = false;
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --size WxH          output resolution (default 800x600)\n"
+              << "  --threads N         worker threads including the main thread (default: all cores)\n"
+              << "  --tile N            tile size in pixels, rounded to the SIMD width (default 16)\n"
+              << "  --time-start T      first iTime value (default 0)\n"
+              << "  --time-end T        last iTime value (default 10)\n"
+              << "  --frames N          number of frames (default 1)\n"
+              << "  --mouse U,V         normalized iMouse position (default 0.5,0.5)\n"
+              << "  --relaxation W      over-relaxed sphere tracing of primary rays (default 1, exact steps)\n"
+              << "  --output DIR        directory for frame_XXXX.ppm files (default frames_cpu)\n"
+              << "  --no-output         do not write frames\n"
+              << "  --tile-csv FILE     write every tile cost (frame, tile, microseconds, thread) as CSV\n"
+              << "  --scaling           render the first frame with 1, 2, 4, ... threads and print the speedup\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2) {
+                std::cerr << "Invalid size: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--tile" && hasValue) {
+            options.tileSize = std::atoi(argv[++i]);
+        } else if (arg == "--time-start" && hasValue) {
+            options.timeStart = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--time-end" && hasValue) {
+            options.timeEnd = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--frames" && hasValue) {
+            options.frames = std::atoi(argv[++i]);
+        } else if (arg == "--mouse" && hasValue) {
+            if (std::sscanf(argv[++i], "%f,%f", &options.mouseU, &options.mouseV) != 2) {
+                std::cerr << "Invalid mouse position: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--relaxation" && hasValue) {
+            options.relaxation = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--output" && hasValue) {
+            options.outputDir = argv[++i];
+        } else if (arg == "--no-output") {
+            options.writeFrames = false;
+        } else if (arg == "--tile-csv" && hasValue) {
+            options.tileCsv = argv[++i];
+        } else if (arg == "--scaling") {
+            options.scaling = true;
+        } else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.threads <= 0) {
+        options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (options.relaxation < 1.0f || options.relaxation >= 2.0f) {
+        std::cerr << "Relaxation factor must be in [1, 2)" << std::endl;
+        return false;
+    }
+    if (options.width <= 0 || options.height <= 0 || options.frames <= 0 || options.tileSize <= 0) {
+        std::cerr << "Size, tile size and frame count must be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+cpu::FrameParams makeFrameParams(const Options& options, int frame) {
+    cpu::FrameParams params;
+    params.state.time = options.frames > 1
+        ? options.timeStart + (options.timeEnd - options.timeStart) * frame / (options.frames - 1)
+        : options.timeStart;
+    params.mouseX = options.mouseU * options.width;
+    params.mouseY = options.mouseV * options.height;
+    params.marchRelaxation = options.relaxation;
+    return params;
+}
+
+void printFrameReport(int frame, const cpu::FrameReport& report) {
+    std::vector<uint64_t> costs;
+    costs.reserve(report.tiles.size());
+    const cpu::TileCost* costliest = nullptr;
+    for (const cpu::TileCost& tile : report.tiles) {
+        costs.push_back(tile.nanoseconds);
+        if (!costliest || tile.nanoseconds > costliest->nanoseconds) {
+            costliest = &tile;
+        }
+    }
+    std::sort(costs.begin(), costs.end());
+
+    double sum = 0.0;
+    for (uint64_t c : costs) {
+        sum += c;
+    }
+    auto percentile = [&](double q) { return costs[std::min(costs.size() - 1, (size_t)(q * costs.size()))] / 1000.0; };
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "frame " << frame << ": " << report.frameMilliseconds << " ms, "
+              << report.threadCount << " threads, utilisation " << report.utilisation() * 100.0 << "%\n"
+              << "  tiles: " << costs.size() << ", cost us mean " << sum / costs.size() / 1000.0
+              << " p50 " << percentile(0.5) << " p95 " << percentile(0.95) << " max " << costs.back() / 1000.0;
+    if (costliest) {
+        std::cout << " (tile " << costliest->tileX << "," << costliest->tileY << ")";
+    }
+    std::cout << "\n  threads busy%/tiles/stolen:";
+    for (const cpu::WorkerStats& w : report.workers) {
+        std::cout << " " << std::setprecision(0) << w.busyNanoseconds / 1e6 / report.frameMilliseconds * 100.0
+                  << "/" << w.itemsExecuted << "/" << w.itemsStolen;
+    }
+    std::cout << std::endl;
+}
+
+void runScaling(const Options& options) {
+    cpu::FrameParams params = makeFrameParams(options, 0);
+    std::vector<unsigned char> rgba;
+    double baseline = 0.0;
+
+    std::cout << "Scaling at " << options.width << "x" << options.height << ", tile " << options.tileSize << std::endl;
+    for (int threads = 1; ; threads = std::min(threads * 2, options.threads)) {
+        cpu::CpuRenderer renderer(threads, options.tileSize);
+        renderer.loadTexture("../src/ressources/texture/pierre.jpg");
+
+        // Meilleur de trois rendus pour limiter le bruit
+        double best = 1e30;
+        cpu::FrameReport report;
+        for (int r = 0; r < 3; ++r) {
+            renderer.render(params, options.width, options.height, rgba, &report);
+            best = std::min(best, report.frameMilliseconds);
+        }
+        if (threads == 1) {
+            baseline = best;
+        }
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(4) << threads << " threads: " << std::setw(9) << best << " ms, speedup "
+                  << std::setprecision(2) << baseline / best << "x, efficiency "
+                  << std::setprecision(0) << baseline / best / threads * 100.0 << "%, utilisation "
+                  << report.utilisation() * 100.0 << "%" << std::endl;
+
+        if (threads == options.threads) {
+            break;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return -1;
+    }
+
+    if (options.scaling) {
+        runScaling(options);
+        return 0;
+    }
+
+    cpu::CpuRenderer renderer(options.threads, options.tileSize);
+    if (!renderer.loadTexture("../src/ressources/texture/pierre.jpg")) {
+        return -1;
+    }
+
+    if (options.writeFrames) {
+        std::error_code ec;
+        fs::create_directories(options.outputDir, ec);
+    }
+
+    std::ofstream tileCsv;
+    if (!options.tileCsv.empty()) {
+        tileCsv.open(options.tileCsv);
+        tileCsv << "frame,tile_x,tile_y,microseconds,thread\n";
+    }
+
+    std::cout << "CPU render " << options.width << "x" << options.height << ", " << renderer.threadCount()
+              << " threads, tile " << renderer.tileSize() << ", SIMD width " << cpu::kMaxLanes << std::endl;
+
+    std::vector<unsigned char> rgba;
+    double totalMs = 0.0;
+    for (int frame = 0; frame < options.frames; ++frame) {
+        cpu::FrameParams params = makeFrameParams(options, frame);
+        cpu::FrameReport report;
+        renderer.render(params, options.width, options.height, rgba, &report);
+        totalMs += report.frameMilliseconds;
+        printFrameReport(frame, report);
+
+        if (tileCsv.is_open()) {
+            for (const cpu::TileCost& tile : report.tiles) {
+                tileCsv << frame << "," << tile.tileX << "," << tile.tileY << ","
+                        << tile.nanoseconds / 1000.0 << "," << tile.worker << "\n";
+            }
+        }
+
+        if (options.writeFrames) {
+            std::ostringstream name;
+            name << "frame_" << std::setw(4) << std::setfill('0') << frame << ".ppm";
+            writePPM((fs::path(options.outputDir) / name.str()).string(), options.width, options.height, rgba);
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(2) << "average " << totalMs / options.frames << " ms/frame ("
+              << options.frames * 1000.0 / totalMs << " frames/s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include "cpu_renderer.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "../../include/stb_image.h"
+
+namespace cpu {
+
+uint32_t mortonCode(uint32_t x, uint32_t y) {
+    auto spread = [](uint32_t v) {
+        v &= 0x0000FFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+double FrameReport::utilisation() const {
+    if (frameMilliseconds <= 0.0 || threadCount == 0) {
+        return 0.0;
+    }
+    uint64_t busy = 0;
+    for (const WorkerStats& w : workers) {
+        busy += w.busyNanoseconds;
+    }
+    return busy / 1e6 / (frameMilliseconds * threadCount);
+}
+
+CpuRenderer::CpuRenderer(int threadCount, int tileSize)
+    : pool_(threadCount), tileSize_(std::max(kMaxLanes, (tileSize + kMaxLanes - 1) / kMaxLanes * kMaxLanes)) {
+}
+
+bool CpuRenderer::loadTexture(const std::string& path) {
+    int width, height, channels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 0);
+    if (!data) {
+        std::cerr << "Failed to load texture " << path << std::endl;
+        return false;
+    }
+    texture_.width = width;
+    texture_.height = height;
+    texture_.channels = channels;
+    texture_.data.assign(data, data + (size_t)width * height * channels);
+    stbi_image_free(data);
+    return true;
+}
+
+void CpuRenderer::buildTileOrder(int width, int height) {
+    if (width == width_ && height == height_ && !tileOrder_.empty()) {
+        return;
+    }
+    width_ = width;
+    height_ = height;
+    tilesX_ = (width + tileSize_ - 1) / tileSize_;
+    tilesY_ = (height + tileSize_ - 1) / tileSize_;
+
+    tileOrder_.resize(tilesX_ * tilesY_);
+    for (int i = 0; i < (int)tileOrder_.size(); ++i) {
+        tileOrder_[i] = i;
+    }
+    std::sort(tileOrder_.begin(), tileOrder_.end(), [this](int a, int b) {
+        return mortonCode(a % tilesX_, a / tilesX_) < mortonCode(b % tilesX_, b / tilesX_);
+    });
+}
+
+void CpuRenderer::render(const FrameParams& params, int width, int height, std::vector<unsigned char>& rgba, FrameReport* report) {
+    auto start = std::chrono::steady_clock::now();
+
+    buildTileOrder(width, height);
+    rgba.resize((size_t)width * height * 4);
+
+    params_ = &params;
+    constants_ = makeSceneConstants(params.state);
+    camera_ = makeCamera(params.mouseX, params.mouseY, (float)width, (float)height, params.fovRadians);
+    output_ = rgba.data();
+    tileCosts_.assign(tileOrder_.size(), TileCost());
+
+    std::vector<WorkerStats> workerStats;
+    pool_.run(tileOrder_, [this](int tile, int worker) {
+        auto tileStart = std::chrono::steady_clock::now();
+        int tileX = tile % tilesX_;
+        int tileY = tile / tilesX_;
+        renderTile<kMaxLanes>(tileX, tileY);
+
+        TileCost& cost = tileCosts_[tile];
+        cost.tileX = tileX;
+        cost.tileY = tileY;
+        cost.worker = worker;
+        cost.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tileStart).count();
+    }, &workerStats);
+
+    if (report) {
+        report->frameMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        report->threadCount = pool_.threadCount();
+        report->workers = workerStats;
+        report->tiles.clear();
+        for (int tile : tileOrder_) {
+            report->tiles.push_back(tileCosts_[tile]);
+        }
+    }
+
+    params_ = nullptr;
+    output_ = nullptr;
+}
+
+template <int W>
+void CpuRenderer::renderTile(int tileX, int tileY) {
+    using F = typename Lanes<W>::Float;
+    using M = typename Lanes<W>::Mask;
+
+    const FrameParams& params = *params_;
+    Vec3<F> r0 = broadcast<F>(camera_.r0.x, camera_.r0.y, camera_.r0.z);
+    Vec3<float> lightPos = lightPosition(params.state.time);
+
+    int x0 = tileX * tileSize_;
+    int y0 = tileY * tileSize_;
+    int x1 = std::min(x0 + tileSize_, width_);
+    int y1 = std::min(y0 + tileSize_, height_);
+
+    alignas(32) float fragX[W], fragY[W];
+    alignas(32) float ids[W], dists[W], visibilities[W];
+    alignas(32) float px[W], py[W], pz[W], nx[W], ny[W], nz[W], dx[W], dy[W], dz[W];
+
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; x += W) {
+            // Les pixels hors de l'image (bord droit) répètent le dernier pixel et ne sont pas écrits
+            for (int i = 0; i < W; ++i) {
+                fragX[i] = std::min(x + i, x1 - 1) + 0.5f;
+                fragY[i] = y + 0.5f;
+            }
+
+            Vec3<F> rD = cameraRays<W>(camera_, fragX, fragY);
+            Hit<W> hit = march<W>(r0, rD, constants_, params.marchRelaxation);
+            M hitMask = hit.dist < F(kMaxDist);
+
+            Vec3<F> p = r0 + rD * hit.dist;
+            Vec3<F> nor = broadcast<F>(0.0f, 1.0f, 0.0f);
+            F visibility(1.0f);
+
+            hit.id.store(ids);
+            hit.dist.store(dists);
+
+            if (any(hitMask)) {
+                nor = normal<W>(p, constants_);
+
+                // Rayons d'ombre, uniquement pour les pixels dont le modèle d'éclairage en utilise un
+                alignas(32) float needsShadow[W];
+                for (int i = 0; i < W; ++i) {
+                    needsShadow[i] = needsShadowRay(ids[i], params.shadowsAllModels) ? 1.0f : 0.0f;
+                }
+                M shadowMask = hitMask & (F::load(needsShadow) > F(0.5f));
+
+                if (any(shadowMask)) {
+                    // Comme lightVisibility() : une face tournée à l'opposé de la lumière ne lance pas de rayon
+                    Vec3<F> lD = broadcast<F>(lightPos.x, lightPos.y, lightPos.z) - p;
+                    M facing = shadowMask & (dot(nor, lD) > F(0.0f));
+                    F lightDistance = length(lD);
+                    Vec3<F> lN = lD * (F(1.0f) / lightDistance);
+                    float softness = params.softShadowsEnabled ? params.shadowSoftness : 0.0f;
+                    F lit = shadow<W>(p + nor * F(0.01f), lN, lightDistance, constants_, softness, facing);
+                    visibility = select(facing, lit, select(shadowMask, F(0.0f), visibility));
+                }
+            }
+
+            visibility.store(visibilities);
+            p.x.store(px); p.y.store(py); p.z.store(pz);
+            nor.x.store(nx); nor.y.store(ny); nor.z.store(nz);
+            rD.x.store(dx); rD.y.store(dy); rD.z.store(dz);
+
+            int count = std::min(W, x1 - x);
+            for (int i = 0; i < count; ++i) {
+                SurfaceSample s;
+                s.id = ids[i];
+                s.dist = dists[i];
+                s.p = Vec3<float>(px[i], py[i], pz[i]);
+                s.nor = Vec3<float>(nx[i], ny[i], nz[i]);
+                s.rD = Vec3<float>(dx[i], dy[i], dz[i]);
+                s.visibility = visibilities[i];
+
+                float uvX = (fragX[i] - width_ * 0.5f) / height_;
+                float uvY = (fragY[i] - height_ * 0.5f) / height_;
+                Vec3<float> col = shadePixel(s, uvX, uvY, params, texture_);
+
+                unsigned char* out = output_ + ((size_t)y * width_ + x + i) * 4;
+                out[0] = toUnorm8(col.x);
+                out[1] = toUnorm8(col.y);
+                out[2] = toUnorm8(col.z);
+                out[3] = 255;
+            }
+        }
+    }
+}
+
+} // namespace cpu
@@ -0,0 +1,76 @@
+#ifndef CPU_RENDERER_H
+#define CPU_RENDERER_H
+
+// Rendu CPU complet d'une image de la scène : tuiles parcourues dans l'ordre de Morton,
+// exécutées sur le pool à vol de tâches, paquets SIMD de kMaxLanes pixels par ligne de tuile.
+
+#include "cpu_shading.h"
+#include "thread_pool.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <string>
+
+namespace cpu {
+
+// Coût d'une tuile pour le rapport d'image
+struct TileCost {
+    int tileX = 0;
+    int tileY = 0;
+    uint64_t nanoseconds = 0;
+    int worker = 0;
+};
+
+struct FrameReport {
+    double frameMilliseconds = 0.0;
+    int threadCount = 0;
+    std::vector<TileCost> tiles;        // Dans l'ordre de Morton
+    std::vector<WorkerStats> workers;
+
+    // Temps occupé cumulé / (threads * durée de l'image)
+    double utilisation() const;
+};
+
+class CpuRenderer {
+public:
+    // tileSize est arrondi au multiple de kMaxLanes
+    CpuRenderer(int threadCount, int tileSize);
+
+    // Charge la texture de la boîte (texture1 du shader)
+    bool loadTexture(const std::string& path);
+
+    // Rend l'image en RGBA 8 bits, lignes de bas en haut comme glReadPixels
+    void render(const FrameParams& params, int width, int height, std::vector<unsigned char>& rgba, FrameReport* report = nullptr);
+
+    int threadCount() const { return pool_.threadCount(); }
+    int tileSize() const { return tileSize_; }
+
+private:
+    template <int W>
+    void renderTile(int tileX, int tileY);
+
+    void buildTileOrder(int width, int height);
+
+    WorkStealingPool pool_;
+    int tileSize_;
+    Texture texture_;
+
+    // État de l'image en cours, lu par les tâches
+    int width_ = 0;
+    int height_ = 0;
+    int tilesX_ = 0;
+    int tilesY_ = 0;
+    std::vector<int> tileOrder_;
+    const FrameParams* params_ = nullptr;
+    SceneConstants constants_;
+    Camera camera_;
+    unsigned char* output_ = nullptr;
+    std::vector<TileCost> tileCosts_;
+};
+
+// Entrelace les bits de x et y (ordre de Morton / courbe en Z)
+uint32_t mortonCode(uint32_t x, uint32_t y);
+
+} // namespace cpu
+
+#endif
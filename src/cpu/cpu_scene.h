@@ -0,0 +1,328 @@
+#ifndef CPU_SCENE_H
+#define CPU_SCENE_H
+
+// Portage CPU de scene(), march() et normal() de src/shaders/fragment_shader.glsl.
+// Chaque fonction évalue un paquet de W rayons (voir simd.h) en un seul appel par pas de marche.
+// Le code suit le shader ligne à ligne : toute modification de la scène GLSL doit être reportée ici.
+
+#include "simd.h"
+#include <cmath>
+
+namespace cpu {
+
+// Mêmes constantes que le fragment shader
+constexpr float kMaxDist = 20.0f;
+constexpr int kSteps = 100;
+constexpr int kShadowSteps = 96;
+constexpr float kHitEpsilon = 0.001f;
+constexpr float kPi = 3.141592f;
+constexpr float kDeg2Rad = 0.01745329251f;
+
+// Identifiant renvoyé par march() pour un rayon qui sort de la scène
+constexpr float kSkyMaterial = 100.0f;
+
+template <class F>
+struct Vec3 {
+    F x, y, z;
+    Vec3() {}
+    Vec3(F x_, F y_, F z_) : x(x_), y(y_), z(z_) {}
+};
+
+template <class F> inline Vec3<F> operator+(const Vec3<F>& a, const Vec3<F>& b) { return Vec3<F>(a.x + b.x, a.y + b.y, a.z + b.z); }
+template <class F> inline Vec3<F> operator-(const Vec3<F>& a, const Vec3<F>& b) { return Vec3<F>(a.x - b.x, a.y - b.y, a.z - b.z); }
+template <class F> inline Vec3<F> operator*(const Vec3<F>& a, F s) { return Vec3<F>(a.x * s, a.y * s, a.z * s); }
+template <class F> inline F dot(const Vec3<F>& a, const Vec3<F>& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+template <class F> inline F length(const Vec3<F>& a) { return vsqrt(dot(a, a)); }
+template <class F> inline Vec3<F> normalize(const Vec3<F>& a) { F inv = F(1.0f) / length(a); return a * inv; }
+template <class F> inline Vec3<F> broadcast(float x, float y, float z) { return Vec3<F>(F(x), F(y), F(z)); }
+
+inline Vec3<float> cross(const Vec3<float>& a, const Vec3<float>& b) {
+    return Vec3<float>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+inline float dot(const Vec3<float>& a, const Vec3<float>& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float length(const Vec3<float>& a) { return std::sqrt(dot(a, a)); }
+inline Vec3<float> normalize(const Vec3<float>& a) { float l = length(a); return Vec3<float>(a.x / l, a.y / l, a.z / l); }
+
+// Résultat de scene() et march() : x = identifiant du matériau, y = distance (comme le vec2 du shader)
+template <int W>
+struct Hit {
+    typename Lanes<W>::Float id;
+    typename Lanes<W>::Float dist;
+};
+
+// Valeurs des uniformes du shader qui influencent la géométrie (angles en radians)
+struct SceneState {
+    float time = 0.0f;
+    float objectPosition[3] = { 0.0f, 0.5f, -1.0f };
+    float objectRotationX = 0.0f;
+    float objectRotationY = 0.0f;
+    float objectRotationZ = 0.0f;
+};
+
+// Sinus, cosinus et décalages qui ne dépendent que des uniformes : calculés une fois par image
+struct SceneConstants {
+    float objectPosition[3];
+    float sinX, cosX, sinY, cosY, sinZ, cosZ;
+    float sinCylinder, cosCylinder;
+    float sphere2OffsetX, sphere2OffsetY;
+};
+
+inline SceneConstants makeSceneConstants(const SceneState& state) {
+    SceneConstants c;
+    for (int i = 0; i < 3; ++i) {
+        c.objectPosition[i] = state.objectPosition[i];
+    }
+    c.sinX = std::sin(state.objectRotationX);
+    c.cosX = std::cos(state.objectRotationX);
+    c.sinY = std::sin(state.objectRotationY);
+    c.cosY = std::cos(state.objectRotationY);
+    c.sinZ = std::sin(state.objectRotationZ);
+    c.cosZ = std::cos(state.objectRotationZ);
+    c.sinCylinder = std::sin(state.time * 0.3f);
+    c.cosCylinder = std::cos(state.time * 0.3f);
+    c.sphere2OffsetX = 0.1f * std::cos(state.time);
+    c.sphere2OffsetY = 0.1f * std::sin(state.time);
+    return c;
+}
+
+// Rotations du shader : mat3 construites colonne par colonne, puis rot * p
+template <class F> inline Vec3<F> rotateX(const Vec3<F>& p, float s, float c) {
+    return Vec3<F>(p.x, p.y * F(c) + p.z * F(s), p.z * F(c) - p.y * F(s));
+}
+template <class F> inline Vec3<F> rotateY(const Vec3<F>& p, float s, float c) {
+    return Vec3<F>(p.x * F(c) - p.z * F(s), p.y, p.x * F(s) + p.z * F(c));
+}
+template <class F> inline Vec3<F> rotateZ(const Vec3<F>& p, float s, float c) {
+    return Vec3<F>(p.x * F(c) + p.y * F(s), p.y * F(c) - p.x * F(s), p.z);
+}
+
+template <class F> inline F dPlane(const Vec3<F>& p, float h) {
+    return p.y - F(h);
+}
+
+template <class F> inline F dSphere(const Vec3<F>& p, float r) {
+    return length(p) - F(r);
+}
+
+template <class F> inline F dTorus(const Vec3<F>& p, float r, float t) {
+    F q = vsqrt(p.x * p.x + p.z * p.z) - F(r);
+    return vsqrt(q * q + p.y * p.y) - F(t);
+}
+
+template <class F> inline F dCylinder(const Vec3<F>& p, float r, float h) {
+    F dX = vsqrt(p.x * p.x + p.z * p.z) - F(r);
+    F dY = vabs(p.y) - F(h);
+
+    F eX = vmax(dX, F(0.0f));
+    F eY = vmax(dY, F(0.0f));
+    F dE = vsqrt(eX * eX + eY * eY);
+    F dI = vmin(vmax(dX, dY), F(0.0f));
+
+    return dE + dI;
+}
+
+template <class F> inline F dBox(const Vec3<F>& p, float sx, float sy, float sz) {
+    F dx = vabs(p.x) - F(sx);
+    F dy = vabs(p.y) - F(sy);
+    F dz = vabs(p.z) - F(sz);
+
+    F ex = vmax(dx, F(0.0f));
+    F ey = vmax(dy, F(0.0f));
+    F ez = vmax(dz, F(0.0f));
+    F dE = vsqrt(ex * ex + ey * ey + ez * ez);
+    F dI = vmin(vmax(dx, vmax(dy, dz)), F(0.0f));
+
+    return dE + dI;
+}
+
+// minVec2 : a.y < b.y ? a : b
+template <int W>
+inline Hit<W> minHit(const Hit<W>& a, const Hit<W>& b) {
+    typename Lanes<W>::Mask m = a.dist < b.dist;
+    return Hit<W>{ select(m, a.id, b.id), select(m, a.dist, b.dist) };
+}
+
+template <int W>
+inline Hit<W> scene(const Vec3<typename Lanes<W>::Float>& p, const SceneConstants& c) {
+    using F = typename Lanes<W>::Float;
+
+    // Transformation de box2 et du cylindre
+    Vec3<F> pBox2 = p - broadcast<F>(c.objectPosition[0], c.objectPosition[1], c.objectPosition[2]);
+    Vec3<F> pCylinder = p - broadcast<F>(0.3f, 1.2f, 0.0f);
+
+    pBox2 = rotateX(pBox2, c.sinX, c.cosX);
+    pBox2 = rotateY(pBox2, c.sinY, c.cosY);
+    pBox2 = rotateZ(pBox2, c.sinZ, c.cosZ);
+    pCylinder = rotateX(pCylinder, c.sinCylinder, c.cosCylinder);
+
+    // Mouvement elliptique pour sphere2
+    Vec3<F> pSphere2 = p - broadcast<F>(0.0f, 0.5f, -0.5f);
+    pSphere2.x = pSphere2.x + F(c.sphere2OffsetX);
+    pSphere2.y = pSphere2.y + F(c.sphere2OffsetY);
+
+    Hit<W> dp{ F(0.0f), dPlane(p, 0.0f) };
+    Hit<W> ds{ F(1.0f), dSphere(p, 0.5f) };
+    Hit<W> ds2{ F(5.0f), dSphere(pSphere2, 0.3f) };
+    Hit<W> dT{ F(3.0f), dTorus(p, 1.0f, 0.2f) };
+    Hit<W> dC{ F(4.0f), dCylinder(pCylinder, 0.3f, 0.2f) - F(0.05f) };
+    Hit<W> dB{ F(2.0f), dBox(p - broadcast<F>(0.8f, 0.5f, 0.3f), 0.3f, 0.1f, 0.3f) - F(0.1f) };
+    Hit<W> dMarbleBox{ F(6.0f), dBox(pBox2, 0.3f, 0.3f, 0.05f) };
+
+    return minHit<W>(dMarbleBox, minHit<W>(dB, minHit<W>(dC, minHit<W>(dT, minHit<W>(dp, minHit<W>(ds, ds2))))));
+}
+
+// Sphere tracing d'un paquet : les rayons terminés sont masqués, la boucle s'arrête quand tous le sont.
+// Les rayons absents de active ne sont pas tracés (utile pour les rayons d'ombre d'une partie du paquet).
+// relaxation > 1 allonge les pas comme marchRange() du shader : un rayon dont les sphères de deux points
+// successifs ne se recouvrent plus revient au pas exact et finit sa marche sans relaxation.
+template <int W>
+inline Hit<W> march(const Vec3<typename Lanes<W>::Float>& r0, const Vec3<typename Lanes<W>::Float>& rD, const SceneConstants& c,
+                    typename Lanes<W>::Mask active, float relaxation = 1.0f) {
+    using F = typename Lanes<W>::Float;
+    using M = typename Lanes<W>::Mask;
+
+    F d(0.0f);
+    Hit<W> s{ F(0.0f), F(0.0f) };
+    M escaped = Lanes<W>::allFalse();
+    F omega(relaxation);
+    F previousRadius(0.0f);
+    F stepLength(0.0f);
+
+    if (!any(active)) {
+        return s;
+    }
+
+    for (int i = 0; i < kSteps; i++) {
+        Vec3<F> cP = r0 + rD * d;
+        Hit<W> h = scene<W>(cP, c);
+
+        M overstepped = active & (omega > F(1.0f)) & (h.dist + previousRadius < stepLength);
+        d = select(overstepped, d - (stepLength - previousRadius), d);
+        stepLength = select(overstepped, previousRadius, stepLength);
+        omega = select(overstepped, F(1.0f), omega);
+
+        M stepping = andNot(active, overstepped);
+        s.id = select(stepping, h.id, s.id);
+        s.dist = select(stepping, h.dist, s.dist);
+        stepLength = select(stepping, h.dist * omega, stepLength);
+        previousRadius = select(stepping, h.dist, previousRadius);
+
+        M hit = stepping & (h.dist < F(kHitEpsilon));
+        d = select(hit, d + h.dist, d);
+        active = andNot(active, hit);
+        stepping = andNot(stepping, hit);
+
+        // Sortie décidée sur le pas exact, comme dans le shader
+        M far = stepping & (d + h.dist > F(kMaxDist));
+        escaped = escaped | far;
+        active = andNot(active, far);
+        stepping = andNot(stepping, far);
+        d = select(stepping, d + stepLength, d);
+
+        if (!any(active)) {
+            break;
+        }
+    }
+
+    s.id = select(escaped, F(kSkyMaterial), s.id);
+    s.dist = select(escaped, F(kMaxDist + 10.0f), d);
+    return s;
+}
+
+template <int W>
+inline Hit<W> march(const Vec3<typename Lanes<W>::Float>& r0, const Vec3<typename Lanes<W>::Float>& rD, const SceneConstants& c,
+                    float relaxation = 1.0f) {
+    return march<W>(r0, rD, c, Lanes<W>::allTrue(), relaxation);
+}
+
+// Portage de shadow() : visibilité de la lumière le long de rD jusqu'à tMax, de 0 (ombre) à 1 (éclairé).
+// softness <= 0 donne des ombres dures. Les rayons inactifs renvoient 1.
+template <int W>
+inline typename Lanes<W>::Float shadow(const Vec3<typename Lanes<W>::Float>& r0, const Vec3<typename Lanes<W>::Float>& rD,
+                                       typename Lanes<W>::Float tMax, const SceneConstants& c, float softness,
+                                       typename Lanes<W>::Mask active) {
+    using F = typename Lanes<W>::Float;
+    using M = typename Lanes<W>::Mask;
+
+    F visibility(1.0f);
+    F t(0.0f);
+
+    for (int i = 0; i < kShadowSteps; i++) {
+        if (!any(active)) {
+            return visibility;
+        }
+        F h = scene<W>(r0 + rD * t, c).dist;
+
+        M blocked = active & (h < F(kHitEpsilon));
+        if (softness > 0.0f) {
+            F penumbra = F(softness) * h / vmax(t, F(0.001f));
+            visibility = select(active, vmin(visibility, penumbra), visibility);
+            blocked = blocked | (active & (visibility < F(0.01f)));
+        }
+        visibility = select(blocked, F(0.0f), visibility);
+        active = andNot(active, blocked);
+
+        t = select(active, t + h, t);
+        active = active & (t < tMax);
+    }
+
+    // Budget épuisé : considéré comme bloqué, comme dans le shader
+    return select(active, F(0.0f), visibility);
+}
+
+template <int W>
+inline Vec3<typename Lanes<W>::Float> normal(const Vec3<typename Lanes<W>::Float>& p, const SceneConstants& c) {
+    using F = typename Lanes<W>::Float;
+    const float eps = 0.01f;
+
+    F dp = scene<W>(p, c).dist;
+    F dx = scene<W>(p + broadcast<F>(eps, 0.0f, 0.0f), c).dist - dp;
+    F dy = scene<W>(p + broadcast<F>(0.0f, eps, 0.0f), c).dist - dp;
+    F dz = scene<W>(p + broadcast<F>(0.0f, 0.0f, eps), c).dist - dp;
+
+    return normalize(Vec3<F>(dx, dy, dz));
+}
+
+// Caméra de mainImage() : orbite autour de la cible, pilotée par iMouse
+struct Camera {
+    Vec3<float> r0;
+    Vec3<float> fwd, side, up;
+    float focal; // tan(fov * 0.5)
+    float resolutionX, resolutionY;
+};
+
+inline Camera makeCamera(float mouseX, float mouseY, float resolutionX, float resolutionY, float fovRadians) {
+    float mx = mouseX / resolutionX;
+    float my = mouseY / resolutionY;
+    float initA = -kDeg2Rad * 90.0f;
+
+    Camera cam;
+    cam.r0 = Vec3<float>(std::cos(mx * 2.0f * kPi + initA) * 2.0f, my + 0.5f, std::sin(mx * 2.0f * kPi + initA) * 2.0f);
+
+    Vec3<float> target(0.0f, 0.5f, 0.0f);
+    cam.fwd = normalize(target - cam.r0);
+    cam.side = normalize(cross(Vec3<float>(0.0f, 1.0f, 0.0f), cam.fwd));
+    cam.up = cross(cam.fwd, cam.side);
+    cam.focal = std::tan(fovRadians * 0.5f);
+    cam.resolutionX = resolutionX;
+    cam.resolutionY = resolutionY;
+    return cam;
+}
+
+// Directions des rayons primaires pour W pixels (fragCoord = centre du pixel, origine en bas à gauche)
+template <int W>
+inline Vec3<typename Lanes<W>::Float> cameraRays(const Camera& cam, const float* fragX, const float* fragY) {
+    using F = typename Lanes<W>::Float;
+
+    F uvX = (F::load(fragX) - F(cam.resolutionX * 0.5f)) / F(cam.resolutionY);
+    F uvY = (F::load(fragY) - F(cam.resolutionY * 0.5f)) / F(cam.resolutionY);
+
+    Vec3<F> rD = broadcast<F>(cam.fwd.x * cam.focal, cam.fwd.y * cam.focal, cam.fwd.z * cam.focal)
+        + broadcast<F>(cam.side.x, cam.side.y, cam.side.z) * uvX
+        + broadcast<F>(cam.up.x, cam.up.y, cam.up.z) * uvY;
+    return normalize(rD);
+}
+
+} // namespace cpu
+
+#endif
@@ -0,0 +1,254 @@
+#ifndef CPU_SHADING_H
+#define CPU_SHADING_H
+
+// Portage CPU de la partie éclairage et post-traitement de mainImage() (fragment_shader.glsl).
+// La marche, les normales et les rayons d'ombre sont évalués par paquets (cpu_scene.h),
+// l'éclairage de chaque pixel est ensuite calculé en scalaire car il dépend du matériau touché.
+
+#include "cpu_scene.h"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace cpu {
+
+// Texture RGB(A) 8 bits échantillonnée comme texture1 : filtrage bilinéaire, répétition
+struct Texture {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<unsigned char> data;
+};
+
+// Uniformes de la scène qui ne servent qu'au rendu de l'image
+struct FrameParams {
+    SceneState state;
+    float mouseX = 0.0f; // iMouse, origine en bas à gauche
+    float mouseY = 0.0f;
+    float fovRadians = 55.0f * kDeg2Rad;
+
+    bool vignetteEnabled = true;
+    bool gammaCorrectionEnabled = true;
+    bool sepiaEnabled = false;
+    bool hueShiftEnabled = false;
+
+    bool softShadowsEnabled = true;
+    float shadowSoftness = 16.0f;
+    bool shadowsAllModels = true;
+
+    float marchRelaxation = 1.0f; // Sphere tracing sur-relaxé des rayons primaires au-delà de 1
+};
+
+inline Vec3<float> mul(const Vec3<float>& a, const Vec3<float>& b) { return Vec3<float>(a.x * b.x, a.y * b.y, a.z * b.z); }
+inline Vec3<float> reflect(const Vec3<float>& i, const Vec3<float>& n) { return i - n * (2.0f * dot(n, i)); }
+inline Vec3<float> mix(const Vec3<float>& a, const Vec3<float>& b, float t) { return a + (b - a) * t; }
+inline float glslMod(float x, float y) { return x - y * std::floor(x / y); }
+
+inline float smoothstep(float edge0, float edge1, float x) {
+    float t = std::min(std::max((x - edge0) / (edge1 - edge0), 0.0f), 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+inline float pow32(float x) {
+    float x2 = x * x, x4 = x2 * x2, x8 = x4 * x4, x16 = x8 * x8;
+    return x16 * x16;
+}
+
+inline Vec3<float> sampleTexture(const Texture& tex, float u, float v) {
+    if (tex.data.empty()) {
+        return Vec3<float>(1.0f, 1.0f, 1.0f);
+    }
+
+    float x = u * tex.width - 0.5f;
+    float y = v * tex.height - 0.5f;
+    int x0 = (int)std::floor(x);
+    int y0 = (int)std::floor(y);
+    float fx = x - x0;
+    float fy = y - y0;
+
+    auto texel = [&](int tx, int ty) {
+        tx = ((tx % tex.width) + tex.width) % tex.width;
+        ty = ((ty % tex.height) + tex.height) % tex.height;
+        const unsigned char* t = &tex.data[((size_t)ty * tex.width + tx) * tex.channels];
+        return Vec3<float>(t[0] / 255.0f, t[1] / 255.0f, t[2] / 255.0f);
+    };
+
+    Vec3<float> top = mix(texel(x0, y0), texel(x0 + 1, y0), fx);
+    Vec3<float> bottom = mix(texel(x0, y0 + 1), texel(x0 + 1, y0 + 1), fx);
+    return mix(top, bottom, fy);
+}
+
+inline Vec3<float> lightPosition(float time) {
+    return Vec3<float>(std::cos(time) * 2.0f, 1.0f, std::sin(time) * 2.0f);
+}
+
+inline Vec3<float> material(float i) {
+    Vec3<float> col(0.0f, 0.0f, 0.0f);
+
+    if (i < 0.5f) {
+        col = Vec3<float>(1.0f, 2.0f, 2.0f);
+    } else if (i < 1.5f) {
+        col = Vec3<float>(1.0f, 0.2f, 0.3f);
+    } else if (i < 2.5f) {
+        col = Vec3<float>(0.3f, 0.2f, 5.0f);
+    } else if (i < 3.5f) {
+        col = Vec3<float>(0.5f, 0.2f, 3.0f);
+    } else if (i < 4.5f) {
+        col = Vec3<float>(0.3f, 5.0f, 5.0f);
+    } else if (i < 5.5f) {
+        col = Vec3<float>(0.7f, 0.7f, 0.7f);
+    } else if (i < 6.5f) {
+        col = Vec3<float>(0.9f, 0.9f, 0.9f);
+    }
+
+    return col * 0.2f;
+}
+
+inline Vec3<float> phongLighting(const Vec3<float>& p, const Vec3<float>& n, const Vec3<float>& viewDir, const Vec3<float>& materialColor, const Vec3<float>& lightPos, float visibility) {
+    Vec3<float> ambient = materialColor * 0.1f;
+    Vec3<float> lightDir = normalize(lightPos - p);
+    float diff = std::max(dot(n, lightDir), 0.0f);
+    Vec3<float> diffuse = materialColor * diff;
+    Vec3<float> reflectDir = reflect(lightDir * -1.0f, n);
+    float spec = pow32(std::max(dot(viewDir, reflectDir), 0.0f));
+    return ambient + (diffuse + Vec3<float>(spec, spec, spec)) * visibility;
+}
+
+inline Vec3<float> blinnPhongLighting(const Vec3<float>& p, const Vec3<float>& n, const Vec3<float>& viewDir, const Vec3<float>& materialColor, const Vec3<float>& lightPos, float visibility) {
+    Vec3<float> ambient = materialColor * 0.1f;
+    Vec3<float> lightDir = normalize(lightPos - p);
+    float diff = std::max(dot(n, lightDir), 0.0f);
+    Vec3<float> diffuse = materialColor * diff;
+    Vec3<float> halfwayDir = normalize(lightDir + viewDir);
+    float spec = pow32(std::max(dot(n, halfwayDir), 0.0f));
+    return ambient + (diffuse + Vec3<float>(spec, spec, spec)) * visibility;
+}
+
+inline Vec3<float> toonLighting(const Vec3<float>& p, const Vec3<float>& n, const Vec3<float>& materialColor, const Vec3<float>& lightPos, float visibility) {
+    Vec3<float> lightDir = normalize(lightPos - p);
+    float diff = std::max(dot(n, lightDir), 0.0f);
+    diff *= diff > 0.25f ? visibility : 1.0f; // Le niveau le plus sombre ne dépend pas de l'ombre
+
+    if (diff > 0.5f) {
+        diff = 1.0f;
+    } else if (diff > 0.25f) {
+        diff = 0.7f;
+    } else {
+        diff = 0.4f;
+    }
+
+    return materialColor * diff + materialColor * 0.1f;
+}
+
+inline Vec3<float> marbleShader(const Vec3<float>& p, float time) {
+    float noise = std::sin(p.x * 10.0f + std::sin(p.y * 10.0f + time) * 0.5f);
+    noise = noise * 0.5f + 0.5f;
+    return mix(Vec3<float>(1.0f, 1.0f, 1.0f), Vec3<float>(0.1f, 0.1f, 0.1f), noise);
+}
+
+// Les matériaux sans modèle d'éclairage dédié utilisent basicLighting, donc un rayon d'ombre ;
+// toon, Phong, Blinn-Phong et la boîte texturée en lancent un si shadowsAllModels est actif
+inline bool needsShadowRay(float id, bool shadowsAllModels) {
+    if (id == 6.0f) {
+        return false;
+    }
+    bool basicLighting = id != 1.0f && id != 2.0f && id != 4.0f && id != 5.0f;
+    return basicLighting || shadowsAllModels;
+}
+
+// Surface touchée par un rayon primaire, après la marche par paquets
+struct SurfaceSample {
+    float id;
+    float dist;
+    Vec3<float> p;
+    Vec3<float> nor;
+    Vec3<float> rD;
+    float visibility; // Résultat du rayon d'ombre (1 si aucun rayon n'a été lancé)
+};
+
+// Couleur finale d'un pixel, avant conversion en 8 bits. uv : coordonnées centrées de mainImage().
+inline Vec3<float> shadePixel(const SurfaceSample& s, float uvX, float uvY, const FrameParams& params, const Texture& texture) {
+    float time = params.state.time;
+    Vec3<float> sCol(0.5f, 0.8f, 1.0f);
+    Vec3<float> col = mix(Vec3<float>(0.5f, 0.8f, 1.0f), Vec3<float>(0.08f, 0.3f, 1.0f), std::pow(uvY + 0.5f, 2.5f));
+
+    if (s.dist < kMaxDist) {
+        col = material(s.id);
+        Vec3<float> lightPos = lightPosition(time);
+        Vec3<float> viewDir = normalize(s.rD * -1.0f);
+        const Vec3<float>& p = s.p;
+        const Vec3<float>& nor = s.nor;
+
+        if (s.id == 1.0f) {
+            col = toonLighting(p, nor, col, lightPos, s.visibility);
+        } else if (s.id == 4.0f) {
+            col = phongLighting(p, nor, viewDir, col, lightPos, s.visibility);
+        } else if (s.id == 5.0f) {
+            col = blinnPhongLighting(p, nor, viewDir, col, lightPos, s.visibility);
+        } else if (s.id == 2.0f) {
+            Vec3<float> lightDir = normalize(lightPos - p);
+            float diff = std::max(dot(nor, lightDir), 0.0f);
+            Vec3<float> reflectDir = reflect(lightDir * -1.0f, nor);
+            float spec = pow32(std::max(dot(viewDir, reflectDir), 0.0f));
+            float lighting = 0.1f + (diff + spec) * s.visibility;
+
+            float u, v;
+            if (std::fabs(nor.y) > 0.99f) {
+                u = glslMod(p.x, 1.0f);
+                v = glslMod(p.z, 1.0f);
+            } else {
+                u = glslMod(p.x + p.z, 1.0f);
+                v = glslMod(p.y, 1.0f);
+            }
+            col = sampleTexture(texture, u, v) * lighting;
+        } else if (s.id == 6.0f) {
+            col = marbleShader(p, time);
+        } else {
+            Vec3<float> lN = normalize(lightPos - p);
+            float l = s.visibility * std::max(0.0f, dot(nor, lN));
+            Vec3<float> a = Vec3<float>(5.0f, 0.0f, 10.0f) * 0.03f;
+            Vec3<float> aS = sCol * (nor.y * 0.2f);
+            col = mul(col, a + Vec3<float>(l, l, l) + aS);
+        }
+    }
+
+    if (params.sepiaEnabled) {
+        col = Vec3<float>(dot(col, Vec3<float>(0.393f, 0.769f, 0.189f)),
+                          dot(col, Vec3<float>(0.349f, 0.686f, 0.168f)),
+                          dot(col, Vec3<float>(0.272f, 0.534f, 0.131f)));
+    }
+
+    if (params.hueShiftEnabled) {
+        float angle = 1.0f;
+        float hs = std::sin(angle);
+        float hc = std::cos(angle);
+        // col * mat3(c0, c1, c2) : produit scalaire avec chaque colonne
+        Vec3<float> c0(0.213f + hc * 0.787f - hs * 0.213f, 0.213f - hc * 0.213f + hs * 0.143f, 0.213f - hc * 0.213f - hs * 0.787f);
+        Vec3<float> c1(0.715f - hc * 0.715f - hs * 0.715f, 0.715f + hc * 0.285f + hs * 0.140f, 0.715f - hc * 0.715f + hs * 0.715f);
+        Vec3<float> c2(0.072f - hc * 0.072f + hs * 0.928f, 0.072f - hc * 0.072f - hs * 0.283f, 0.072f + hc * 0.928f + hs * 0.072f);
+        col = Vec3<float>(dot(col, c0), dot(col, c1), dot(col, c2));
+    }
+
+    if (params.vignetteEnabled) {
+        float dist = std::sqrt(uvX * uvX + uvY * uvY);
+        col = col * smoothstep(0.8f, 0.2f, dist);
+    }
+
+    if (params.gammaCorrectionEnabled) {
+        col = Vec3<float>(std::pow(col.x, 1.0f / 2.2f), std::pow(col.y, 1.0f / 2.2f), std::pow(col.z, 1.0f / 2.2f));
+    }
+
+    return col;
+}
+
+// Conversion vers un canal 8 bits comme l'écriture dans un framebuffer RGBA8
+inline unsigned char toUnorm8(float c) {
+    if (!(c > 0.0f)) {
+        return 0;
+    }
+    return (unsigned char)(std::min(c, 1.0f) * 255.0f + 0.5f);
+}
+
+} // namespace cpu
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef CPU_SIMD_H
+#define CPU_SIMD_H
+
+// Types "paquet de rayons" utilisés par le portage CPU de la scène.
+// Float<W> contient W valeurs float traitées ensemble, Mask<W> le masque de comparaison associé.
+// W = 1 : scalaire, W = 4 : SSE 4.1, W = 8 : AVX2.
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace cpu {
+
+template <int W> struct Lanes;
+
+// ---------------------------------------------------------------------------
+// Scalaire
+// ---------------------------------------------------------------------------
+
+struct Float1 {
+    float v;
+    Float1() : v(0.0f) {}
+    Float1(float x) : v(x) {}
+    static Float1 load(const float* p) { return Float1(p[0]); }
+    void store(float* p) const { p[0] = v; }
+};
+
+struct Mask1 {
+    bool v;
+    Mask1() : v(false) {}
+    Mask1(bool x) : v(x) {}
+};
+
+inline Float1 operator+(Float1 a, Float1 b) { return a.v + b.v; }
+inline Float1 operator-(Float1 a, Float1 b) { return a.v - b.v; }
+inline Float1 operator*(Float1 a, Float1 b) { return a.v * b.v; }
+inline Float1 operator/(Float1 a, Float1 b) { return a.v / b.v; }
+inline Float1 operator-(Float1 a) { return -a.v; }
+inline Mask1 operator<(Float1 a, Float1 b) { return a.v < b.v; }
+inline Mask1 operator>(Float1 a, Float1 b) { return a.v > b.v; }
+inline Mask1 operator&(Mask1 a, Mask1 b) { return a.v && b.v; }
+inline Mask1 operator|(Mask1 a, Mask1 b) { return a.v || b.v; }
+inline Mask1 andNot(Mask1 a, Mask1 b) { return a.v && !b.v; } // a & ~b
+inline Float1 vmin(Float1 a, Float1 b) { return std::min(a.v, b.v); }
+inline Float1 vmax(Float1 a, Float1 b) { return std::max(a.v, b.v); }
+inline Float1 vabs(Float1 a) { return std::fabs(a.v); }
+inline Float1 vsqrt(Float1 a) { return std::sqrt(a.v); }
+inline Float1 select(Mask1 m, Float1 a, Float1 b) { return m.v ? a : b; }
+inline bool any(Mask1 m) { return m.v; }
+inline bool all(Mask1 m) { return m.v; }
+
+template <> struct Lanes<1> {
+    using Float = Float1;
+    using Mask = Mask1;
+    static Mask allTrue() { return Mask1(true); }
+    static Mask allFalse() { return Mask1(false); }
+};
+
+// ---------------------------------------------------------------------------
+// SSE 4.1 : 4 rayons
+// ---------------------------------------------------------------------------
+
+#if defined(__SSE4_1__)
+
+struct Float4 {
+    __m128 v;
+    Float4() : v(_mm_setzero_ps()) {}
+    Float4(__m128 x) : v(x) {}
+    Float4(float x) : v(_mm_set1_ps(x)) {}
+    static Float4 load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+};
+
+struct Mask4 {
+    __m128 v;
+    Mask4() : v(_mm_setzero_ps()) {}
+    Mask4(__m128 x) : v(x) {}
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+inline Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+inline Float4 operator/(Float4 a, Float4 b) { return _mm_div_ps(a.v, b.v); }
+inline Float4 operator-(Float4 a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+inline Mask4 operator<(Float4 a, Float4 b) { return _mm_cmplt_ps(a.v, b.v); }
+inline Mask4 operator>(Float4 a, Float4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+inline Mask4 operator&(Mask4 a, Mask4 b) { return _mm_and_ps(a.v, b.v); }
+inline Mask4 operator|(Mask4 a, Mask4 b) { return _mm_or_ps(a.v, b.v); }
+inline Mask4 andNot(Mask4 a, Mask4 b) { return _mm_andnot_ps(b.v, a.v); }
+inline Float4 vmin(Float4 a, Float4 b) { return _mm_min_ps(a.v, b.v); }
+inline Float4 vmax(Float4 a, Float4 b) { return _mm_max_ps(a.v, b.v); }
+inline Float4 vabs(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+inline Float4 vsqrt(Float4 a) { return _mm_sqrt_ps(a.v); }
+inline Float4 select(Mask4 m, Float4 a, Float4 b) { return _mm_blendv_ps(b.v, a.v, m.v); }
+inline bool any(Mask4 m) { return _mm_movemask_ps(m.v) != 0; }
+inline bool all(Mask4 m) { return _mm_movemask_ps(m.v) == 0xF; }
+
+template <> struct Lanes<4> {
+    using Float = Float4;
+    using Mask = Mask4;
+    static Mask allTrue() { return Mask4(_mm_castsi128_ps(_mm_set1_epi32(-1))); }
+    static Mask allFalse() { return Mask4(); }
+};
+
+#endif
+
+// ---------------------------------------------------------------------------
+// AVX2 : 8 rayons
+// ---------------------------------------------------------------------------
+
+#if defined(__AVX2__)
+
+struct Float8 {
+    __m256 v;
+    Float8() : v(_mm256_setzero_ps()) {}
+    Float8(__m256 x) : v(x) {}
+    Float8(float x) : v(_mm256_set1_ps(x)) {}
+    static Float8 load(const float* p) { return _mm256_loadu_ps(p); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+};
+
+struct Mask8 {
+    __m256 v;
+    Mask8() : v(_mm256_setzero_ps()) {}
+    Mask8(__m256 x) : v(x) {}
+};
+
+inline Float8 operator+(Float8 a, Float8 b) { return _mm256_add_ps(a.v, b.v); }
+inline Float8 operator-(Float8 a, Float8 b) { return _mm256_sub_ps(a.v, b.v); }
+inline Float8 operator*(Float8 a, Float8 b) { return _mm256_mul_ps(a.v, b.v); }
+inline Float8 operator/(Float8 a, Float8 b) { return _mm256_div_ps(a.v, b.v); }
+inline Float8 operator-(Float8 a) { return _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)); }
+inline Mask8 operator<(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+inline Mask8 operator>(Float8 a, Float8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+inline Mask8 operator&(Mask8 a, Mask8 b) { return _mm256_and_ps(a.v, b.v); }
+inline Mask8 operator|(Mask8 a, Mask8 b) { return _mm256_or_ps(a.v, b.v); }
+inline Mask8 andNot(Mask8 a, Mask8 b) { return _mm256_andnot_ps(b.v, a.v); }
+inline Float8 vmin(Float8 a, Float8 b) { return _mm256_min_ps(a.v, b.v); }
+inline Float8 vmax(Float8 a, Float8 b) { return _mm256_max_ps(a.v, b.v); }
+inline Float8 vabs(Float8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v); }
+inline Float8 vsqrt(Float8 a) { return _mm256_sqrt_ps(a.v); }
+inline Float8 select(Mask8 m, Float8 a, Float8 b) { return _mm256_blendv_ps(b.v, a.v, m.v); }
+inline bool any(Mask8 m) { return _mm256_movemask_ps(m.v) != 0; }
+inline bool all(Mask8 m) { return _mm256_movemask_ps(m.v) == 0xFF; }
+
+template <> struct Lanes<8> {
+    using Float = Float8;
+    using Mask = Mask8;
+    static Mask allTrue() { return Mask8(_mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+    static Mask allFalse() { return Mask8(); }
+};
+
+#endif
+
+// Largeur maximale disponible pour les options de compilation courantes
+#if defined(__AVX2__)
+constexpr int kMaxLanes = 8;
+#elif defined(__SSE4_1__)
+constexpr int kMaxLanes = 4;
+#else
+constexpr int kMaxLanes = 1;
+#endif
+
+} // namespace cpu
+
+#endif
@@ -0,0 +1,127 @@
+#include "thread_pool.h"
+#include <chrono>
+
+namespace cpu {
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+    : queues_(threadCount < 1 ? 1 : threadCount), stats_(queues_.size()) {
+    for (int i = 1; i < (int)queues_.size(); ++i) {
+        threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    startCondition_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::run(const std::vector<int>& items, const std::function<void(int, int)>& task,
+                           std::vector<WorkerStats>* stats) {
+    int workers = threadCount();
+
+    // Blocs contigus : chaque thread garde des tuiles voisines tant qu'il n'a pas à voler
+    size_t begin = 0;
+    for (int w = 0; w < workers; ++w) {
+        size_t end = items.size() * (w + 1) / workers;
+        std::lock_guard<std::mutex> lock(queues_[w].mutex);
+        queues_[w].items.assign(items.begin() + begin, items.begin() + end);
+        stats_[w] = WorkerStats();
+        begin = end;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        runningWorkers_ = workers - 1;
+        ++generation_;
+    }
+    startCondition_.notify_all();
+
+    work(0);
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        doneCondition_.wait(lock, [this] { return runningWorkers_ == 0; });
+        task_ = nullptr;
+    }
+
+    if (stats) {
+        *stats = stats_;
+    }
+}
+
+void WorkStealingPool::workerLoop(int worker) {
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            startCondition_.wait(lock, [&] { return stopping_ || generation_ != seenGeneration; });
+            if (stopping_) {
+                return;
+            }
+            seenGeneration = generation_;
+        }
+
+        work(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --runningWorkers_;
+        }
+        doneCondition_.notify_one();
+    }
+}
+
+void WorkStealingPool::work(int worker) {
+    using clock = std::chrono::steady_clock;
+    WorkerStats& stats = stats_[worker];
+
+    // La liste est fixée avant le départ : quand aucune file ne contient plus rien, le travail est terminé
+    for (;;) {
+        int item;
+        if (!popLocal(worker, item)) {
+            if (!steal(worker, item)) {
+                return;
+            }
+            ++stats.itemsStolen;
+        }
+
+        clock::time_point start = clock::now();
+        (*task_)(item, worker);
+        stats.busyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+        ++stats.itemsExecuted;
+    }
+}
+
+bool WorkStealingPool::popLocal(int worker, int& item) {
+    WorkQueue& queue = queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.items.empty()) {
+        return false;
+    }
+    item = queue.items.front();
+    queue.items.pop_front();
+    return true;
+}
+
+bool WorkStealingPool::steal(int worker, int& item) {
+    int workers = threadCount();
+    for (int offset = 1; offset < workers; ++offset) {
+        WorkQueue& victim = queues_[(worker + offset) % workers];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty()) {
+            item = victim.items.back();
+            victim.items.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace cpu
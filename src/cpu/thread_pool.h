@@ -0,0 +1,68 @@
+#ifndef CPU_THREAD_POOL_H
+#define CPU_THREAD_POOL_H
+
+// Pool de threads à vol de tâches pour le rendu CPU par tuiles.
+// Chaque exécution reçoit une liste fixe d'éléments (indices de tuiles) répartie en blocs contigus
+// entre les files des threads. Un thread consomme sa file par l'avant, dans l'ordre donné ; quand elle
+// est vide il vole par l'arrière la file d'un autre thread, ce qui équilibre les tuiles coûteuses.
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+namespace cpu {
+
+// Statistiques d'un thread pour une exécution
+struct WorkerStats {
+    uint64_t busyNanoseconds = 0; // Temps passé dans les tâches
+    int itemsExecuted = 0;
+    int itemsStolen = 0;
+};
+
+class WorkStealingPool {
+public:
+    // threadCount inclut le thread appelant, qui travaille pendant run()
+    explicit WorkStealingPool(int threadCount);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int threadCount() const { return (int)queues_.size(); }
+
+    // Exécute task(item, worker) pour chaque élément et attend la fin de toutes les tâches
+    void run(const std::vector<int>& items, const std::function<void(int item, int worker)>& task,
+             std::vector<WorkerStats>* stats = nullptr);
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<int> items;
+    };
+
+    void workerLoop(int worker);
+    void work(int worker);
+    bool popLocal(int worker, int& item);
+    bool steal(int worker, int& item);
+
+    std::vector<std::thread> threads_;
+    std::vector<WorkQueue> queues_;
+    std::vector<WorkerStats> stats_;
+
+    std::mutex mutex_;
+    std::condition_variable startCondition_;
+    std::condition_variable doneCondition_;
+    uint64_t generation_ = 0;
+    int runningWorkers_ = 0;
+    bool stopping_ = false;
+    const std::function<void(int, int)>* task_ = nullptr;
+};
+
+} // namespace cpu
+
+#endif
@@ -0,0 +1,134 @@
+#include "dynamic_resolution.h"
+#include "shader_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+bool initDynamicResolution(DynamicResolution& dynamic) {
+    std::string vertexSource = readFile("../src/shaders/vertex_shader.glsl");
+    std::string fragmentSource = readFile("../src/shaders/upscale_fragment_shader.glsl");
+    dynamic.upscaleProgram = createShaderProgram(vertexSource, fragmentSource);
+    if (dynamic.upscaleProgram == 0) {
+        std::cerr << "Failed to create upscale shader program" << std::endl;
+        return false;
+    }
+    dynamic.sceneColorLocation = glGetUniformLocation(dynamic.upscaleProgram, "sceneColor");
+    dynamic.sourceSizeLocation = glGetUniformLocation(dynamic.upscaleProgram, "sourceSize");
+
+    glGenQueries(kDynamicResolutionQueries, dynamic.queries);
+    return true;
+}
+
+// (Ré)alloue la cible réduite à la taille de la cible finale
+static void resizeTarget(DynamicResolution& dynamic, int width, int height) {
+    if (dynamic.fbo != 0 && dynamic.targetWidth == width && dynamic.targetHeight == height) {
+        return;
+    }
+    if (dynamic.fbo == 0) {
+        glGenFramebuffers(1, &dynamic.fbo);
+        glGenTextures(1, &dynamic.colorTexture);
+    }
+    glBindTexture(GL_TEXTURE_2D, dynamic.colorTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, dynamic.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dynamic.colorTexture, 0);
+    dynamic.targetWidth = width;
+    dynamic.targetHeight = height;
+    dynamic.skipNextSample = true;
+}
+
+// Lit les requêtes terminées et rapproche l'échelle de celle qui tiendrait le budget.
+// Le temps de la scène est à peu près proportionnel au nombre de pixels, donc au carré de l'échelle.
+static void updateScale(DynamicResolution& dynamic) {
+    for (int i = 0; i < kDynamicResolutionQueries; ++i) {
+        if (!dynamic.queryPending[i]) {
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(dynamic.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            continue;
+        }
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(dynamic.queries[i], GL_QUERY_RESULT, &elapsed);
+        dynamic.queryPending[i] = false;
+
+        // La première image après une allocation paie la compilation des shaders et l'envoi des textures
+        if (dynamic.skipNextSample) {
+            dynamic.skipNextSample = false;
+            continue;
+        }
+        dynamic.gpuMs = elapsed / 1.0e6;
+
+        if (dynamic.gpuMs > 0.0) {
+            float ratio = std::clamp((float)std::sqrt(dynamic.budgetMs / dynamic.gpuMs), 0.5f, 2.0f);
+            float target = dynamic.queryScales[i] * ratio;
+            // Lissage pour ne pas osciller sur les variations d'une image à l'autre
+            dynamic.scale += (target - dynamic.scale) * 0.25f;
+            dynamic.scale = std::clamp(dynamic.scale, dynamic.minScale, dynamic.maxScale);
+        }
+    }
+}
+
+void renderSceneDynamic(DynamicResolution& dynamic, SceneRenderer& renderer, const SceneParams& params, int width, int height) {
+    renderer.targetWidth = width;
+    renderer.targetHeight = height;
+    if (!dynamic.enabled) {
+        dynamic.renderWidth = width;
+        dynamic.renderHeight = height;
+        renderScene(renderer, params, width, height);
+        return;
+    }
+
+    GLint previousFbo = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+    resizeTarget(dynamic, width, height);
+
+    dynamic.renderWidth = std::max(1, (int)std::lround(width * dynamic.scale));
+    dynamic.renderHeight = std::max(1, (int)std::lround(height * dynamic.scale));
+
+    // Une requête encore en vol est abandonnée plutôt que d'attendre le GPU
+    int query = dynamic.nextQuery;
+    dynamic.nextQuery = (dynamic.nextQuery + 1) % kDynamicResolutionQueries;
+    bool measured = !dynamic.queryPending[query];
+    if (measured) {
+        glBeginQuery(GL_TIME_ELAPSED, dynamic.queries[query]);
+    }
+
+    SceneParams scaledParams = params;
+    scaledParams.mouseX = params.mouseX * dynamic.renderWidth / width;
+    scaledParams.mouseY = params.mouseY * dynamic.renderHeight / height;
+    glBindFramebuffer(GL_FRAMEBUFFER, dynamic.fbo);
+    renderScene(renderer, scaledParams, dynamic.renderWidth, dynamic.renderHeight);
+
+    ProfilerScope scope(renderer.profiler, "Agrandissement");
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+    glViewport(0, 0, width, height);
+    glUseProgram(dynamic.upscaleProgram);
+    glUniform1i(dynamic.sceneColorLocation, 0);
+    glUniform2f(dynamic.sourceSizeLocation, (float)dynamic.renderWidth, (float)dynamic.renderHeight);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, dynamic.colorTexture);
+    glBindVertexArray(renderer.vao);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+    if (measured) {
+        glEndQuery(GL_TIME_ELAPSED);
+        dynamic.queryScales[query] = dynamic.scale;
+        dynamic.queryPending[query] = true;
+    }
+    updateScale(dynamic);
+}
+
+void destroyDynamicResolution(DynamicResolution& dynamic) {
+    if (dynamic.fbo != 0) {
+        glDeleteFramebuffers(1, &dynamic.fbo);
+        glDeleteTextures(1, &dynamic.colorTexture);
+    }
+    glDeleteQueries(kDynamicResolutionQueries, dynamic.queries);
+    glDeleteProgram(dynamic.upscaleProgram);
+    dynamic = DynamicResolution();
+}
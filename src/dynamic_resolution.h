@@ -0,0 +1,52 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <GL/glew.h>
+#include "scene_params.h"
+#include "scene_renderer.h"
+
+// Nombre de requêtes de temps GPU en vol : le résultat d'une image est lu quelques images plus tard, sans attente
+const int kDynamicResolutionQueries = 4;
+
+// Rendu de la scène dans une cible réduite dont l'échelle suit un budget de temps GPU par image,
+// puis agrandissement vers la cible finale en préservant les contours
+struct DynamicResolution {
+    bool enabled = false;
+    float budgetMs = 16.0f;
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+
+    // État courant
+    float scale = 1.0f;
+    double gpuMs = 0.0; // Dernier temps mesuré (scène et agrandissement)
+    int renderWidth = 0;
+    int renderHeight = 0;
+
+    // Cible réduite, allouée à la taille de la cible finale ; seul le coin scale x scale est rendu
+    GLuint fbo = 0;
+    GLuint colorTexture = 0;
+    int targetWidth = 0;
+    int targetHeight = 0;
+
+    GLuint upscaleProgram = 0;
+    GLint sceneColorLocation = -1;
+    GLint sourceSizeLocation = -1;
+
+    GLuint queries[kDynamicResolutionQueries] = {};
+    float queryScales[kDynamicResolutionQueries] = {};
+    bool queryPending[kDynamicResolutionQueries] = {};
+    int nextQuery = 0;
+    bool skipNextSample = false;
+};
+
+// Compile le shader d'agrandissement et crée les requêtes de temps. Un contexte OpenGL doit être courant.
+bool initDynamicResolution(DynamicResolution& dynamic);
+
+// Rend la scène dans le framebuffer lié, de taille width x height. Si la résolution dynamique est active,
+// la scène est rendue à l'échelle courante dans la cible réduite puis agrandie ; iMouse est converti
+// dans les pixels de la cible réduite. L'échelle est ensuite ajustée d'après le dernier temps GPU disponible.
+void renderSceneDynamic(DynamicResolution& dynamic, SceneRenderer& renderer, const SceneParams& params, int width, int height);
+
+void destroyDynamicResolution(DynamicResolution& dynamic);
+
+#endif
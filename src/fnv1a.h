@@ -0,0 +1,31 @@
+#ifndef FNV1A_H
+#define FNV1A_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Hachage FNV-1a 64 bits des clés de cache (champ statique, programmes compilés)
+struct Fnv1a {
+    uint64_t value = 14695981039346656037ull;
+
+    void add(const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            value = (value ^ bytes[i]) * 1099511628211ull;
+        }
+    }
+
+    template <typename T>
+    void add(const T& v) {
+        add(&v, sizeof(T));
+    }
+
+    // La longueur est hachée avant le contenu : ("ab", "c") et ("a", "bc") donnent des clés différentes
+    void addString(const std::string& text) {
+        add((uint64_t)text.size());
+        add(text.data(), text.size());
+    }
+};
+
+#endif
@@ -0,0 +1,248 @@
+#include "gpu_profiler.h"
+#include "../include/imgui.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+using Clock = std::chrono::steady_clock;
+
+static const char* const kFrameScopeName = "Image";
+
+static int findScope(GpuProfiler& profiler, const char* name) {
+    for (size_t i = 0; i < profiler.scopeNames.size(); ++i) {
+        if (profiler.scopeNames[i] == name) {
+            return (int)i;
+        }
+    }
+    profiler.scopeNames.push_back(name);
+    profiler.scopeDepths.push_back((int)profiler.openSamples.size());
+    return (int)profiler.scopeNames.size() - 1;
+}
+
+bool initGpuProfiler(GpuProfiler& profiler) {
+    for (ProfilerFrame& frame : profiler.frames) {
+        glGenQueries(kProfilerMaxScopes * 2, frame.queries);
+    }
+    findScope(profiler, kFrameScopeName);
+    return glGetError() == GL_NO_ERROR;
+}
+
+// Convertit les horodatages d'une image terminée en un enregistrement de l'historique
+static void recordFrame(GpuProfiler& profiler, ProfilerFrame& frame) {
+    ProfilerRecord record;
+    record.frame = frame.index;
+    const float none = std::numeric_limits<float>::quiet_NaN();
+    record.gpuMs.assign(profiler.scopeNames.size(), none);
+    record.cpuMs.assign(profiler.scopeNames.size(), none);
+    for (int i = 0; i < frame.sampleCount; ++i) {
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(frame.queries[2 * i], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(frame.queries[2 * i + 1], GL_QUERY_RESULT, &end);
+        // Une section ouverte plusieurs fois dans la même image cumule ses temps
+        int scope = frame.samples[i].scope;
+        float gpuMs = (float)((end - start) / 1.0e6);
+        float cpuMs = (float)frame.samples[i].cpuMs;
+        record.gpuMs[scope] = std::isnan(record.gpuMs[scope]) ? gpuMs : record.gpuMs[scope] + gpuMs;
+        record.cpuMs[scope] = std::isnan(record.cpuMs[scope]) ? cpuMs : record.cpuMs[scope] + cpuMs;
+    }
+    profiler.history.push_back(std::move(record));
+    while ((int)profiler.history.size() > profiler.historyLength) {
+        profiler.history.pop_front();
+    }
+}
+
+void collectProfilerResults(GpuProfiler& profiler, bool wait) {
+    // Les images se terminent dans l'ordre : les lire de la plus ancienne à la plus récente
+    for (;;) {
+        ProfilerFrame* oldest = nullptr;
+        for (ProfilerFrame& frame : profiler.frames) {
+            if (frame.pending && (!oldest || frame.index < oldest->index)) {
+                oldest = &frame;
+            }
+        }
+        if (!oldest) {
+            return;
+        }
+        // Le dernier horodatage émis est celui de la fin de l'image : disponible, tous le sont
+        if (!wait) {
+            GLint available = 0;
+            glGetQueryObjectiv(oldest->queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                return;
+            }
+        }
+        recordFrame(profiler, *oldest);
+        oldest->pending = false;
+    }
+}
+
+void beginProfilerFrame(GpuProfiler& profiler) {
+    if (!profiler.enabled) {
+        return;
+    }
+    collectProfilerResults(profiler, false);
+
+    // Un emplacement dont les requêtes sont encore en vol n'est pas réutilisé, plutôt que d'attendre le GPU
+    ProfilerFrame& frame = profiler.frames[profiler.current];
+    profiler.frameTimed = !frame.pending;
+    if (profiler.frameTimed) {
+        frame.index = profiler.frameCounter;
+        frame.sampleCount = 0;
+    } else {
+        ++profiler.untimedFrames;
+    }
+    ++profiler.frameCounter;
+    profiler.openSamples.clear();
+    profiler.inFrame = true;
+    beginProfilerScope(profiler, kFrameScopeName);
+}
+
+void endProfilerFrame(GpuProfiler& profiler) {
+    if (!profiler.inFrame) {
+        return;
+    }
+    // Sections laissées ouvertes : fermées avec l'image, la section de l'image en dernier
+    while (!profiler.openSamples.empty()) {
+        endProfilerScope(profiler, profiler.openSamples.back());
+    }
+    ProfilerFrame& frame = profiler.frames[profiler.current];
+    if (profiler.frameTimed) {
+        frame.pending = frame.sampleCount > 0;
+    }
+    profiler.current = (profiler.current + 1) % kProfilerLatency;
+    profiler.inFrame = false;
+}
+
+int beginProfilerScope(GpuProfiler& profiler, const char* name) {
+    ProfilerFrame& frame = profiler.frames[profiler.current];
+    if (!profiler.enabled || !profiler.inFrame || !profiler.frameTimed || frame.sampleCount == kProfilerMaxScopes) {
+        return -1;
+    }
+    int sample = frame.sampleCount++;
+    frame.samples[sample].scope = findScope(profiler, name);
+    frame.samples[sample].cpuStart = Clock::now();
+    glQueryCounter(frame.queries[2 * sample], GL_TIMESTAMP);
+    profiler.openSamples.push_back(sample);
+    return sample;
+}
+
+void endProfilerScope(GpuProfiler& profiler, int sample) {
+    if (sample < 0 || !profiler.inFrame) {
+        return;
+    }
+    ProfilerFrame& frame = profiler.frames[profiler.current];
+    glQueryCounter(frame.queries[2 * sample + 1], GL_TIMESTAMP);
+    ProfilerSample& entry = frame.samples[sample];
+    entry.cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - entry.cpuStart).count();
+    auto open = std::find(profiler.openSamples.begin(), profiler.openSamples.end(), sample);
+    if (open != profiler.openSamples.end()) {
+        profiler.openSamples.erase(open);
+    }
+}
+
+ProfilerScope::ProfilerScope(GpuProfiler* profiler, const char* name)
+    : profiler(profiler), sample(profiler ? beginProfilerScope(*profiler, name) : -1) {
+}
+
+ProfilerScope::~ProfilerScope() {
+    if (profiler) {
+        endProfilerScope(*profiler, sample);
+    }
+}
+
+double profilerMeanMs(const GpuProfiler& profiler, int scope, bool gpu, int count) {
+    double sum = 0.0;
+    int samples = 0;
+    int first = std::max(0, (int)profiler.history.size() - count);
+    for (int i = first; i < (int)profiler.history.size(); ++i) {
+        const std::vector<float>& values = gpu ? profiler.history[i].gpuMs : profiler.history[i].cpuMs;
+        if (scope < (int)values.size() && !std::isnan(values[scope])) {
+            sum += values[scope];
+            ++samples;
+        }
+    }
+    return samples > 0 ? sum / samples : -1.0;
+}
+
+bool writeProfilerCsv(const GpuProfiler& profiler, const std::string& path) {
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << "frame";
+    for (const std::string& name : profiler.scopeNames) {
+        file << ",\"" << name << " GPU ms\",\"" << name << " CPU ms\"";
+    }
+    file << "\n";
+    // Les sections apparues après une image n'ont pas de valeur dans ses colonnes
+    for (const ProfilerRecord& record : profiler.history) {
+        file << record.frame;
+        for (size_t scope = 0; scope < profiler.scopeNames.size(); ++scope) {
+            file << ",";
+            if (scope < record.gpuMs.size() && !std::isnan(record.gpuMs[scope])) {
+                file << record.gpuMs[scope];
+            }
+            file << ",";
+            if (scope < record.cpuMs.size() && !std::isnan(record.cpuMs[scope])) {
+                file << record.cpuMs[scope];
+            }
+        }
+        file << "\n";
+    }
+    return (bool)file;
+}
+
+void drawProfilerPanel(GpuProfiler& profiler, const std::string& csvPath) {
+    ImGui::Checkbox("Profileur GPU/CPU", &profiler.enabled);
+    if (!profiler.enabled) {
+        return;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Exporter CSV")) {
+        profiler.exportStatus = writeProfilerCsv(profiler, csvPath)
+            ? std::to_string(profiler.history.size()) + " images écrites dans " + csvPath
+            : "Échec de l'écriture de " + csvPath;
+    }
+    if (!profiler.exportStatus.empty()) {
+        ImGui::TextUnformatted(profiler.exportStatus.c_str());
+    }
+
+    // Une courbe par section, sur le même axe que l'image entière
+    std::vector<float> values(profiler.history.size());
+    float scaleMax = 0.0f;
+    for (const ProfilerRecord& record : profiler.history) {
+        if (!record.gpuMs.empty() && !std::isnan(record.gpuMs[0])) {
+            scaleMax = std::max(scaleMax, record.gpuMs[0]);
+        }
+    }
+    for (size_t scope = 0; scope < profiler.scopeNames.size(); ++scope) {
+        for (size_t i = 0; i < profiler.history.size(); ++i) {
+            const std::vector<float>& gpuMs = profiler.history[i].gpuMs;
+            values[i] = scope < gpuMs.size() && !std::isnan(gpuMs[scope]) ? gpuMs[scope] : 0.0f;
+        }
+        double gpuMean = profilerMeanMs(profiler, (int)scope, true, 60);
+        double cpuMean = profilerMeanMs(profiler, (int)scope, false, 60);
+        if (gpuMean < 0.0) {
+            continue;
+        }
+        char overlay[96];
+        std::snprintf(overlay, sizeof(overlay), "GPU %.2f ms, CPU %.2f ms", gpuMean, cpuMean);
+        std::string label = std::string(profiler.scopeDepths[scope] * 2, ' ') + profiler.scopeNames[scope];
+        ImGui::PlotLines(label.c_str(), values.data(), (int)values.size(), 0, overlay, 0.0f, scaleMax,
+                         ImVec2(0.0f, 40.0f));
+    }
+    if (profiler.untimedFrames > 0) {
+        ImGui::Text("Images non chronométrées (requêtes en vol) : %lld", profiler.untimedFrames);
+    }
+}
+
+void destroyGpuProfiler(GpuProfiler& profiler) {
+    for (ProfilerFrame& frame : profiler.frames) {
+        if (frame.queries[0] != 0) {
+            glDeleteQueries(kProfilerMaxScopes * 2, frame.queries);
+        }
+        frame.pending = false;
+    }
+}
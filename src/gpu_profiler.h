@@ -0,0 +1,97 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <GL/glew.h>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+// Images en vol : les horodatages d'une image sont lus kProfilerLatency images plus tard, sans attendre le GPU
+const int kProfilerLatency = 4;
+// Sections chronométrées au plus par image, image entière comprise
+const int kProfilerMaxScopes = 32;
+// Images gardées par défaut pour le graphe et l'export CSV
+const int kProfilerHistory = 240;
+
+// Section ouverte pendant l'image en cours
+struct ProfilerSample {
+    int scope = 0; // Indice dans GpuProfiler::scopeNames
+    std::chrono::steady_clock::time_point cpuStart;
+    double cpuMs = 0.0;
+};
+
+// Requêtes d'une image : deux horodatages GL_TIMESTAMP par section, pour que les sections puissent s'imbriquer
+struct ProfilerFrame {
+    GLuint queries[kProfilerMaxScopes * 2] = {};
+    ProfilerSample samples[kProfilerMaxScopes];
+    int sampleCount = 0;
+    long long index = 0;
+    bool pending = false; // Requêtes émises, résultats pas encore lus
+};
+
+// Temps d'une image terminée, en ms, par section (NaN si la section n'a pas été ouverte pendant cette image)
+struct ProfilerRecord {
+    long long frame = 0;
+    std::vector<float> gpuMs;
+    std::vector<float> cpuMs;
+};
+
+// Chronométrage par sections, sur le GPU (GL_TIMESTAMP) et sur le CPU (steady_clock). Chaque image est la
+// section 0 ; les sections sont identifiées par leur nom et peuvent s'imbriquer.
+struct GpuProfiler {
+    bool enabled = true;
+    ProfilerFrame frames[kProfilerLatency];
+    int current = 0;
+    long long frameCounter = 0;
+    bool inFrame = false;
+    bool frameTimed = false;              // Faux si l'emplacement de l'image en cours était encore en vol
+    std::vector<std::string> scopeNames;  // Dans l'ordre de première ouverture
+    std::vector<int> scopeDepths;         // Profondeur d'imbrication à la première ouverture
+    std::vector<int> openSamples;         // Pile des sections ouvertes de l'image en cours
+    int historyLength = kProfilerHistory;
+    std::deque<ProfilerRecord> history;   // Au plus historyLength images, la plus récente à la fin
+    long long untimedFrames = 0;          // Images sans temps GPU, faute de requêtes libres
+    std::string exportStatus;             // Résultat du dernier export CSV, affiché dans le panneau
+};
+
+// Crée les requêtes. Un contexte OpenGL doit être courant.
+bool initGpuProfiler(GpuProfiler& profiler);
+
+// Lit les images dont les résultats sont arrivés, puis ouvre la section de l'image suivante
+void beginProfilerFrame(GpuProfiler& profiler);
+
+// Ferme la section de l'image
+void endProfilerFrame(GpuProfiler& profiler);
+
+// Ouvre une section dans l'image en cours. Renvoie l'emplacement à passer à endProfilerScope, -1 si la
+// section n'est pas chronométrée (profileur désactivé, hors image ou trop de sections).
+int beginProfilerScope(GpuProfiler& profiler, const char* name);
+void endProfilerScope(GpuProfiler& profiler, int sample);
+
+// Section fermée à la fin du bloc. Un profileur nul ne chronomètre rien.
+struct ProfilerScope {
+    GpuProfiler* profiler;
+    int sample;
+    ProfilerScope(GpuProfiler* profiler, const char* name);
+    ~ProfilerScope();
+    ProfilerScope(const ProfilerScope&) = delete;
+    ProfilerScope& operator=(const ProfilerScope&) = delete;
+};
+
+// Lit les résultats arrivés ; avec wait, attend toutes les images en vol (fin d'un rendu hors écran)
+void collectProfilerResults(GpuProfiler& profiler, bool wait);
+
+// Moyenne sur les count dernières images, en ms ; négative si la section n'a aucun temps
+double profilerMeanMs(const GpuProfiler& profiler, int scope, bool gpu, int count = kProfilerHistory);
+
+// Écrit l'historique : une ligne par image, deux colonnes (GPU et CPU) par section
+bool writeProfilerCsv(const GpuProfiler& profiler, const std::string& path);
+
+// Graphe glissant des temps GPU de chaque section et tableau des moyennes GPU/CPU dans la fenêtre ImGui
+// courante. Le bouton d'export écrit l'historique dans csvPath.
+void drawProfilerPanel(GpuProfiler& profiler, const std::string& csvPath);
+
+void destroyGpuProfiler(GpuProfiler& profiler);
+
+#endif
@@ -0,0 +1,844 @@
+#include "headless.h"
+#include "image_io.h"
+#include "dynamic_resolution.h"
+#include "scene_picking.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <filesystem>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#ifdef HEADLESS_EGL
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#ifdef HEADLESS_OSMESA
+#include <GL/osmesa.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Contexte OpenGL sans fenêtre, créé avec EGL ou OSMesa
+struct HeadlessContext {
+#ifdef HEADLESS_EGL
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLContext compileContext = EGL_NO_CONTEXT; // Partagé avec context, pour le thread de compilation
+#endif
+#ifdef HEADLESS_OSMESA
+    OSMesaContext osmesaContext = nullptr;
+    std::vector<unsigned char> osmesaBuffer;
+#endif
+};
+
+#ifdef HEADLESS_EGL
+bool createEGLContext(HeadlessContext& ctx) {
+    // Préférer la plateforme surfaceless de Mesa, qui ne nécessite aucun serveur d'affichage
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) {
+        ctx.display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (ctx.display == EGL_NO_DISPLAY) {
+        ctx.display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major, minor;
+    if (ctx.display == EGL_NO_DISPLAY || !eglInitialize(ctx.display, &major, &minor)) {
+        std::cerr << "Failed to initialize EGL display" << std::endl;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "Failed to bind the OpenGL API with EGL" << std::endl;
+        return false;
+    }
+
+    // Contexte sans configuration ni surface : tout le rendu passe par un FBO
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    ctx.context = eglCreateContext(ctx.display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+    if (ctx.context == EGL_NO_CONTEXT) {
+        std::cerr << "Failed to create EGL context (error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        return false;
+    }
+
+    if (!eglMakeCurrent(ctx.display, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx.context)) {
+        std::cerr << "Failed to make the EGL context current" << std::endl;
+        return false;
+    }
+    return true;
+}
+#endif
+
+#ifdef HEADLESS_OSMESA
+bool createOSMesaContext(HeadlessContext& ctx) {
+    const int attribs[] = {
+        OSMESA_FORMAT, OSMESA_RGBA,
+        OSMESA_DEPTH_BITS, 0,
+        OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+        OSMESA_CONTEXT_MAJOR_VERSION, 3,
+        OSMESA_CONTEXT_MINOR_VERSION, 3,
+        0
+    };
+    ctx.osmesaContext = OSMesaCreateContextAttribs(attribs, nullptr);
+    if (!ctx.osmesaContext) {
+        std::cerr << "Failed to create OSMesa context" << std::endl;
+        return false;
+    }
+
+    // OSMesa exige un tampon de rendu, mais la scène est dessinée dans un FBO
+    const int bufferSize = 16;
+    ctx.osmesaBuffer.resize(bufferSize * bufferSize * 4);
+    if (!OSMesaMakeCurrent(ctx.osmesaContext, ctx.osmesaBuffer.data(), GL_UNSIGNED_BYTE, bufferSize, bufferSize)) {
+        std::cerr << "Failed to make the OSMesa context current" << std::endl;
+        return false;
+    }
+    return true;
+}
+#endif
+
+bool createHeadlessContext(HeadlessBackend backend, HeadlessContext& ctx) {
+    switch (backend) {
+    case HeadlessBackend::EGL:
+#ifdef HEADLESS_EGL
+        return createEGLContext(ctx);
+#else
+        std::cerr << "EGL support was not compiled in (build with -DHEADLESS_EGL)" << std::endl;
+        return false;
+#endif
+    case HeadlessBackend::OSMesa:
+#ifdef HEADLESS_OSMESA
+        return createOSMesaContext(ctx);
+#else
+        std::cerr << "OSMesa support was not compiled in (build with -DHEADLESS_OSMESA)" << std::endl;
+        return false;
+#endif
+    }
+    return false;
+}
+
+// Second contexte partagé avec celui du rendu, rendu courant par le thread de compilation des shaders
+bool startHeadlessShaderCompiler(HeadlessContext& ctx, ShaderCompiler& compiler) {
+#ifdef HEADLESS_EGL
+    if (ctx.context != EGL_NO_CONTEXT) {
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        ctx.compileContext = eglCreateContext(ctx.display, EGL_NO_CONFIG_KHR, ctx.context, contextAttribs);
+        if (ctx.compileContext == EGL_NO_CONTEXT) {
+            std::cerr << "Failed to create the shader compilation context (error 0x" << std::hex << eglGetError()
+                      << std::dec << ")" << std::endl;
+            return false;
+        }
+        EGLDisplay display = ctx.display;
+        EGLContext context = ctx.compileContext;
+        return startShaderCompiler(compiler,
+                                   [display, context]() { eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context); },
+                                   [display]() { eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT); },
+                                   nullptr);
+    }
+#endif
+    (void)ctx;
+    (void)compiler;
+    std::cerr << "Asynchronous compilation needs the EGL backend" << std::endl;
+    return false;
+}
+
+void destroyHeadlessContext(HeadlessContext& ctx) {
+#ifdef HEADLESS_EGL
+    if (ctx.compileContext != EGL_NO_CONTEXT) {
+        eglDestroyContext(ctx.display, ctx.compileContext);
+    }
+    if (ctx.context != EGL_NO_CONTEXT) {
+        eglMakeCurrent(ctx.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(ctx.display, ctx.context);
+    }
+    if (ctx.display != EGL_NO_DISPLAY) {
+        eglTerminate(ctx.display);
+    }
+#endif
+#ifdef HEADLESS_OSMESA
+    if (ctx.osmesaContext) {
+        OSMesaDestroyContext(ctx.osmesaContext);
+    }
+#endif
+    (void)ctx;
+}
+
+void printHeadlessUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --headless [egl|osmesa] [options]\n"
+              << "  --size WxH            output resolution (default 800x600)\n"
+              << "  --time-start T        first iTime value (default 0)\n"
+              << "  --time-end T          last iTime value (default 10)\n"
+              << "  --frames N            number of frames in the range (default 100)\n"
+              << "  --mouse U,V           normalized iMouse position, origin bottom-left (default 0.5,0.5)\n"
+              << "  --fov DEG             field of view in degrees (default 55)\n"
+              << "  --output DIR          directory for frame_XXXX.ppm files (default frames)\n"
+              << "  --no-output           render without writing frames, for benchmarking\n"
+              << "  --no-bounds           disable bounding volumes and primary ray clipping in scene()\n"
+              << "  --hard-shadows        binary shadows instead of the soft penumbra\n"
+              << "  --relaxation W        over-relaxed sphere tracing of primary rays, steps lengthened by W (1-2)\n"
+              << "  --basic-shadows-only  cast shadows only for materials lit by basicLighting\n"
+              << "  --analytic            intersect the ground plane and spheres analytically, march only the other objects\n"
+              << "  --pick U,V            pick the object under normalized pixel U,V of the last frame on the CPU\n"
+              << "  --gbuffer FILE        write the primary-ray distance and material of the last frame to FILE\n"
+              << "                        (checked against the CPU port by cpu_bench --gpu-gbuffer FILE)\n"
+              << "  --count-sdf           report SDF evaluations, march steps and exhausted rays (counter mode, not timed)\n"
+              << "  --step-heatmap N      output march cost as colours: 1 primary steps, 2 shadow steps, 3 total\n"
+              << "  --no-static-field     evaluate static objects analytically instead of the baked 3D texture\n"
+              << "  --cone-prepass N      march one cone per NxN tile (4 or 8) to seed the primary rays\n"
+              << "  --no-vignette, --no-gamma, --sepia, --hue-shift\n"
+              << "                        post-processing effects compiled into the shader variant\n"
+              << "  --quality N           shader quality tier: 0 fast, 1 normal (default), 2 fine (march step counts)\n"
+              << "  --deferred            march, shading and post-processing as separate passes, timed on the GPU\n"
+              << "  --checkerboard        march half the pixels each frame and reproject the others from the previous frame\n"
+              << "  --checkerboard-compare  also render each frame in full (not timed) and report the PSNR of the checkerboard\n"
+              << "  --edge-aa             anti-alias edge pixels (material or depth discontinuity) with 4 rays each\n"
+              << "  --edge-threshold T    relative inverse-depth jump that makes an edge pixel (default 0.05)\n"
+              << "  --edge-aa-compare     --edge-aa, and report the PSNR against 4x SSAA of every pixel (not timed)\n"
+              << "  --ssaa                4 rays for every pixel (the reference of --edge-aa)\n"
+              << "  --budget MS           dynamic resolution: scale the scene (0.5x-1.0x) to fit MS of GPU time per frame\n"
+              << "  --no-program-cache    compile the shader variants from source instead of reading ../cache\n"
+              << "  --async-compile       compile the shader variants on a worker thread with a shared EGL context\n"
+              << "  --profile-csv FILE    write GPU and CPU times per pass and per frame to FILE\n"
+              << "  --replay FILE         drive iTime, iMouse, fov, object position and rotations from an input recording\n"
+              << "  --timestep S          recording seconds per replayed frame (default 1/60)\n"
+              << "  --warmup N            render N frames before measuring\n"
+              << "  --report FILE         write mean, p50, p95 and p99 frame times as JSON\n"
+              << "  --baseline FILE       compare the frame times with a previous --report\n"
+              << "  --max-regression PCT  exit with status 2 if p95 exceeds the baseline by more than PCT percent\n"
+              << "  --static-field-resolution N\n"
+              << "                        samples per axis of the static distance field (default 64)\n";
+}
+
+} // namespace
+
+bool isHeadlessRequested(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseHeadlessOptions(int argc, char** argv, HeadlessOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--headless") {
+            // Le backend est optionnel : "--headless osmesa"
+            if (hasValue && argv[i + 1][0] != '-') {
+                std::string backend = argv[++i];
+                if (backend == "egl") {
+                    options.backend = HeadlessBackend::EGL;
+                } else if (backend == "osmesa") {
+                    options.backend = HeadlessBackend::OSMesa;
+                } else {
+                    std::cerr << "Unknown headless backend: " << backend << std::endl;
+                    printHeadlessUsage(argv[0]);
+                    return false;
+                }
+            }
+        } else if (arg == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2) {
+                std::cerr << "Invalid size: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--time-start" && hasValue) {
+            options.timeStart = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--time-end" && hasValue) {
+            options.timeEnd = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--frames" && hasValue) {
+            options.frames = std::atoi(argv[++i]);
+        } else if (arg == "--mouse" && hasValue) {
+            if (std::sscanf(argv[++i], "%f,%f", &options.mouseU, &options.mouseV) != 2) {
+                std::cerr << "Invalid mouse position: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--fov" && hasValue) {
+            options.params.fov = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--output" && hasValue) {
+            options.outputDir = argv[++i];
+        } else if (arg == "--no-output") {
+            options.writeFrames = false;
+        } else if (arg == "--no-bounds") {
+            options.params.boundsEnabled = false;
+        } else if (arg == "--relaxation" && hasValue) {
+            options.params.overRelaxationEnabled = true;
+            options.params.marchRelaxation = std::strtof(argv[++i], nullptr);
+            if (options.params.marchRelaxation < 1.0f || options.params.marchRelaxation >= 2.0f) {
+                std::cerr << "Invalid relaxation factor: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--analytic") {
+            options.params.analyticIntersectionsEnabled = true;
+        } else if (arg == "--hard-shadows") {
+            options.params.softShadowsEnabled = false;
+        } else if (arg == "--basic-shadows-only") {
+            options.params.shadowsAllModels = false;
+        } else if (arg == "--pick" && hasValue) {
+            options.pick = true;
+            if (std::sscanf(argv[++i], "%f,%f", &options.pickU, &options.pickV) != 2) {
+                std::cerr << "Invalid pick position: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--gbuffer" && hasValue) {
+            options.gBufferPath = argv[++i];
+        } else if (arg == "--count-sdf") {
+            options.countSdf = true;
+        } else if (arg == "--step-heatmap" && hasValue) {
+            options.params.stepHeatmap = std::atoi(argv[++i]);
+            if (options.params.stepHeatmap < 0 || options.params.stepHeatmap > 3) {
+                std::cerr << "Invalid step heatmap mode: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--no-static-field") {
+            options.params.staticFieldEnabled = false;
+        } else if (arg == "--cone-prepass" && hasValue) {
+            options.params.conePrepassEnabled = true;
+            options.params.coneTileSize = std::atoi(argv[++i]);
+            if (options.params.coneTileSize < 2) {
+                std::cerr << "Invalid cone tile size: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--no-vignette") {
+            options.params.vignetteEnabled = false;
+        } else if (arg == "--no-gamma") {
+            options.params.gammaCorrectionEnabled = false;
+        } else if (arg == "--sepia") {
+            options.params.sepiaEnabled = true;
+        } else if (arg == "--hue-shift") {
+            options.params.hueShiftEnabled = true;
+        } else if (arg == "--quality" && hasValue) {
+            options.params.qualityTier = std::atoi(argv[++i]);
+            if (options.params.qualityTier < 0 || options.params.qualityTier > 2) {
+                std::cerr << "Invalid quality tier: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--deferred") {
+            options.params.deferredEnabled = true;
+        } else if (arg == "--checkerboard") {
+            options.params.checkerboardEnabled = true;
+        } else if (arg == "--checkerboard-compare") {
+            options.params.checkerboardEnabled = true;
+            options.compareCheckerboard = true;
+        } else if (arg == "--edge-aa") {
+            options.params.antialiasing = 1;
+        } else if (arg == "--edge-aa-compare") {
+            options.params.antialiasing = 1;
+            options.compareAntialiasing = true;
+        } else if (arg == "--ssaa") {
+            options.params.antialiasing = 2;
+        } else if (arg == "--edge-threshold" && hasValue) {
+            options.params.edgeThreshold = std::strtof(argv[++i], nullptr);
+            if (options.params.edgeThreshold <= 0.0f) {
+                std::cerr << "Invalid edge threshold: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (arg == "--no-program-cache") {
+            options.programCache = false;
+        } else if (arg == "--async-compile") {
+            options.asyncCompile = true;
+        } else if (arg == "--profile-csv" && hasValue) {
+            options.profileCsv = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            options.replayPath = argv[++i];
+        } else if (arg == "--timestep" && hasValue) {
+            options.replayTimestep = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--warmup" && hasValue) {
+            options.warmupFrames = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--report" && hasValue) {
+            options.reportPath = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            options.baselinePath = argv[++i];
+        } else if (arg == "--max-regression" && hasValue) {
+            options.maxRegressionPercent = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--budget" && hasValue) {
+            options.budgetMs = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--static-field-resolution" && hasValue) {
+            options.staticFieldResolution = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printHeadlessUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.width <= 0 || options.height <= 0 || options.frames <= 0 || options.staticFieldResolution < 2) {
+        std::cerr << "Size and frame count must be positive, static field resolution at least 2" << std::endl;
+        return false;
+    }
+    if (options.replayTimestep <= 0.0) {
+        std::cerr << "Replay timestep must be positive" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int runHeadless(const HeadlessOptions& options) {
+    // Avec un enregistrement, le nombre d'images découle de sa durée et du pas fixe
+    InputRecording recording;
+    int frames = options.frames;
+    if (!options.replayPath.empty()) {
+        if (!loadInputRecording(options.replayPath, recording)) {
+            std::cerr << "Failed to read input recording " << options.replayPath << std::endl;
+            return -1;
+        }
+        frames = (int)std::floor(inputRecordingDuration(recording) / options.replayTimestep) + 1;
+        std::cout << "Replaying " << options.replayPath << ": " << recording.samples.size() << " samples, "
+                  << frames << " frames at " << options.replayTimestep << " s per frame" << std::endl;
+    }
+    FrameTimeStats baseline;
+    if (!options.baselinePath.empty() && !readBenchmarkBaseline(options.baselinePath, baseline)) {
+        std::cerr << "Failed to read baseline report " << options.baselinePath << std::endl;
+        return -1;
+    }
+
+    HeadlessContext ctx;
+    if (!createHeadlessContext(options.backend, ctx)) {
+        destroyHeadlessContext(ctx);
+        return -1;
+    }
+
+    glewExperimental = GL_TRUE;
+    GLenum glewStatus = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // Une GLEW compilée pour GLX signale l'absence d'affichage X après avoir chargé les fonctions GL
+    if (glewStatus == GLEW_ERROR_NO_GLX_DISPLAY) {
+        glewStatus = GLEW_OK;
+    }
+#endif
+    if (glewStatus != GLEW_OK) {
+        std::cerr << "Failed to initialize GLEW" << std::endl;
+        destroyHeadlessContext(ctx);
+        return -1;
+    }
+
+    std::cout << "Headless renderer: " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize);
+    if (options.width > maxSize || options.height > maxSize) {
+        std::cerr << "Resolution exceeds GL_MAX_RENDERBUFFER_SIZE (" << maxSize << ")" << std::endl;
+        destroyHeadlessContext(ctx);
+        return -1;
+    }
+
+    SceneRenderer renderer;
+    renderer.staticFieldResolution = options.staticFieldResolution;
+    if (!options.programCache) {
+        renderer.programCacheDirectory.clear();
+    }
+    // Les images rendues doivent correspondre aux shaders du début à la fin de la séquence
+    renderer.hotReloadEnabled = false;
+    ShaderCompiler compiler;
+    compiler.cacheDirectory = renderer.programCacheDirectory;
+    if (options.asyncCompile) {
+        if (!startHeadlessShaderCompiler(ctx, compiler)) {
+            destroyHeadlessContext(ctx);
+            return -1;
+        }
+        renderer.compiler = &compiler;
+    }
+    if (!initSceneRenderer(renderer)) {
+        stopShaderCompiler(compiler);
+        destroySceneRenderer(renderer);
+        destroyHeadlessContext(ctx);
+        return -1;
+    }
+
+    // FBO hors écran à la résolution demandée
+    GLuint fbo, colorBuffer;
+    glGenFramebuffers(1, &fbo);
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, options.width, options.height);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Offscreen framebuffer is incomplete" << std::endl;
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        stopShaderCompiler(compiler);
+        destroySceneRenderer(renderer);
+        destroyHeadlessContext(ctx);
+        return -1;
+    }
+
+    if (options.writeFrames) {
+        std::error_code ec;
+        fs::create_directories(options.outputDir, ec);
+        if (ec) {
+            std::cerr << "Failed to create output directory " << options.outputDir << ": " << ec.message() << std::endl;
+        }
+    }
+
+    DynamicResolution dynamicResolution;
+    dynamicResolution.enabled = options.budgetMs > 0.0f;
+    dynamicResolution.budgetMs = options.budgetMs;
+    if (dynamicResolution.enabled && !initDynamicResolution(dynamicResolution)) {
+        dynamicResolution.enabled = false;
+    }
+    double scaleSum = 0.0;
+
+    GpuProfiler profiler;
+    profiler.historyLength = frames;
+    if (!options.profileCsv.empty()) {
+        if (initGpuProfiler(profiler)) {
+            renderer.profiler = &profiler;
+        } else {
+            std::cerr << "Failed to create the GPU profiler queries" << std::endl;
+        }
+    }
+
+    SceneParams params = options.params;
+    params.mouseX = options.mouseU * options.width;
+    params.mouseY = options.mouseV * options.height;
+
+    std::vector<unsigned char> pixels((size_t)options.width * options.height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+    using clock = std::chrono::steady_clock;
+    double renderSeconds = 0.0;
+    double minFrameMs = 1e30, maxFrameMs = 0.0;
+    double sdfEvaluationsSum = 0.0;
+    int sdfEvaluationsMax = 0;
+    double primaryStepsSum = 0.0;
+    double checkerPsnrSum = 0.0;
+    double fullFrameMsSum = 0.0;
+    int checkerComparisons = 0;
+    double edgePsnrSum = 0.0;
+    double aliasedPsnrSum = 0.0;
+    double ssaaMsSum = 0.0;
+    int antialiasingComparisons = 0;
+    long long edgePixelsSum = 0;
+    double shadowStepsSum = 0.0;
+    int primaryStepsMax = 0;
+    int shadowStepsMax = 0;
+    long long totalStepsSum = 0;
+    long long exhaustedPrimarySum = 0;
+    long long exhaustedShadowSum = 0;
+    double prepassStepsSum = 0.0;
+    DeferredPassTimings passSums;
+    long long lastPassSample = 0;
+    double submitMsSum = 0.0;
+    int submitSamples = 0;
+    double compileWaitMs = 0.0;
+    std::vector<double> frameTimes;
+    clock::time_point start = clock::now();
+
+    // Les images de chauffe (indices négatifs) reprennent les paramètres de la première image
+    for (int frame = -options.warmupFrames; frame < frames; ++frame) {
+        int index = std::max(frame, 0);
+        if (!recording.samples.empty()) {
+            applyInputRecording(recording, index * options.replayTimestep, options.width, options.height, params);
+        } else {
+            params.time = frames > 1
+                ? options.timeStart + (options.timeEnd - options.timeStart) * index / (frames - 1)
+                : options.timeStart;
+        }
+
+        // Compilation asynchrone : attendre la variante de l'image, hors chronométrage du rendu
+        if (renderer.compiler) {
+            clock::time_point waitStart = clock::now();
+            while (renderer.programs.empty() || !sceneVariantReady(renderer, params)) {
+                if (!updateSceneCompilation(renderer)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                if (renderer.programs.empty() && !renderer.pendingBuild.active) {
+                    std::cerr << "Failed to build the scene program:\n" << renderer.buildLog << std::endl;
+                    break;
+                }
+            }
+            compileWaitMs += std::chrono::duration<double, std::milli>(clock::now() - waitStart).count();
+        }
+
+        // Images de chauffe : rendues, mais ni chronométrées ni écrites
+        if (frame < 0) {
+            renderSceneDynamic(dynamicResolution, renderer, params, options.width, options.height);
+            glFinish();
+            start = clock::now();
+            continue;
+        }
+
+        // Temps de rendu seul : glFinish attend la fin du tracé sur le GPU
+        clock::time_point frameStart = clock::now();
+        if (renderer.profiler) {
+            beginProfilerFrame(profiler);
+        }
+        renderSceneDynamic(dynamicResolution, renderer, params, options.width, options.height);
+        if (renderer.profiler) {
+            endProfilerFrame(profiler);
+        }
+        glFinish();
+        scaleSum += (double)dynamicResolution.renderWidth / options.width;
+        updateEdgePixelCount(renderer);
+        edgePixelsSum += renderer.edgePixelCount;
+
+        // Temps CPU de soumission ; la première image compile la variante du shader et n'est pas comptée
+        if (frame > 0 || frames == 1) {
+            submitMsSum += renderer.submitTimings.lastMs;
+            ++submitSamples;
+        }
+
+        // Horodatages d'une image précédente, revenus pendant ce rendu
+        const DeferredPassTimings& passes = renderer.passTimings;
+        if (passes.samples != lastPassSample) {
+            lastPassSample = passes.samples;
+            passSums.prepassMs += passes.prepassMs;
+            passSums.marchMs += passes.marchMs;
+            passSums.shadingMs += passes.shadingMs;
+            passSums.edgeDetectMs += passes.edgeDetectMs;
+            passSums.supersampleMs += passes.supersampleMs;
+            passSums.postMs += passes.postMs;
+            ++passSums.samples;
+        }
+        double frameMs = std::chrono::duration<double, std::milli>(clock::now() - frameStart).count();
+
+        renderSeconds += frameMs / 1000.0;
+        frameTimes.push_back(frameMs);
+        minFrameMs = std::min(minFrameMs, frameMs);
+        maxFrameMs = std::max(maxFrameMs, frameMs);
+
+        if (options.writeFrames) {
+            glReadPixels(0, 0, options.width, options.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+            std::ostringstream name;
+            name << "frame_" << std::setw(4) << std::setfill('0') << frame << ".ppm";
+            writePPM((fs::path(options.outputDir) / name.str()).string(), options.width, options.height, pixels);
+        }
+
+        // Passes supplémentaires hors chronométrage ; la première image du damier n'a pas d'historique
+        if (options.compareCheckerboard) {
+            ImageComparison comparison = compareCheckerboard(renderer, params, options.width, options.height);
+            if (comparison.valid && frame > 0) {
+                checkerPsnrSum += comparison.psnr;
+                fullFrameMsSum += comparison.referenceMs;
+                ++checkerComparisons;
+            }
+        }
+        if (options.compareAntialiasing) {
+            ImageComparison comparison = compareEdgeAntialiasing(renderer, params, options.width, options.height);
+            if (comparison.valid) {
+                edgePsnrSum += comparison.psnr;
+                aliasedPsnrSum += comparison.aliasedPsnr;
+                ssaaMsSum += comparison.referenceMs;
+                ++antialiasingComparisons;
+            }
+        }
+        if (options.countSdf) {
+            SdfCounterStats stats = countSdfEvaluations(renderer, params, options.width, options.height);
+            sdfEvaluationsSum += stats.meanEvaluations;
+            primaryStepsSum += stats.meanPrimarySteps;
+            shadowStepsSum += stats.meanShadowSteps;
+            primaryStepsMax = std::max(primaryStepsMax, stats.maxPrimarySteps);
+            shadowStepsMax = std::max(shadowStepsMax, stats.maxShadowSteps);
+            totalStepsSum += stats.totalPrimarySteps + stats.totalShadowSteps;
+            exhaustedPrimarySum += stats.exhaustedPrimaryRays;
+            exhaustedShadowSum += stats.exhaustedShadowRays;
+            prepassStepsSum += stats.meanPrepassSteps;
+            sdfEvaluationsMax = std::max(sdfEvaluationsMax, stats.maxEvaluations);
+        }
+    }
+
+    double totalSeconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "Rendered " << frames << " frames at " << options.width << "x" << options.height;
+    if (recording.samples.empty()) {
+        std::cout << ", iTime " << options.timeStart << " -> " << options.timeEnd;
+    } else {
+        std::cout << ", replaying " << options.replayPath;
+    }
+    FrameTimeStats frameStats = computeFrameTimeStats(frameTimes);
+    std::cout << "\n"
+              << "  render:  " << renderSeconds * 1000.0 / frames << " ms/frame ("
+              << frames / renderSeconds << " frames/s), min " << minFrameMs << " ms, max " << maxFrameMs << " ms\n"
+              << "  overall: " << totalSeconds * 1000.0 / frames << " ms/frame ("
+              << frames / totalSeconds << " frames/s) including readback and disk writes\n"
+              << "  CPU submit: " << submitMsSum / submitSamples << " ms/frame (uniform blocks, binds and draws, "
+              << (renderer.uniformRing.mapped ? "persistent" : "glBufferSubData") << " ring, "
+              << renderer.uniformRing.fenceWaits << " fence waits)\n"
+              << "  frame times: mean " << frameStats.mean << " ms, p50 " << frameStats.p50 << " ms, p95 "
+              << frameStats.p95 << " ms, p99 " << frameStats.p99 << " ms" << std::endl;
+    if (renderer.compiler) {
+        std::cout << "  async compile: " << compileWaitMs << " ms waiting for shader variants ("
+                  << (renderer.compiler->parallelCompile ? "parallel" : "serial") << " driver compilation)" << std::endl;
+    }
+    if (dynamicResolution.enabled) {
+        std::cout << "  dynamic resolution: budget " << options.budgetMs << " ms, mean scale " << scaleSum / frames
+                  << ", final scale " << dynamicResolution.scale << " (" << dynamicResolution.renderWidth << "x"
+                  << dynamicResolution.renderHeight << ", last GPU time " << dynamicResolution.gpuMs << " ms)" << std::endl;
+    }
+    if (options.params.checkerboardEnabled && passSums.samples > 0) {
+        double n = (double)passSums.samples;
+        std::cout << "  checkerboard passes (GPU, mean of " << passSums.samples << " frames): cone prepass "
+                  << passSums.prepassMs / n << " ms, half march " << passSums.marchMs / n << " ms, reconstruction "
+                  << passSums.shadingMs / n << " ms, post " << passSums.postMs / n << " ms" << std::endl;
+    } else if (options.params.antialiasing != 0 && passSums.samples > 0) {
+        double n = (double)passSums.samples;
+        std::cout << "  anti-aliased passes (GPU, mean of " << passSums.samples << " frames): cone prepass "
+                  << passSums.prepassMs / n << " ms, march " << passSums.marchMs / n << " ms, shading "
+                  << passSums.shadingMs / n << " ms, edge detection " << passSums.edgeDetectMs / n << " ms, "
+                  << (options.params.antialiasing == 1 ? "edge rays " : "supersampling ") << passSums.supersampleMs / n
+                  << " ms, post " << passSums.postMs / n << " ms\n"
+                  << "  supersampled pixels: " << (double)edgePixelsSum / frames << " per frame ("
+                  << 100.0 * edgePixelsSum / frames / ((double)options.width * options.height) << "%)"
+                  << std::endl;
+    } else if (options.params.deferredEnabled && passSums.samples > 0) {
+        double n = (double)passSums.samples;
+        std::cout << "  deferred passes (GPU, mean of " << passSums.samples << " frames): cone prepass "
+                  << passSums.prepassMs / n << " ms, march " << passSums.marchMs / n << " ms, shading "
+                  << passSums.shadingMs / n << " ms, post " << passSums.postMs / n << " ms" << std::endl;
+    }
+    if (checkerComparisons > 0) {
+        std::cout << "  checkerboard vs full frame (mean of " << checkerComparisons << " frames): PSNR "
+                  << checkerPsnrSum / checkerComparisons << " dB, full frame " << fullFrameMsSum / checkerComparisons
+                  << " ms GPU" << std::endl;
+    }
+    if (antialiasingComparisons > 0) {
+        std::cout << "  edge anti-aliasing vs 4x SSAA (mean of " << antialiasingComparisons << " frames): PSNR "
+                  << edgePsnrSum / antialiasingComparisons << " dB (" << aliasedPsnrSum / antialiasingComparisons
+                  << " dB without anti-aliasing), 4x SSAA " << ssaaMsSum / antialiasingComparisons << " ms GPU"
+                  << std::endl;
+    }
+    if (renderer.profiler) {
+        collectProfilerResults(profiler, true);
+        std::cout << "  profiled passes (mean GPU / CPU ms):";
+        for (size_t scope = 0; scope < profiler.scopeNames.size(); ++scope) {
+            std::cout << (scope > 0 ? "," : "") << " " << profiler.scopeNames[scope] << " "
+                      << profilerMeanMs(profiler, (int)scope, true, frames) << " / "
+                      << profilerMeanMs(profiler, (int)scope, false, frames);
+        }
+        std::cout << std::endl;
+        if (writeProfilerCsv(profiler, options.profileCsv)) {
+            std::cout << "  profile written to " << options.profileCsv << " (" << profiler.history.size() << " frames)" << std::endl;
+        } else {
+            std::cerr << "Failed to write " << options.profileCsv << std::endl;
+        }
+        destroyGpuProfiler(profiler);
+    }
+    if (options.countSdf) {
+        std::cout << "  SDF evaluations per pixel: mean " << sdfEvaluationsSum / frames
+                  << ", max " << sdfEvaluationsMax << (options.params.boundsEnabled ? "" : " (bounds disabled)") << "\n"
+                  << "  primary ray steps per pixel: mean " << primaryStepsSum / frames;
+        if (options.params.conePrepassEnabled) {
+            std::cout << " + " << prepassStepsSum / frames << " cone steps (" << options.params.coneTileSize
+                      << "x" << options.params.coneTileSize << " tiles)";
+        }
+        std::cout << ", max " << primaryStepsMax << "\n"
+                  << "  shadow ray steps per pixel: mean " << shadowStepsSum / frames << ", max " << shadowStepsMax << "\n"
+                  << "  march steps per frame: " << totalStepsSum / frames << " (primary + shadow)\n"
+                  << "  rays out of steps per frame: " << (double)exhaustedPrimarySum / frames << " primary, "
+                  << (double)exhaustedShadowSum / frames << " shadow" << std::endl;
+    }
+    if (options.pick) {
+        // Graphe aplati et rayon refaits à chaque sélection, comme pour un clic dans la fenêtre
+        const int picks = 1000;
+        glm::vec2 fragCoord(options.pickU * options.width, options.pickV * options.height);
+        ScenePick pick;
+        clock::time_point pickStart = clock::now();
+        for (int i = 0; i < picks; ++i) {
+            std::vector<SdfFlatObject> objects = flattenScene(renderer.sceneGraph);
+            glm::vec3 r0, rD;
+            pickingRay(params, options.width, options.height, fragCoord, r0, rD);
+            pick = pickScene(objects, params, r0, rD);
+        }
+        double pickUs = std::chrono::duration<double, std::micro>(clock::now() - pickStart).count() / picks;
+        std::cout << "  pick at " << options.pickU << "," << options.pickV << ": ";
+        if (pick.hit) {
+            glm::vec3 p = pick.point;
+            std::cout << flattenScene(renderer.sceneGraph)[pick.object].leaf.name << " (material " << pick.materialId
+                      << "), point (" << p.x << ", " << p.y << ", " << p.z << "), distance " << pick.distance;
+        } else {
+            std::cout << "nothing";
+        }
+        std::cout << ", " << pick.steps << " steps, " << pickUs << " us per pick (mean of " << picks << ")"
+                  << std::endl;
+    }
+
+    if (!options.gBufferPath.empty()) {
+        // Vue de la dernière image, pour que le portage CPU relance les mêmes rayons
+        SurfaceView view;
+        view.width = options.width;
+        view.height = options.height;
+        view.time = params.time;
+        view.mouseX = params.mouseX;
+        view.mouseY = params.mouseY;
+        view.fov = params.fov;
+        for (int axis = 0; axis < 3; ++axis) {
+            view.objectPosition[axis] = params.objectPosition[axis];
+        }
+        view.objectRotation[0] = params.objectRotationX;
+        view.objectRotation[1] = params.objectRotationY;
+        view.objectRotation[2] = params.objectRotationZ;
+        std::vector<float> surface;
+        if (readSceneSurface(renderer, params, options.width, options.height, surface)
+            && writeSurfaceBuffer(options.gBufferPath, view, surface)) {
+            std::cout << "  G-buffer written to " << options.gBufferPath << " (iTime " << params.time << ")" << std::endl;
+        } else {
+            std::cerr << "Failed to write the G-buffer to " << options.gBufferPath << std::endl;
+        }
+    }
+
+    // Comparaison avec la mesure de référence ; une régression du p95 au-delà du seuil change le code de retour
+    int status = 0;
+    bool hasBaseline = !options.baselinePath.empty();
+    if (hasBaseline) {
+        double p95Change = baseline.p95 > 0.0 ? (frameStats.p95 - baseline.p95) / baseline.p95 * 100.0 : 0.0;
+        std::cout << "  baseline " << options.baselinePath << ": mean " << baseline.mean << " -> " << frameStats.mean
+                  << " ms, p50 " << baseline.p50 << " -> " << frameStats.p50 << " ms, p95 " << baseline.p95 << " -> "
+                  << frameStats.p95 << " ms (" << std::showpos << p95Change << std::noshowpos << " %), p99 "
+                  << baseline.p99 << " -> " << frameStats.p99 << " ms" << std::endl;
+        if (options.maxRegressionPercent > 0.0 && p95Change > options.maxRegressionPercent) {
+            std::cerr << "p95 frame time regressed by more than " << options.maxRegressionPercent << " %" << std::endl;
+            status = 2;
+        }
+    }
+    if (!options.reportPath.empty()) {
+        BenchmarkReport report;
+        report.recording = options.replayPath;
+        report.width = options.width;
+        report.height = options.height;
+        report.timestep = recording.samples.empty() ? 0.0 : options.replayTimestep;
+        report.warmupFrames = options.warmupFrames;
+        report.frameMs = frameStats;
+        if (writeBenchmarkReport(options.reportPath, report, hasBaseline ? &baseline : nullptr)) {
+            std::cout << "  report written to " << options.reportPath << std::endl;
+        } else {
+            std::cerr << "Failed to write " << options.reportPath << std::endl;
+        }
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    if (dynamicResolution.enabled) {
+        destroyDynamicResolution(dynamicResolution);
+    }
+    stopShaderCompiler(compiler);
+    destroySceneRenderer(renderer);
+    destroyHeadlessContext(ctx);
+    return status;
+}
@@ -0,0 +1,91 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "scene_renderer.h"
+#include "benchmark.h"
+#include <string>
+
+// Contexte OpenGL utilisé pour le rendu sans affichage
+enum class HeadlessBackend {
+    EGL,    // EGL surfaceless (EGL_MESA_platform_surfaceless)
+    OSMesa  // Rendu logiciel OSMesa
+};
+
+// Options du rendu hors écran d'une séquence d'images
+struct HeadlessOptions {
+    HeadlessBackend backend = HeadlessBackend::EGL;
+    int width = 800;
+    int height = 600;
+
+    // Plage de iTime rendue : frames images réparties de timeStart à timeEnd inclus
+    float timeStart = 0.0f;
+    float timeEnd = 10.0f;
+    int frames = 100;
+
+    // Position de la souris normalisée (0..1, origine en bas à gauche), convertie en pixels comme iMouse
+    float mouseU = 0.5f;
+    float mouseV = 0.5f;
+
+    std::string outputDir = "frames";
+    bool writeFrames = true;
+
+    // Mesure des évaluations SDF par pixel (mode compteur du shader) pour chaque image
+    bool countSdf = false;
+
+    // Rendu en damier comparé à chaque image à l'image complète (PSNR et temps GPU, hors chronométrage)
+    bool compareCheckerboard = false;
+
+    // Anticrénelage des bords comparé à chaque image au 4x SSAA de tous les pixels (PSNR et temps GPU, hors
+    // chronométrage)
+    bool compareAntialiasing = false;
+
+    // Sélection CPU (scene_picking.h) au pixel (pickU, pickV) normalisé de la dernière image, chronométrée
+    bool pick = false;
+    float pickU = 0.5f;
+    float pickV = 0.5f;
+
+    // Fichier du G-buffer (distance, matériau) des rayons primaires de la dernière image, avec sa vue, vide pour
+    // ne pas l'écrire (image_io.h)
+    std::string gBufferPath;
+
+    // Résolution par axe du champ de distance des objets statiques
+    int staticFieldResolution = 64;
+
+    // Relire les variantes du shader dans le cache des programmes compilés (démarrage à chaud)
+    bool programCache = true;
+
+    // Compiler les variantes sur un thread avec un second contexte partagé (EGL seulement) ; chaque image
+    // attend que sa variante soit prête, pour mesurer le temps de compilation masqué
+    bool asyncCompile = false;
+
+    // Fichier CSV des temps GPU et CPU par passe et par image (gpu_profiler.h), vide pour ne pas chronométrer
+    std::string profileCsv;
+
+    // Résolution dynamique : budget de temps GPU par image en ms, 0 pour la désactiver
+    float budgetMs = 0.0f;
+
+    // Mesure reproductible : iTime, iMouse, FOV, position et rotations relus dans un enregistrement
+    // (benchmark.h) au pas fixe replayTimestep, à la place de la plage de iTime et de la souris fixe
+    std::string replayPath;
+    double replayTimestep = kDefaultReplayTimestep;
+    int warmupFrames = 0; // Images rendues avant la mesure, hors statistiques
+
+    // Rapport JSON des temps d'image, comparé à un rapport de référence. Avec maxRegressionPercent > 0,
+    // le code de retour est 2 si le p95 dépasse celui de la référence de plus de ce pourcentage.
+    std::string reportPath;
+    std::string baselinePath;
+    double maxRegressionPercent = 0.0;
+
+    SceneParams params;
+};
+
+// Renvoie vrai si la ligne de commande demande le mode hors écran (--headless)
+bool isHeadlessRequested(int argc, char** argv);
+
+// Analyse la ligne de commande. Renvoie faux et affiche l'aide en cas d'option invalide.
+bool parseHeadlessOptions(int argc, char** argv, HeadlessOptions& options);
+
+// Rend la séquence dans un FBO hors écran, écrit les images et affiche les statistiques de débit
+int runHeadless(const HeadlessOptions& options);
+
+#endif
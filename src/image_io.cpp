@@ -0,0 +1,74 @@
+#include "image_io.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+bool writePPM(const std::string& path, int width, int height, const std::vector<unsigned char>& rgba) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    // Les lignes OpenGL partent du bas de l'image, le PPM du haut
+    std::vector<unsigned char> row(width * 3);
+    for (int y = height - 1; y >= 0; --y) {
+        const unsigned char* src = &rgba[(size_t)y * width * 4];
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = src[x * 4 + 0];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        file.write((const char*)row.data(), row.size());
+    }
+
+    return (bool)file;
+}
+
+bool writeSurfaceBuffer(const std::string& path, const SurfaceView& view, const std::vector<float>& surface) {
+    if (surface.size() != (size_t)view.width * view.height * 2) {
+        return false;
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    // Valeurs décimales à 9 chiffres significatifs : relues au bit près
+    file.precision(9);
+    file << "SURF\n" << view.width << " " << view.height << "\n"
+         << view.time << " " << view.mouseX << " " << view.mouseY << " " << view.fov << "\n"
+         << view.objectPosition[0] << " " << view.objectPosition[1] << " " << view.objectPosition[2] << " "
+         << view.objectRotation[0] << " " << view.objectRotation[1] << " " << view.objectRotation[2] << "\n";
+    file.write((const char*)surface.data(), surface.size() * sizeof(float));
+    return (bool)file;
+}
+
+bool readSurfaceBuffer(const std::string& path, SurfaceView& view, std::vector<float>& surface) {
+    std::ifstream file(path, std::ios::binary);
+    std::string magic;
+    if (!file || !(file >> magic) || magic != "SURF") {
+        return false;
+    }
+    file >> view.width >> view.height >> view.time >> view.mouseX >> view.mouseY >> view.fov
+         >> view.objectPosition[0] >> view.objectPosition[1] >> view.objectPosition[2]
+         >> view.objectRotation[0] >> view.objectRotation[1] >> view.objectRotation[2];
+    if (!file || file.get() != '\n' || view.width <= 0 || view.height <= 0) {
+        return false;
+    }
+
+    std::streamoff dataStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff remaining = file.tellg() - dataStart;
+    file.seekg(dataStart);
+    std::streamoff expected = (std::streamoff)view.width * view.height * 2 * (std::streamoff)sizeof(float);
+    if (!file || remaining != expected) {
+        return false;
+    }
+    surface.resize((size_t)view.width * view.height * 2);
+    file.read((char*)surface.data(), expected);
+    return (bool)file;
+}
@@ -0,0 +1,30 @@
+#ifndef IMAGE_IO_H
+#define IMAGE_IO_H
+
+#include <string>
+#include <vector>
+
+// Écrit une image RGBA 8 bits (lue avec glReadPixels, origine en bas à gauche) au format PPM binaire
+bool writePPM(const std::string& path, int width, int height, const std::vector<unsigned char>& rgba);
+
+// Vue d'un G-buffer exporté : de quoi relancer les mêmes rayons primaires ailleurs (portage CPU)
+struct SurfaceView {
+    int width = 0;
+    int height = 0;
+    float time = 0.0f;
+    float mouseX = 0.0f; // iMouse en pixels, origine en bas à gauche
+    float mouseY = 0.0f;
+    float fov = 55.0f;   // Degrés
+    float objectPosition[3] = { 0.0f, 0.5f, -1.0f };
+    float objectRotation[3] = { 0.0f, 0.0f, 0.0f }; // Degrés, autour de X, Y et Z
+};
+
+// G-buffer des rayons primaires : en-tête texte "SURF" avec la vue, puis width x height paires de floats binaires
+// (distance, matériau), ligne du bas en premier comme glReadPixels
+bool writeSurfaceBuffer(const std::string& path, const SurfaceView& view, const std::vector<float>& surface);
+
+// Relit un fichier de writeSurfaceBuffer(). La taille annoncée par l'en-tête est vérifiée contre la longueur du
+// fichier avant toute allocation.
+bool readSurfaceBuffer(const std::string& path, SurfaceView& view, std::vector<float>& surface);
+
+#endif
@@ -2,8 +2,6 @@
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <errno.h>
 #include <algorithm>
 #include "../include/imgui.h"
@@ -11,59 +9,14 @@
 #include "../include/imgui_impl_opengl3.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
-
-// Inclure stb_image.h et définir STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "../include/stb_image.h"
-
-// Fonction pour lire un fichier shader
-std::string readFile(const char* filePath) {
-    std::ifstream file(filePath);
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
-}
-
-// Fonction pour compiler un shader
-GLuint compileShader(GLenum type, const std::string& source) {
-    GLuint shader = glCreateShader(type);
-    const char* src = source.c_str();
-    glShaderSource(shader, 1, &src, nullptr);
-    glCompileShader(shader);
-
-    int result;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &result);
-    if (result == GL_FALSE) {
-        int length;
-        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
-        char* message = new char[length];
-        glGetShaderInfoLog(shader, length, &length, message);
-        std::cerr << "Failed to compile shader!" << std::endl;
-        std::cerr << message << std::endl;
-        delete[] message;
-        glDeleteShader(shader);
-        return 0;
-    }
-
-    return shader;
-}
-
-// Fonction pour créer un programme shader
-GLuint createShaderProgram(const std::string& vertexShader, const std::string& fragmentShader) {
-    GLuint program = glCreateProgram();
-    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShader);
-    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentShader);
-
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    glLinkProgram(program);
-    glValidateProgram(program);
-
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-
-    return program;
-}
+#include "scene_renderer.h"
+#include "headless.h"
+#include "scene_editor.h"
+#include "dynamic_resolution.h"
+#include "shader_variants.h"
+#include "benchmark.h"
+#include "scene_picking.h"
+#include <chrono>
 
 // Variables pour stocker les coordonnées de la souris
 double mouseX, mouseY;
@@ -74,41 +27,88 @@ double pausedMouseX, pausedMouseY;
 // Variable pour suivre l'état de pause
 bool paused = false;
 
-// Variable globale pour le FOV
-float fov = 55.0f; // Initialiser avec un FOV par défaut de 45 degrés
+// Décalage entre glfwGetTime() et iTime, recalculé à la reprise pour que le temps reparte de sa valeur figée
+float timeOffset = 0.0f;
+
+// Paramètres de la scène (FOV, position et rotation de l'objet, post-traitements) contrôlés par ImGui
+SceneParams sceneParams;
+
+// Mode compteur : mesure le nombre d'évaluations SDF par pixel à chaque image
+bool sdfCounterEnabled = false;
+
+// Comparaison du rendu en damier avec l'image complète, demandée depuis le panneau et faite après le rendu
+bool checkerboardCompareRequested = false;
+ImageComparison checkerboardComparison;
+
+// Comparaison de l'anticrénelage des bords avec le 4x SSAA de tous les pixels, faite de même après le rendu
+bool antialiasingCompareRequested = false;
+ImageComparison antialiasingComparison;
+
+// Sélection au clic gauche, calculée sur le CPU dans les SDF du graphe : aucune relecture du framebuffer.
+// Un objet qui suit objectPosition se déplace tant que le bouton reste enfoncé, caméra figée.
+ScenePick selectedPick;
+std::string selectedObjectName;
+double pickMicroseconds = 0.0;
+ObjectDrag objectDrag;
+bool leftButtonWasDown = false;
 
-// Variable globale pour la position de l'objet
-glm::vec3 objectPosition(0.0f, 0.5f, -1.0f);
+// Rendu à la demande : en pause, la dernière image présentée est conservée tant qu'aucune entrée n'arrive.
+// ImGui a besoin de quelques images après un événement pour que ses widgets reflètent l'entrée.
+const int kFramesAfterEvent = 3;
+bool onDemandRendering = true;
+int framesToRender = kFramesAfterEvent;
 
-// Variable globale pour la rotation de l'objet
-float objectRotationX = 0.0f; // Initialiser avec une rotation de 0 degrés autour de X
-float objectRotationY = 0.0f; // Initialiser avec une rotation de 0 degrés autour de Y
-float objectRotationZ = 0.0f; // Initialiser avec une rotation de 0 degrés autour de Z
+// Compteur d'images rendues, pour vérifier qu'une scène inactive ne rend plus rien
+long long renderedFrames = 0;
 
-// Variables pour contrôler les post-traitements
-bool vignetteEnabled = true;
-bool gammaCorrectionEnabled = true;
-bool sepiaEnabled = false;
-bool hueShiftEnabled = false;
+// Enregistrement des entrées, relu à pas fixe par --headless --replay pour des mesures reproductibles
+const char* const kInputRecordingPath = "input_recording.txt";
+InputRecorder inputRecorder;
+std::string inputRecordingStatus;
+
+void requestRedraw() {
+    framesToRender = kFramesAfterEvent;
+}
 
 // Fonction de rappel pour les événements clavier
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    requestRedraw();
     if (key == GLFW_KEY_SPACE && action == GLFW_PRESS) {
         paused = !paused;
         if (paused) {
             // Stocker les coordonnées de la souris lors de la pause
             glfwGetCursorPos(window, &pausedMouseX, &pausedMouseY);
+        } else {
+            timeOffset = (float)glfwGetTime() - sceneParams.time;
         }
     }
 }
 
-int main() {
+// Toute autre entrée ou tout changement de la fenêtre demande de nouvelles images
+void cursorPosCallback(GLFWwindow* window, double x, double y) { requestRedraw(); }
+void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) { requestRedraw(); }
+void scrollCallback(GLFWwindow* window, double x, double y) { requestRedraw(); }
+void charCallback(GLFWwindow* window, unsigned int c) { requestRedraw(); }
+void windowRefreshCallback(GLFWwindow* window) { requestRedraw(); }
+void framebufferSizeCallback(GLFWwindow* window, int width, int height) { requestRedraw(); }
+
+int main(int argc, char** argv) {
+    // Rendu hors écran d'une séquence d'images, sans fenêtre
+    if (isHeadlessRequested(argc, argv)) {
+        HeadlessOptions options;
+        if (!parseHeadlessOptions(argc, argv, options)) {
+            return -1;
+        }
+        return runHeadless(options);
+    }
+
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
         return -1;
     }
 
-    // Créer une fenêtre de taille fixe
+    // Créer une fenêtre redimensionnable, de 800x600 au départ
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
     GLFWwindow* window = glfwCreateWindow(800, 600, "OpenGL Shader Example", nullptr, nullptr);
     if (!window) {
         std::cerr << "Failed to create GLFW window" << std::endl;
@@ -123,110 +123,93 @@ int main() {
         return -1;
     }
 
+    // Définir les fonctions de rappel avant l'initialisation d'ImGui, qui les enchaîne avec les siennes
+    glfwSetKeyCallback(window, keyCallback);
+    glfwSetCursorPosCallback(window, cursorPosCallback);
+    glfwSetMouseButtonCallback(window, mouseButtonCallback);
+    glfwSetScrollCallback(window, scrollCallback);
+    glfwSetCharCallback(window, charCallback);
+    glfwSetWindowRefreshCallback(window, windowRefreshCallback);
+    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+
     // Initialisation IMGUI
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init("#version 330");
 
-    // Définir la fonction de rappel pour les événements clavier
-    glfwSetKeyCallback(window, keyCallback);
-
-    // Lire les shaders depuis les fichiers
-    std::string vertexShader = readFile("../src/shaders/vertex_shader.glsl");
-    std::string fragmentShader = readFile("../src/shaders/fragment_shader.glsl");
-
-    GLuint shaderProgram = createShaderProgram(vertexShader, fragmentShader);
-
-    float vertices[] = {
-        // positions          // texture coords
-        -1.0f, -1.0f, 0.0f,  0.0f, 0.0f,
-         1.0f, -1.0f, 0.0f,  1.0f, 0.0f,
-         1.0f,  1.0f, 0.0f,  1.0f, 1.0f,
-        -1.0f,  1.0f, 0.0f,  0.0f, 1.0f
-    };
-
-    GLuint indices[] = {
-        0, 1, 2,
-        2, 3, 0
-    };
-
-    GLuint vao, vbo, ebo;
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glGenBuffers(1, &ebo);
-
-    glBindVertexArray(vao);
-
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // Texture coord attribute
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    // Charger la texture
-    int width, height, nrChannels;
-    unsigned char *data = stbi_load("../src/ressources/texture/pierre.jpg", &width, &height, &nrChannels, 0);
-    if (!data) {
-        std::cerr << "Failed to load texture" << std::endl;
+    // Fenêtre cachée dont le contexte, partagé avec celui de la fenêtre, sert au thread de compilation des
+    // shaders : l'interface reste fluide pendant la compilation des variantes et le rechargement à chaud
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* compileWindow = glfwCreateWindow(1, 1, "", nullptr, window);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    SceneRenderer renderer;
+    ShaderCompiler compiler;
+    compiler.cacheDirectory = renderer.programCacheDirectory;
+    if (compileWindow) {
+        startShaderCompiler(compiler,
+                            [compileWindow]() { glfwMakeContextCurrent(compileWindow); },
+                            []() { glfwMakeContextCurrent(nullptr); },
+                            []() { glfwPostEmptyEvent(); });
+        renderer.compiler = &compiler;
+    } else {
+        std::cerr << "Failed to create the shader compilation context, compiling on the render thread" << std::endl;
+    }
+    if (!initSceneRenderer(renderer)) {
+        stopShaderCompiler(compiler);
         return -1;
     }
 
-    GLuint texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-
-    // Définir les paramètres de la texture
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    // Charger les données de l'image
-    if (nrChannels == 3) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-    } else if (nrChannels == 4) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    DynamicResolution dynamicResolution;
+    if (!initDynamicResolution(dynamicResolution)) {
+        stopShaderCompiler(compiler);
+        return -1;
     }
 
-    glGenerateMipmap(GL_TEXTURE_2D);
-    stbi_image_free(data);
+    // Temps GPU et CPU par passe, lus quelques images plus tard
+    GpuProfiler profiler;
+    if (initGpuProfiler(profiler)) {
+        renderer.profiler = &profiler;
+    } else {
+        std::cerr << "Failed to create the GPU profiler queries" << std::endl;
+    }
 
-    // Obtenir les locations des uniformes
-    GLint iResolutionLocation = glGetUniformLocation(shaderProgram, "iResolution");
-    GLint iTimeLocation = glGetUniformLocation(shaderProgram, "iTime");
-    GLint iMouseLocation = glGetUniformLocation(shaderProgram, "iMouse");
-    GLint fovLocation = glGetUniformLocation(shaderProgram, "fov");
-    GLint objectPositionLocation = glGetUniformLocation(shaderProgram, "objectPosition");
-    GLint objectRotationXLocation = glGetUniformLocation(shaderProgram, "objectRotationX");
-    GLint objectRotationYLocation = glGetUniformLocation(shaderProgram, "objectRotationY");
-    GLint objectRotationZLocation = glGetUniformLocation(shaderProgram, "objectRotationZ");
+    // Images rendues par seconde, mesurées sur des fenêtres d'une seconde
+    double rateWindowStart = glfwGetTime();
+    long long rateWindowFrames = 0;
+    double renderedFramesPerSecond = 0.0;
 
-    // Locations des uniformes pour les post-traitements
-    GLint vignetteEnabledLocation = glGetUniformLocation(shaderProgram, "vignetteEnabled");
-    GLint gammaCorrectionEnabledLocation = glGetUniformLocation(shaderProgram, "gammaCorrectionEnabled");
-    GLint sepiaEnabledLocation = glGetUniformLocation(shaderProgram, "sepiaEnabled");
-    GLint hueShiftEnabledLocation = glGetUniformLocation(shaderProgram, "hueShiftEnabled");
+    while (!glfwWindowShouldClose(window)) {
+        // Programmes rendus par le thread de compilation et shaders modifiés sur le disque
+        if (updateSceneCompilation(renderer)) {
+            requestRedraw();
+        }
 
-    float timeOffset = 0.0f;
+        // Rien ne bouge en pause : attendre un événement plutôt que de rendre la même image. Le délai permet
+        // de relire les dates des fichiers de shader ; le thread de compilation réveille la boucle lui-même.
+        if (onDemandRendering && paused && framesToRender == 0) {
+            glfwWaitEventsTimeout(kShaderWatchInterval);
+            continue;
+        }
+        framesToRender = std::max(0, framesToRender - 1);
+
+        // Taille de la fenêtre (coordonnées du curseur) et du framebuffer (pixels rendus), différentes en HiDPI
+        int windowWidth, windowHeight, framebufferWidth, framebufferHeight;
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        if (framebufferWidth == 0 || framebufferHeight == 0) {
+            // Fenêtre réduite : rien à rendre
+            glfwWaitEvents();
+            continue;
+        }
 
-    while (!glfwWindowShouldClose(window)) {
         if (!paused) {
             // Obtenir les coordonnées de la souris
             glfwGetCursorPos(window, &mouseX, &mouseY);
 
             // Limiter la coordonnée Y de la souris
-            mouseY = std::max(0.1 * 600, std::min(mouseY, 0.9 * 600));
+            mouseY = std::max(0.1 * windowHeight, std::min(mouseY, 0.9 * windowHeight));
         } else {
             // Utiliser les coordonnées de la souris lors de la pause
             mouseX = pausedMouseX;
@@ -234,59 +217,272 @@ int main() {
         }
 
         // Rendu de la scène OpenGL
-        glUseProgram(shaderProgram);
-        glUniform2f(iResolutionLocation, 800, 600);
+        // iTime reste figé pendant la pause
         if (!paused) {
-            glUniform1f(iTimeLocation, (float)glfwGetTime() - timeOffset);
-        } else {
-            timeOffset += (float)glfwGetTime() - timeOffset;
+            sceneParams.time = (float)glfwGetTime() - timeOffset;
+        }
+        // Coordonnées de la souris en pixels du framebuffer, avec origine en bas à gauche
+        sceneParams.mouseX = (float)(mouseX * framebufferWidth / windowWidth);
+        sceneParams.mouseY = (float)((windowHeight - mouseY) * framebufferHeight / windowHeight);
+
+        // Le rayon de sélection part du curseur, même en pause ou hors de la bande où il pilote la caméra
+        double cursorX, cursorY;
+        glfwGetCursorPos(window, &cursorX, &cursorY);
+        glm::vec2 cursor((float)(cursorX * framebufferWidth / windowWidth),
+                         (float)((windowHeight - cursorY) * framebufferHeight / windowHeight));
+        bool leftButtonDown = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        if (objectDrag.active && leftButtonDown) {
+            sceneParams.mouseX = objectDrag.cameraMouse.x;
+            sceneParams.mouseY = objectDrag.cameraMouse.y;
+            glm::vec3 r0, rD;
+            pickingRay(sceneParams, framebufferWidth, framebufferHeight, cursor, r0, rD);
+            updateObjectDrag(objectDrag, r0, rD, sceneParams);
+        } else if (objectDrag.active) {
+            objectDrag.active = false;
+        } else if (leftButtonDown && !leftButtonWasDown && !ImGui::GetIO().WantCaptureMouse) {
+            auto pickStart = std::chrono::steady_clock::now();
+            std::vector<SdfFlatObject> objects = flattenScene(renderer.sceneGraph);
+            glm::vec3 r0, rD;
+            pickingRay(sceneParams, framebufferWidth, framebufferHeight, cursor, r0, rD);
+            selectedPick = pickScene(objects, sceneParams, r0, rD);
+            pickMicroseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - pickStart).count();
+            selectedObjectName = selectedPick.hit ? objects[selectedPick.object].leaf.name : "";
+            beginObjectDrag(objectDrag, objects, selectedPick, rD, sceneParams);
+        }
+        leftButtonWasDown = leftButtonDown;
+
+        recordInputSample(inputRecorder, sceneParams, framebufferWidth, framebufferHeight);
+        beginProfilerFrame(profiler);
+        {
+            ProfilerScope scope(&profiler, "Scène");
+            renderSceneDynamic(dynamicResolution, renderer, sceneParams, framebufferWidth, framebufferHeight);
+        }
+
+        SdfCounterStats sdfStats;
+        if (sdfCounterEnabled) {
+            ProfilerScope scope(&profiler, "Compteur SDF");
+            sdfStats = countSdfEvaluations(renderer, sceneParams, framebufferWidth, framebufferHeight);
+        }
+        if (checkerboardCompareRequested) {
+            checkerboardCompareRequested = false;
+            checkerboardComparison = compareCheckerboard(renderer, sceneParams, framebufferWidth, framebufferHeight);
+        }
+        if (antialiasingCompareRequested) {
+            antialiasingCompareRequested = false;
+            antialiasingComparison = compareEdgeAntialiasing(renderer, sceneParams, framebufferWidth, framebufferHeight);
         }
-        glUniform2f(iMouseLocation, (float)mouseX, (float)(600 - mouseY)); // Coordonnées de la souris avec origine en bas à gauche
-        glUniform1f(fovLocation, glm::radians(fov)); // Envoyer le FOV au shader
-        glUniform3fv(objectPositionLocation, 1, glm::value_ptr(objectPosition)); // Envoyer la position de l'objet au shader
-        glUniform1f(objectRotationXLocation, glm::radians(objectRotationX)); // Envoyer la rotation de l'objet autour de X au shader
-        glUniform1f(objectRotationYLocation, glm::radians(objectRotationY)); // Envoyer la rotation de l'objet autour de Y au shader
-        glUniform1f(objectRotationZLocation, glm::radians(objectRotationZ)); // Envoyer la rotation de l'objet autour de Z au shader
-
-        // Envoyer les états des post-traitements aux shaders
-        glUniform1i(vignetteEnabledLocation, vignetteEnabled);
-        glUniform1i(gammaCorrectionEnabledLocation, gammaCorrectionEnabled);
-        glUniform1i(sepiaEnabledLocation, sepiaEnabled);
-        glUniform1i(hueShiftEnabledLocation, hueShiftEnabled);
-
-        glBindVertexArray(vao);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
         // Rendu ImGui
+        int imguiScope = beginProfilerScope(profiler, "ImGui");
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
         // Créer une fenêtre ImGui pour contrôler le FOV, la position de l'objet et les post-traitements
         ImGui::Begin("Contrôles de la scène");
-        ImGui::SliderFloat("FOV", &fov, 30.0f, 120.0f);
-        ImGui::SliderFloat3("Position de l'objet", glm::value_ptr(objectPosition), -1.5f, 1.5f);
-        ImGui::SliderFloat("Rotation de l'objet autour de X", &objectRotationX, 0.0f, 360.0f); // Ajouter un slider pour la rotation de l'objet autour de X
-        ImGui::SliderFloat("Rotation de l'objet autour de Y", &objectRotationY, 0.0f, 360.0f); // Ajouter un slider pour la rotation de l'objet autour de Y
-        ImGui::SliderFloat("Rotation de l'objet autour de Z", &objectRotationZ, 0.0f, 360.0f); // Ajouter un slider pour la rotation de l'objet autour de Z
-        ImGui::Checkbox("Vignettage", &vignetteEnabled);
-        ImGui::Checkbox("Correction Gamma", &gammaCorrectionEnabled);
-        ImGui::Checkbox("Sepia", &sepiaEnabled);
-        ImGui::Checkbox("Changement de Teinte", &hueShiftEnabled);
+        ImGui::SliderFloat("FOV", &sceneParams.fov, 30.0f, 120.0f);
+        ImGui::SliderFloat3("Position de l'objet", glm::value_ptr(sceneParams.objectPosition), -1.5f, 1.5f);
+        ImGui::SliderFloat("Rotation de l'objet autour de X", &sceneParams.objectRotationX, 0.0f, 360.0f); // Ajouter un slider pour la rotation de l'objet autour de X
+        ImGui::SliderFloat("Rotation de l'objet autour de Y", &sceneParams.objectRotationY, 0.0f, 360.0f); // Ajouter un slider pour la rotation de l'objet autour de Y
+        ImGui::SliderFloat("Rotation de l'objet autour de Z", &sceneParams.objectRotationZ, 0.0f, 360.0f); // Ajouter un slider pour la rotation de l'objet autour de Z
+        if (selectedPick.hit) {
+            ImGui::Text("Sélection : %s (matériau %d), point (%.2f, %.2f, %.2f)%s", selectedObjectName.c_str(),
+                        selectedPick.materialId, selectedPick.point.x, selectedPick.point.y, selectedPick.point.z,
+                        objectDrag.active ? ", déplacement" : "");
+        } else {
+            ImGui::Text("Sélection : aucune (clic gauche sur un objet, glisser pour déplacer la boîte en marbre)");
+        }
+        ImGui::Text("Sélection CPU : %d pas en %.1f µs", selectedPick.steps, pickMicroseconds);
+        ImGui::Checkbox("Vignettage", &sceneParams.vignetteEnabled);
+        ImGui::Checkbox("Correction Gamma", &sceneParams.gammaCorrectionEnabled);
+        ImGui::Checkbox("Sepia", &sceneParams.sepiaEnabled);
+        ImGui::Checkbox("Changement de Teinte", &sceneParams.hueShiftEnabled);
+        if (renderer.colorGrading.texture != 0) {
+            ImGui::Text("LUT d'étalonnage %d^3 calculée en %.2f ms", kColorLutSize, renderer.colorGrading.bakeMilliseconds);
+        }
+        // Chaque combinaison de post-traitements et de qualité est une variante compilée à sa première utilisation
+        if (ImGui::BeginCombo("Qualité", kShaderQualityTiers[sceneParams.qualityTier].name)) {
+            for (int tier = 0; tier < kShaderQualityTierCount; ++tier) {
+                if (ImGui::Selectable(kShaderQualityTiers[tier].name, tier == sceneParams.qualityTier)) {
+                    sceneParams.qualityTier = tier;
+                }
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::Text("Variantes du shader compilées : %d", (int)renderer.programs.size());
+        if (renderer.compiler && shaderCompilerBusy(*renderer.compiler)) {
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.3f, 1.0f), "(compilation en cours)");
+        }
+        ImGui::Checkbox("Rechargement à chaud des shaders", &renderer.hotReloadEnabled);
+        if (!renderer.buildLog.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Échec de la compilation, programme précédent conservé :");
+            ImGui::TextWrapped("%s", renderer.buildLog.c_str());
+        }
+        ImGui::Text("Cache des programmes : %d relus (%.1f ms), %d compilés (%.1f ms), %d refusés",
+                    renderer.programCacheStats.hits, renderer.programCacheStats.loadMilliseconds,
+                    renderer.programCacheStats.misses, renderer.programCacheStats.compileMilliseconds,
+                    renderer.programCacheStats.rejected);
+        ImGui::Checkbox("Ombres douces", &sceneParams.softShadowsEnabled);
+        if (sceneParams.softShadowsEnabled) {
+            ImGui::SliderFloat("Netteté de la pénombre", &sceneParams.shadowSoftness, 2.0f, 64.0f);
+        }
+        ImGui::Checkbox("Ombres pour tous les modèles d'éclairage", &sceneParams.shadowsAllModels);
+        ImGui::Separator();
+        ImGui::Checkbox("Rendu à la demande en pause", &onDemandRendering);
+        ImGui::Text("Images rendues : %lld (%.1f/s)", renderedFrames, renderedFramesPerSecond);
+        ImGui::Text("Soumission CPU : %.3f ms (anneau d'uniformes %s)", renderer.submitTimings.lastMs,
+                    renderer.uniformRing.mapped ? "persistant" : "glBufferSubData");
+        ImGui::Checkbox("Volumes englobants", &sceneParams.boundsEnabled);
+        ImGui::Checkbox("Sphere tracing sur-relaxé", &sceneParams.overRelaxationEnabled);
+        if (sceneParams.overRelaxationEnabled) {
+            ImGui::SliderFloat("Facteur de relaxation", &sceneParams.marchRelaxation, 1.0f, 1.95f);
+        }
+        ImGui::Checkbox("Intersections analytiques (sol, sphères)", &sceneParams.analyticIntersectionsEnabled);
+        ImGui::Checkbox("Résolution dynamique", &dynamicResolution.enabled);
+        if (dynamicResolution.enabled) {
+            ImGui::SliderFloat("Budget (ms)", &dynamicResolution.budgetMs, 4.0f, 50.0f);
+            ImGui::Text("Échelle %.2f (%dx%d), GPU %.1f ms", dynamicResolution.scale, dynamicResolution.renderWidth,
+                        dynamicResolution.renderHeight, dynamicResolution.gpuMs);
+        }
+        ImGui::Checkbox("Pré-passe de cônes", &sceneParams.conePrepassEnabled);
+        if (sceneParams.conePrepassEnabled) {
+            ImGui::SameLine();
+            ImGui::RadioButton("1/4", &sceneParams.coneTileSize, 4);
+            ImGui::SameLine();
+            ImGui::RadioButton("1/8", &sceneParams.coneTileSize, 8);
+        }
+        ImGui::Checkbox("Rendu différé (G-buffer)", &sceneParams.deferredEnabled);
+        if (sceneParams.deferredEnabled && renderer.passTimings.samples > 0) {
+            const DeferredPassTimings& passes = renderer.passTimings;
+            ImGui::Text("GPU : cônes %.2f, marche %.2f, éclairage %.2f, post %.2f ms", passes.prepassMs,
+                        passes.marchMs, passes.shadingMs, passes.postMs);
+        }
+        ImGui::Checkbox("Rendu en damier", &sceneParams.checkerboardEnabled);
+        if (sceneParams.checkerboardEnabled) {
+            if (renderer.passTimings.samples > 0) {
+                const DeferredPassTimings& passes = renderer.passTimings;
+                ImGui::Text("GPU : cônes %.2f, demi-marche %.2f, reconstruction %.2f, post %.2f ms", passes.prepassMs,
+                            passes.marchMs, passes.shadingMs, passes.postMs);
+            }
+            // La comparaison relit le framebuffer : sans résolution dynamique, il contient l'image en damier seule
+            if (!dynamicResolution.enabled && ImGui::Button("Comparer à l'image complète")) {
+                checkerboardCompareRequested = true;
+            }
+            if (checkerboardComparison.valid) {
+                ImGui::Text("Image complète %.2f ms, damier %.2f ms (x%.2f), PSNR %.1f dB",
+                            checkerboardComparison.referenceMs, checkerboardComparison.renderedMs,
+                            checkerboardComparison.referenceMs / std::max(checkerboardComparison.renderedMs, 1e-3),
+                            checkerboardComparison.psnr);
+            }
+        }
+        const char* antialiasingModes[] = { "Aucun", "Pixels de bord", "4x SSAA" };
+        ImGui::Combo("Anticrénelage", &sceneParams.antialiasing, antialiasingModes, IM_ARRAYSIZE(antialiasingModes));
+        if (sceneParams.antialiasing != 0 && !sceneParams.checkerboardEnabled) {
+            if (sceneParams.antialiasing == 1) {
+                ImGui::SliderFloat("Seuil de distance des bords", &sceneParams.edgeThreshold, 0.005f, 0.5f, "%.3f",
+                                   ImGuiSliderFlags_Logarithmic);
+            }
+            if (renderer.passTimings.samples > 0) {
+                const DeferredPassTimings& passes = renderer.passTimings;
+                ImGui::Text("GPU : repérage %.2f ms, rayons %.2f ms pour %d pixels (%.1f %%)", passes.edgeDetectMs,
+                            passes.supersampleMs, renderer.edgePixelCount,
+                            100.0 * renderer.edgePixelCount / std::max(framebufferWidth * framebufferHeight, 1));
+            }
+            if (sceneParams.antialiasing == 1 && !dynamicResolution.enabled && ImGui::Button("Comparer au 4x SSAA")) {
+                antialiasingCompareRequested = true;
+            }
+            if (antialiasingComparison.valid) {
+                ImGui::Text("4x SSAA %.2f ms, bords %.2f ms (x%.2f), PSNR %.1f dB (%.1f dB sans anticrénelage)",
+                            antialiasingComparison.referenceMs, antialiasingComparison.renderedMs,
+                            antialiasingComparison.referenceMs / std::max(antialiasingComparison.renderedMs, 1e-3),
+                            antialiasingComparison.psnr, antialiasingComparison.aliasedPsnr);
+            }
+        }
+        ImGui::Checkbox("Champ statique précalculé", &sceneParams.staticFieldEnabled);
+        if (sceneParams.staticFieldEnabled) {
+            ImGui::SliderInt("Résolution du champ", &renderer.staticFieldResolution, 16, 256);
+            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                updateStaticField(renderer.staticField, renderer.sceneGraph, renderer.staticFieldResolution,
+                                  renderer.staticFieldCacheDirectory);
+            }
+            if (renderer.staticField.texture != 0) {
+                ImGui::Text("Champ %d^3 %s en %.1f ms", renderer.staticField.resolution,
+                            renderer.staticField.fromCache ? "lu dans le cache" : "précalculé", renderer.staticField.bakeMilliseconds);
+            } else {
+                ImGui::Text("Aucun objet statique à précalculer");
+            }
+        }
+        ImGui::Checkbox("Compteur d'évaluations SDF", &sdfCounterEnabled);
+        if (sdfCounterEnabled) {
+            ImGui::Text("SDF par pixel : moyenne %.1f, max %d", sdfStats.meanEvaluations, sdfStats.maxEvaluations);
+            ImGui::Text("Pas du rayon primaire : %.1f (+ %.2f pas de cônes), max %d", sdfStats.meanPrimarySteps,
+                        sdfStats.meanPrepassSteps, sdfStats.maxPrimarySteps);
+            ImGui::Text("Pas des rayons d'ombre : %.1f, max %d", sdfStats.meanShadowSteps, sdfStats.maxShadowSteps);
+            ImGui::Text("Pas de l'image : %lld", sdfStats.totalPrimarySteps + sdfStats.totalShadowSteps);
+            ImGui::Text("Rayons à court de pas : %lld primaires, %lld d'ombre", sdfStats.exhaustedPrimaryRays,
+                        sdfStats.exhaustedShadowRays);
+        }
+        const char* heatmapModes[] = { "Désactivée", "Pas primaires", "Pas d'ombre", "Total" };
+        ImGui::Combo("Carte de coût de la marche", &sceneParams.stepHeatmap, heatmapModes, IM_ARRAYSIZE(heatmapModes));
+        if (ImGui::CollapsingHeader("Graphe de scène")) {
+            if (drawSceneGraphEditor(renderer.sceneGraph, (int)renderer.materials.size())) {
+                rebuildSceneProgram(renderer);
+            }
+            ImGui::Text("Objets animés (uniformes) : %d", (int)renderer.generatedScene.animatedObjects.size());
+        }
+        if (ImGui::CollapsingHeader("Matériaux")) {
+            renderer.materialsDirty |= drawMaterialEditor(renderer.materials);
+        }
+        if (ImGui::CollapsingHeader("Profileur")) {
+            drawProfilerPanel(profiler, "main_scene_profile.csv");
+            if (!inputRecorder.active && ImGui::Button("Enregistrer les entrées")) {
+                startInputRecording(inputRecorder);
+            } else if (inputRecorder.active && ImGui::Button("Arrêter l'enregistrement")) {
+                inputRecorder.active = false;
+                const InputRecording& recording = inputRecorder.recording;
+                inputRecordingStatus = saveInputRecording(recording, kInputRecordingPath)
+                    ? std::to_string(recording.samples.size()) + " échantillons (" +
+                      std::to_string((int)inputRecordingDuration(recording)) + " s) écrits dans " + kInputRecordingPath
+                    : std::string("Échec de l'écriture de ") + kInputRecordingPath;
+            }
+            if (inputRecorder.active) {
+                ImGui::SameLine();
+                ImGui::Text("%d échantillons", (int)inputRecorder.recording.samples.size());
+            } else if (!inputRecordingStatus.empty()) {
+                ImGui::TextUnformatted(inputRecordingStatus.c_str());
+            }
+        }
         ImGui::End();
 
         // Rendu ImGui
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        endProfilerScope(profiler, imguiScope);
+        endProfilerFrame(profiler);
 
         glfwSwapBuffers(window);
+
+        ++renderedFrames;
+        ++rateWindowFrames;
+        double now = glfwGetTime();
+        if (now - rateWindowStart >= 1.0) {
+            renderedFramesPerSecond = rateWindowFrames / (now - rateWindowStart);
+            rateWindowStart = now;
+            rateWindowFrames = 0;
+        }
+
         glfwPollEvents();
     }
 
-    glDeleteVertexArrays(1, &vao);
-    glDeleteBuffers(1, &vbo);
-    glDeleteBuffers(1, &ebo);
-    glDeleteTextures(1, &texture);
+    // Le thread de compilation libère son contexte avant que les programmes ne soient supprimés
+    stopShaderCompiler(compiler);
+    destroyGpuProfiler(profiler);
+    destroyDynamicResolution(dynamicResolution);
+    destroySceneRenderer(renderer);
+    if (compileWindow) {
+        glfwDestroyWindow(compileWindow);
+    }
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -0,0 +1,49 @@
+#include "materials.h"
+#include <algorithm>
+
+const char* lightingModelName(LightingModel model) {
+    switch (model) {
+    case LightingModel::Basic: return "Basique";
+    case LightingModel::Toon: return "Toon";
+    case LightingModel::Phong: return "Phong";
+    case LightingModel::BlinnPhong: return "Blinn-Phong";
+    case LightingModel::Textured: return "Texturé";
+    case LightingModel::Marble: return "Marbre";
+    }
+    return "";
+}
+
+static Material makeMaterial(const char* name, glm::vec3 color, LightingModel model, int textureSlot = -1) {
+    Material material;
+    material.name = name;
+    material.albedo = color * 0.2f; // material() atténuait toutes les couleurs d'un facteur 0.2
+    material.model = model;
+    material.textureSlot = textureSlot;
+    return material;
+}
+
+std::vector<Material> makeDefaultMaterials() {
+    return {
+        makeMaterial("Plan", glm::vec3(1.0f, 2.0f, 2.0f), LightingModel::Basic),
+        makeMaterial("Toon", glm::vec3(1.0f, 0.2f, 0.3f), LightingModel::Toon),
+        makeMaterial("Pierre", glm::vec3(0.3f, 0.2f, 5.0f), LightingModel::Textured, 0),
+        makeMaterial("Violet", glm::vec3(0.5f, 0.2f, 3.0f), LightingModel::Basic),
+        makeMaterial("Cyan (Phong)", glm::vec3(0.3f, 5.0f, 5.0f), LightingModel::Phong),
+        makeMaterial("Gris (Blinn-Phong)", glm::vec3(0.7f, 0.7f, 0.7f), LightingModel::BlinnPhong),
+        makeMaterial("Marbre", glm::vec3(0.9f, 0.9f, 0.9f), LightingModel::Marble),
+    };
+}
+
+void uploadMaterials(GLuint ubo, const std::vector<Material>& materials) {
+    // struct MaterialData { vec4 albedo; vec4 params; } : deux vec4 par entrée en std140
+    std::vector<glm::vec4> data((size_t)kMaxMaterials * 2, glm::vec4(0.0f));
+    size_t count = std::min(materials.size(), (size_t)kMaxMaterials);
+    for (size_t i = 0; i < count; ++i) {
+        const Material& material = materials[i];
+        data[i * 2] = glm::vec4(material.albedo, 0.0f);
+        data[i * 2 + 1] = glm::vec4((float)material.model, (float)material.textureSlot, material.shininess, 0.0f);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+    glBufferData(GL_UNIFORM_BUFFER, data.size() * sizeof(glm::vec4), data.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,42 @@
+#ifndef MATERIALS_H
+#define MATERIALS_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// Nombre maximal de matériaux du bloc uniforme Materials (MAX_MATERIALS dans le fragment shader)
+const int kMaxMaterials = 64;
+// Point de liaison du bloc uniforme Materials
+const GLuint kMaterialsBinding = 0;
+
+// Modèle d'éclairage d'un matériau, même numérotation que les constantes LIGHTING_* du fragment shader
+enum class LightingModel : int {
+    Basic = 0,      // basicLighting : ambiante violette, ciel et lumière ombrée
+    Toon = 1,
+    Phong = 2,
+    BlinnPhong = 3,
+    Textured = 4,   // Phong appliqué à la texture de textureSlot
+    Marble = 5      // Bruit procédural, sans éclairage
+};
+const int kLightingModelCount = 6;
+
+// Entrée de la table des matériaux, indexée par l'identifiant renvoyé par scene()
+struct Material {
+    std::string name;
+    glm::vec3 albedo = glm::vec3(0.2f);
+    LightingModel model = LightingModel::Basic;
+    int textureSlot = -1; // Texture lue par le modèle Textured ; seul l'emplacement 0 (texture1) existe
+    float shininess = 32.0f;
+};
+
+const char* lightingModelName(LightingModel model);
+
+// Table qui reproduit l'ancienne fonction material() et les branches de mainImage()
+std::vector<Material> makeDefaultMaterials();
+
+// Envoie la table dans ubo au format std140 du bloc Materials (au plus kMaxMaterials entrées)
+void uploadMaterials(GLuint ubo, const std::vector<Material>& materials);
+
+#endif
@@ -0,0 +1,170 @@
+#include "program_cache.h"
+#include "fnv1a.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// À incrémenter quand le format du fichier change
+static const uint32_t kProgramCacheFormatVersion = 1;
+static const char kProgramCacheMagic[4] = {'P', 'R', 'G', 'B'};
+
+static std::string programCachePath(const std::string& cacheDirectory, uint64_t key) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "program_%016llx.bin", (unsigned long long)key);
+    return (fs::path(cacheDirectory) / name).string();
+}
+
+static std::string glString(GLenum name) {
+    const GLubyte* value = glGetString(name);
+    return value ? reinterpret_cast<const char*>(value) : "";
+}
+
+bool programBinarySupported() {
+    if (!GLEW_ARB_get_program_binary) {
+        return false;
+    }
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+uint64_t programCacheKey(const std::string& vertexSource, const std::string& fragmentSource, const std::string& permutation) {
+    Fnv1a hash;
+    hash.add(kProgramCacheFormatVersion);
+    hash.addString(vertexSource);
+    hash.addString(fragmentSource);
+    hash.addString(permutation);
+    hash.addString(glString(GL_VENDOR));
+    hash.addString(glString(GL_RENDERER));
+    hash.addString(glString(GL_VERSION));
+    return hash.value;
+}
+
+GLuint loadCachedProgram(const std::string& cacheDirectory, uint64_t key, bool* rejected) {
+    if (rejected) {
+        *rejected = false;
+    }
+    std::string path = programCachePath(cacheDirectory, key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return 0;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t fileKey = 0;
+    uint32_t format = 0;
+    uint32_t length = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&fileKey), sizeof(fileKey));
+    file.read(reinterpret_cast<char*>(&format), sizeof(format));
+    file.read(reinterpret_cast<char*>(&length), sizeof(length));
+    bool valid = file && std::memcmp(magic, kProgramCacheMagic, sizeof(magic)) == 0
+        && version == kProgramCacheFormatVersion && fileKey == key && length > 0;
+
+    // La longueur n'est crue qu'une fois l'en-tête validé, et bornée par ce qui reste du fichier :
+    // un fichier tronqué ou étranger est rejeté sans allouer
+    std::vector<char> binary;
+    if (valid) {
+        std::streamoff dataStart = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::streamoff remaining = file.tellg() - dataStart;
+        file.seekg(dataStart);
+        valid = file && remaining >= 0 && (std::streamoff)length <= remaining;
+    }
+    if (valid) {
+        binary.resize(length);
+        file.read(binary.data(), binary.size());
+        valid = (bool)file;
+    }
+    file.close();
+
+    GLuint program = 0;
+    GLint linked = GL_FALSE;
+    if (valid) {
+        program = glCreateProgram();
+        glProgramBinary(program, format, binary.data(), (GLsizei)binary.size());
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    }
+    if (linked == GL_FALSE) {
+        // Le pilote a changé ou le fichier est abîmé : il sera remplacé par la recompilation
+        glDeleteProgram(program);
+        std::error_code ec;
+        fs::remove(path, ec);
+        if (rejected) {
+            *rejected = true;
+        }
+        return 0;
+    }
+    return program;
+}
+
+bool saveCachedProgram(const std::string& cacheDirectory, uint64_t key, GLuint program) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return false;
+    }
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    if (length <= 0) {
+        return false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(cacheDirectory, ec);
+    std::ofstream file(programCachePath(cacheDirectory, key), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    uint32_t fileFormat = format;
+    uint32_t fileLength = (uint32_t)length;
+    file.write(kProgramCacheMagic, sizeof(kProgramCacheMagic));
+    file.write(reinterpret_cast<const char*>(&kProgramCacheFormatVersion), sizeof(kProgramCacheFormatVersion));
+    file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+    file.write(reinterpret_cast<const char*>(&fileFormat), sizeof(fileFormat));
+    file.write(reinterpret_cast<const char*>(&fileLength), sizeof(fileLength));
+    file.write(binary.data(), fileLength);
+    return (bool)file;
+}
+
+GLuint createCachedProgram(const std::string& cacheDirectory, uint64_t key, const std::function<GLuint()>& compile,
+                           ProgramCacheStats* stats) {
+    using clock = std::chrono::steady_clock;
+    bool useCache = !cacheDirectory.empty() && programBinarySupported();
+
+    if (useCache) {
+        clock::time_point start = clock::now();
+        bool rejected = false;
+        GLuint program = loadCachedProgram(cacheDirectory, key, &rejected);
+        if (stats) {
+            stats->rejected += rejected ? 1 : 0;
+        }
+        if (program != 0) {
+            if (stats) {
+                ++stats->hits;
+                stats->loadMilliseconds += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+            }
+            return program;
+        }
+    }
+
+    clock::time_point start = clock::now();
+    GLuint program = compile();
+    if (program != 0 && stats) {
+        ++stats->misses;
+        stats->compileMilliseconds += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    }
+    if (program != 0 && useCache && !saveCachedProgram(cacheDirectory, key, program)) {
+        std::cerr << "Failed to write program binary to " << cacheDirectory << std::endl;
+    }
+    return program;
+}
@@ -0,0 +1,37 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Compteurs du cache des programmes compilés, pour comparer un démarrage à froid et à chaud
+struct ProgramCacheStats {
+    int hits = 0;      // Programmes relus avec glProgramBinary
+    int misses = 0;    // Programmes compilés depuis les sources
+    int rejected = 0;  // Binaires refusés par le pilote (mise à jour du pilote, format différent), recompilés
+    double loadMilliseconds = 0.0;
+    double compileMilliseconds = 0.0;
+};
+
+// Vrai si le pilote sait relire et exporter des binaires de programme (ARB_get_program_binary)
+bool programBinarySupported();
+
+// Clé d'un programme : sources, permutation (defines et clé de la variante) et pilote (GL_VENDOR,
+// GL_RENDERER, GL_VERSION). Un contexte OpenGL doit être courant.
+uint64_t programCacheKey(const std::string& vertexSource, const std::string& fragmentSource, const std::string& permutation);
+
+// Crée le programme depuis le binaire de clé key dans cacheDirectory. Renvoie 0 si le fichier est absent ou
+// si le pilote le refuse ; un binaire refusé est supprimé et *rejected est levé.
+GLuint loadCachedProgram(const std::string& cacheDirectory, uint64_t key, bool* rejected = nullptr);
+
+// Enregistre le binaire d'un programme lié sous la clé key
+bool saveCachedProgram(const std::string& cacheDirectory, uint64_t key, GLuint program);
+
+// Relit le programme de clé key, ou l'obtient de compile() puis l'enregistre. compile() renvoie 0 en cas
+// d'échec. Sans cacheDirectory ni support des binaires, compile() est simplement appelée.
+GLuint createCachedProgram(const std::string& cacheDirectory, uint64_t key, const std::function<GLuint()>& compile,
+                           ProgramCacheStats* stats = nullptr);
+
+#endif
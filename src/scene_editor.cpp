@@ -0,0 +1,184 @@
+#include "scene_editor.h"
+#include "../include/imgui.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <string>
+
+static const char* primitiveName(SdfPrimitive primitive) {
+    switch (primitive) {
+    case SdfPrimitive::Plane: return "Plan";
+    case SdfPrimitive::Sphere: return "Sphère";
+    case SdfPrimitive::Box: return "Boîte";
+    case SdfPrimitive::Torus: return "Tore";
+    case SdfPrimitive::Cylinder: return "Cylindre";
+    }
+    return "";
+}
+
+static const char* transformName(SdfTransform::Type type) {
+    switch (type) {
+    case SdfTransform::Type::Translate: return "Translation";
+    case SdfTransform::Type::RotateX: return "Rotation X";
+    case SdfTransform::Type::RotateY: return "Rotation Y";
+    case SdfTransform::Type::RotateZ: return "Rotation Z";
+    }
+    return "";
+}
+
+// Les valeurs statiques sont repliées en constantes dans le shader : on ne régénère qu'à la fin
+// d'un glissement, pas à chaque image.
+static void drawTransforms(SdfNode& node, bool& changed) {
+    int removed = -1;
+    for (size_t i = 0; i < node.transforms.size(); ++i) {
+        SdfTransform& transform = node.transforms[i];
+        ImGui::PushID((int)i);
+        if (transform.isAnimated()) {
+            ImGui::BulletText("%s : %s (animé)", transformName(transform.type), transform.animationLabel.c_str());
+        } else {
+            if (transform.type == SdfTransform::Type::Translate) {
+                ImGui::DragFloat3("Translation", glm::value_ptr(transform.translation), 0.01f);
+            } else {
+                ImGui::SliderAngle(transformName(transform.type), &transform.angle, -180.0f, 180.0f);
+            }
+            changed |= ImGui::IsItemDeactivatedAfterEdit();
+            ImGui::SameLine();
+            if (ImGui::SmallButton("x")) {
+                removed = (int)i;
+            }
+        }
+        ImGui::PopID();
+    }
+    if (removed >= 0) {
+        node.transforms.erase(node.transforms.begin() + removed);
+        changed = true;
+    }
+
+    if (ImGui::SmallButton("+ Translation")) {
+        node.transforms.push_back(sdfTranslate(glm::vec3(0.0f)));
+        changed = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::SmallButton("+ Rotation X")) {
+        node.transforms.push_back(sdfRotate(SdfTransform::Type::RotateX, 0.0f));
+        changed = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::SmallButton("+ Rotation Y")) {
+        node.transforms.push_back(sdfRotate(SdfTransform::Type::RotateY, 0.0f));
+        changed = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::SmallButton("+ Rotation Z")) {
+        node.transforms.push_back(sdfRotate(SdfTransform::Type::RotateZ, 0.0f));
+        changed = true;
+    }
+}
+
+static void addChild(SdfNode& group, SdfNode child, bool& changed) {
+    child.transforms.push_back(sdfTranslate(glm::vec3(0.0f, 0.5f, 0.0f)));
+    group.children.push_back(child);
+    changed = true;
+}
+
+// Renvoie vrai si le nœud doit être supprimé par son parent
+static bool drawNode(SdfNode& node, bool isRoot, int materialCount, bool& changed) {
+    bool remove = false;
+    const char* kind = node.isGroup ? "Union" : primitiveName(node.primitive);
+    if (!ImGui::TreeNode("node", "%s (%s)", node.name.c_str(), kind)) {
+        return false;
+    }
+
+    drawTransforms(node, changed);
+
+    if (node.isGroup) {
+        int removed = -1;
+        for (size_t i = 0; i < node.children.size(); ++i) {
+            ImGui::PushID((int)i);
+            if (drawNode(node.children[i], false, materialCount, changed)) {
+                removed = (int)i;
+            }
+            ImGui::PopID();
+        }
+        if (removed >= 0) {
+            node.children.erase(node.children.begin() + removed);
+            changed = true;
+        }
+
+        if (ImGui::SmallButton("+ Sphère")) {
+            addChild(node, sdfPrimitive("Sphère", SdfPrimitive::Sphere, glm::vec3(0.2f), 1), changed);
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("+ Boîte")) {
+            addChild(node, sdfPrimitive("Boîte", SdfPrimitive::Box, glm::vec3(0.2f), 3), changed);
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("+ Tore")) {
+            addChild(node, sdfPrimitive("Tore", SdfPrimitive::Torus, glm::vec3(0.3f, 0.05f, 0.0f), 4), changed);
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("+ Cylindre")) {
+            addChild(node, sdfPrimitive("Cylindre", SdfPrimitive::Cylinder, glm::vec3(0.1f, 0.3f, 0.0f), 5), changed);
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("+ Union")) {
+            addChild(node, sdfGroup("Union"), changed);
+        }
+    } else if (node.primitive != SdfPrimitive::Plane) {
+        ImGui::DragFloat3("Taille", glm::value_ptr(node.size), 0.01f, 0.0f, 10.0f);
+        changed |= ImGui::IsItemDeactivatedAfterEdit();
+        ImGui::DragFloat("Arrondi", &node.rounding, 0.005f, 0.0f, 1.0f);
+        changed |= ImGui::IsItemDeactivatedAfterEdit();
+    }
+
+    if (!node.isGroup && ImGui::SliderInt("Matériau", &node.materialId, 0, std::max(0, materialCount - 1))) {
+        changed = true;
+    }
+
+    if (!isRoot && ImGui::Button("Supprimer")) {
+        remove = true;
+    }
+
+    ImGui::TreePop();
+    return remove;
+}
+
+bool drawSceneGraphEditor(SdfScene& scene, int materialCount) {
+    bool changed = false;
+    ImGui::PushID("sceneGraph");
+    drawNode(scene.root, true, materialCount, changed);
+    ImGui::PopID();
+    return changed;
+}
+
+bool drawMaterialEditor(std::vector<Material>& materials) {
+    bool changed = false;
+    ImGui::PushID("materials");
+    for (size_t i = 0; i < materials.size(); ++i) {
+        Material& material = materials[i];
+        ImGui::PushID((int)i);
+        if (ImGui::TreeNode("material", "%d : %s (%s)", (int)i, material.name.c_str(), lightingModelName(material.model))) {
+            changed |= ImGui::ColorEdit3("Couleur", glm::value_ptr(material.albedo), ImGuiColorEditFlags_Float | ImGuiColorEditFlags_HDR);
+            if (ImGui::BeginCombo("Éclairage", lightingModelName(material.model))) {
+                for (int model = 0; model < kLightingModelCount; ++model) {
+                    if (ImGui::Selectable(lightingModelName((LightingModel)model), model == (int)material.model)) {
+                        material.model = (LightingModel)model;
+                        changed = true;
+                    }
+                }
+                ImGui::EndCombo();
+            }
+            changed |= ImGui::SliderInt("Texture", &material.textureSlot, -1, 0);
+            changed |= ImGui::SliderFloat("Brillance", &material.shininess, 1.0f, 256.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+            ImGui::TreePop();
+        }
+        ImGui::PopID();
+    }
+    if ((int)materials.size() < kMaxMaterials && ImGui::SmallButton("+ Matériau")) {
+        Material material;
+        material.name = "Matériau " + std::to_string(materials.size());
+        materials.push_back(material);
+        changed = true;
+    }
+    ImGui::PopID();
+    return changed;
+}
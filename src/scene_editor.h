@@ -0,0 +1,16 @@
+#ifndef SCENE_EDITOR_H
+#define SCENE_EDITOR_H
+
+#include <vector>
+#include "sdf_scene.h"
+#include "materials.h"
+
+// Affiche l'arbre du graphe de scène dans la fenêtre ImGui courante. materialCount borne l'identifiant
+// de matériau des primitives. Renvoie vrai quand une modification terminée demande de régénérer le programme.
+bool drawSceneGraphEditor(SdfScene& scene, int materialCount);
+
+// Affiche la table des matériaux. Renvoie vrai si une entrée a changé et doit être renvoyée au GPU ;
+// la table se modifie sans recompiler le shader.
+bool drawMaterialEditor(std::vector<Material>& materials);
+
+#endif
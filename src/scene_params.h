@@ -0,0 +1,69 @@
+#ifndef SCENE_PARAMS_H
+#define SCENE_PARAMS_H
+
+#include <glm/glm.hpp>
+
+// Paramètres de la scène, partagés par le rendu interactif et le rendu hors écran
+struct SceneParams {
+    float time = 0.0f;
+    float mouseX = 0.0f; // Coordonnées de la souris avec origine en bas à gauche
+    float mouseY = 0.0f;
+
+    float fov = 55.0f; // FOV en degrés
+    glm::vec3 objectPosition = glm::vec3(0.0f, 0.5f, -1.0f);
+    float objectRotationX = 0.0f; // Rotations de l'objet en degrés
+    float objectRotationY = 0.0f;
+    float objectRotationZ = 0.0f;
+
+    // Post-traitements, compilés dans la variante du shader (shader_variants.h)
+    bool vignetteEnabled = true;
+    bool gammaCorrectionEnabled = true;
+    bool sepiaEnabled = false;
+    bool hueShiftEnabled = false;
+
+    // Niveau de qualité de la variante : 0 = rapide, 1 = normale, 2 = fine (nombre de pas de marche)
+    int qualityTier = 1;
+
+    // Volumes englobants dans scene() et découpage des rayons primaires
+    bool boundsEnabled = true;
+
+    // Rayons d'ombre : pénombre douce et ombres portées pour tous les modèles d'éclairage
+    bool softShadowsEnabled = true;
+    float shadowSoftness = 16.0f;
+    bool shadowsAllModels = true;
+
+    // Distances des objets statiques lues dans la texture 3D précalculée loin des surfaces
+    bool staticFieldEnabled = true;
+
+    // Sphere tracing sur-relaxé des rayons primaires : pas allongés de marchRelaxation, retour au pas exact
+    // quand deux sphères successives ne se recouvrent plus
+    bool overRelaxationEnabled = false;
+    float marchRelaxation = 1.25f;
+
+    // Rendu hybride : le sol et les sphères sont intersectés analytiquement par les rayons primaires et d'ombre,
+    // seuls les autres objets sont marchés, jusqu'au plus proche point d'intersection analytique
+    bool analyticIntersectionsEnabled = false;
+
+    // Pré-passe de cônes à 1/coneTileSize de la résolution, qui fixe la distance de départ des rayons primaires
+    bool conePrepassEnabled = false;
+    int coneTileSize = 4;
+
+    // Rendu différé : marche vers un G-buffer, puis éclairage et post-traitements en passes séparées
+    bool deferredEnabled = false;
+
+    // Rendu en damier : la moitié des pixels est marchée à chaque image, en alternance, et les autres sont
+    // reprojetés depuis l'image précédente. Prioritaire sur deferredEnabled.
+    bool checkerboardEnabled = false;
+
+    // Anticrénelage, rendu en passes différées : 0 = aucun, 1 = quatre rayons en grille tournée pour les seuls
+    // pixels de bord (matériau ou distance différents d'un voisin), 2 = pour tous les pixels (4x SSAA, référence).
+    // Sans effet en damier.
+    int antialiasing = 0;
+    float edgeThreshold = 0.05f; // Écart relatif de 1/distance qui fait un bord
+
+    // Carte de coût de la marche (débogage) : 0 = image normale, 1 = pas primaires, 2 = pas d'ombre, 3 = total.
+    // Toujours rendue en une passe, même avec deferredEnabled.
+    int stepHeatmap = 0;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "scene_picking.h"
+#include <cmath>
+
+// Mêmes constantes que march() dans le shader
+static const float kPickMaxDistance = 20.0f;
+static const int kPickSteps = 100;
+static const float kPickHitDistance = 0.001f;
+
+void pickingRay(const SceneParams& params, int width, int height, const glm::vec2& fragCoord, glm::vec3& r0,
+                glm::vec3& rD) {
+    glm::vec2 resolution((float)width, (float)height);
+    glm::vec2 mouse = glm::vec2(params.mouseX, params.mouseY) / resolution;
+    float initA = -glm::radians(90.0f);
+    const float pi = 3.141592f;
+
+    r0 = glm::vec3(std::cos(mouse.x * 2.0f * pi + initA) * 2.0f, mouse.y + 0.5f,
+                   std::sin(mouse.x * 2.0f * pi + initA) * 2.0f);
+    glm::vec3 fwd = glm::normalize(glm::vec3(0.0f, 0.5f, 0.0f) - r0);
+    glm::vec3 side = glm::normalize(glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), fwd));
+    glm::vec3 up = glm::cross(fwd, side);
+
+    glm::vec2 uv = (fragCoord - resolution * 0.5f) / resolution.y;
+    rD = glm::normalize(std::tan(glm::radians(params.fov) * 0.5f) * fwd + side * uv.x + up * uv.y);
+}
+
+ScenePick pickScene(const std::vector<SdfFlatObject>& objects, const SceneParams& params, const glm::vec3& r0,
+                    const glm::vec3& rD) {
+    // Transformations composées une fois par rayon, pas à chaque pas
+    std::vector<SdfAffine> affines;
+    affines.reserve(objects.size());
+    for (const SdfFlatObject& object : objects) {
+        affines.push_back(composeTransforms(object.chain, params));
+    }
+
+    ScenePick pick;
+    float t = 0.0f;
+    for (int i = 0; i < kPickSteps && t <= kPickMaxDistance; ++i) {
+        glm::vec3 p = r0 + rD * t;
+        float nearest = 1e30f;
+        int object = -1;
+        for (size_t k = 0; k < objects.size(); ++k) {
+            float d = evaluatePrimitive(objects[k].leaf, affines[k].linear * p + affines[k].offset).y;
+            if (d < nearest) {
+                nearest = d;
+                object = (int)k;
+            }
+        }
+        ++pick.steps;
+        if (object < 0) {
+            break;
+        }
+        if (nearest < kPickHitDistance) {
+            pick.hit = true;
+            pick.object = object;
+            pick.materialId = objects[object].leaf.materialId;
+            pick.distance = t + nearest;
+            pick.point = r0 + rD * pick.distance;
+            break;
+        }
+        t += nearest;
+    }
+    return pick;
+}
+
+bool followsObjectPosition(const SdfFlatObject& object) {
+    for (const SdfTransform& transform : object.chain) {
+        if (transform.type == SdfTransform::Type::Translate && transform.animationLabel == kObjectPositionLabel) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool beginObjectDrag(ObjectDrag& drag, const std::vector<SdfFlatObject>& objects, const ScenePick& pick,
+                     const glm::vec3& rD, const SceneParams& params) {
+    if (!pick.hit || !followsObjectPosition(objects[pick.object])) {
+        return false;
+    }
+    drag.active = true;
+    drag.planePoint = pick.point;
+    drag.planeNormal = rD;
+    drag.startPosition = params.objectPosition;
+    drag.cameraMouse = glm::vec2(params.mouseX, params.mouseY);
+    return true;
+}
+
+void updateObjectDrag(const ObjectDrag& drag, const glm::vec3& r0, const glm::vec3& rD, SceneParams& params) {
+    float speed = glm::dot(rD, drag.planeNormal);
+    if (!drag.active || speed <= 1e-4f) {
+        return;
+    }
+    float t = glm::dot(drag.planePoint - r0, drag.planeNormal) / speed;
+    params.objectPosition = drag.startPosition + (r0 + rD * t - drag.planePoint);
+}
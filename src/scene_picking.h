@@ -0,0 +1,50 @@
+#ifndef SCENE_PICKING_H
+#define SCENE_PICKING_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include "scene_params.h"
+#include "sdf_scene.h"
+
+// Rayon primaire passant par fragCoord (pixels de width x height, origine en bas à gauche), calculé comme
+// orbitCamera() et primaryRay() du shader, iMouse étant exprimée dans la même résolution
+void pickingRay(const SceneParams& params, int width, int height, const glm::vec2& fragCoord, glm::vec3& r0,
+                glm::vec3& rD);
+
+// Objet touché par un rayon de sélection
+struct ScenePick {
+    bool hit = false;
+    int object = -1;     // Indice dans flattenScene()
+    int materialId = -1;
+    glm::vec3 point = glm::vec3(0.0f);
+    float distance = 0.0f;
+    int steps = 0;
+};
+
+// Marche le rayon dans les SDF CPU du graphe aplati, avec les transformations animées évaluées pour params
+// comme les uniformes sdfTransformK de l'image : même scène que celle rendue, sans relecture du GPU.
+// Mêmes distance maximale, nombre de pas et seuil de contact que march().
+ScenePick pickScene(const std::vector<SdfFlatObject>& objects, const SceneParams& params, const glm::vec3& r0,
+                    const glm::vec3& rD);
+
+// Vrai si l'objet est déplacé par SceneParams::objectPosition (la boîte en marbre de la scène par défaut)
+bool followsObjectPosition(const SdfFlatObject& object);
+
+// Déplacement d'un objet à la souris, dans le plan face à la caméra qui passe par le point saisi
+struct ObjectDrag {
+    bool active = false;
+    glm::vec3 planePoint = glm::vec3(0.0f);
+    glm::vec3 planeNormal = glm::vec3(0.0f);
+    glm::vec3 startPosition = glm::vec3(0.0f); // objectPosition au moment de la saisie
+    glm::vec2 cameraMouse = glm::vec2(0.0f);   // iMouse figée pendant le déplacement
+};
+
+// Saisit l'objet touché par pick, le long du rayon de direction rD. Renvoie faux si l'objet ne suit pas
+// objectPosition.
+bool beginObjectDrag(ObjectDrag& drag, const std::vector<SdfFlatObject>& objects, const ScenePick& pick,
+                     const glm::vec3& rD, const SceneParams& params);
+
+// Déplace objectPosition du décalage entre le point saisi et l'intersection du rayon avec le plan de saisie
+void updateObjectDrag(const ObjectDrag& drag, const glm::vec3& r0, const glm::vec3& rD, SceneParams& params);
+
+#endif
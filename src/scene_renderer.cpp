@@ -0,0 +1,1289 @@
+#include "scene_renderer.h"
+#include "shader_utils.h"
+#include "shader_variants.h"
+#include "program_cache.h"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <chrono>
+#include <cmath>
+#include <glm/gtc/type_ptr.hpp>
+
+// Inclure stb_image.h et définir STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "../include/stb_image.h"
+
+bool initSceneRenderer(SceneRenderer& renderer) {
+    renderer.initStart = std::chrono::steady_clock::now();
+
+    // Lire les shaders depuis les fichiers, surveillés ensuite pour le rechargement à chaud
+    renderer.vertexSource = readFile(kSceneVertexShaderPath);
+    renderer.fragmentSource = readFile(kSceneFragmentShaderPath);
+    watchShaderFiles(renderer.shaderWatcher, { kSceneVertexShaderPath, kSceneFragmentShaderPath });
+    renderer.lastShaderWatch = renderer.initStart;
+
+    renderer.sceneGraph = makeDefaultSdfScene();
+    renderer.materials = makeDefaultMaterials();
+    glGenBuffers(1, &renderer.materialUbo);
+    if (!createUniformRing(renderer.uniformRing, kUniformRingSegmentSize)) {
+        std::cerr << "Failed to create uniform ring buffer" << std::endl;
+        return false;
+    }
+    renderer.activeVariant = shaderVariantKey(SceneParams());
+    std::string log;
+    if (!rebuildSceneProgram(renderer, &log)) {
+        std::cerr << "Failed to build the scene program:\n" << log << std::endl;
+        return false;
+    }
+    if (renderer.compiler) {
+        std::cout << "Scene shaders compiling in the background" << std::endl;
+    }
+
+    float vertices[] = {
+        // positions          // texture coords
+        -1.0f, -1.0f, 0.0f,  0.0f, 0.0f,
+         1.0f, -1.0f, 0.0f,  1.0f, 0.0f,
+         1.0f,  1.0f, 0.0f,  1.0f, 1.0f,
+        -1.0f,  1.0f, 0.0f,  0.0f, 1.0f
+    };
+
+    GLuint indices[] = {
+        0, 1, 2,
+        2, 3, 0
+    };
+
+    glGenVertexArrays(1, &renderer.vao);
+    glGenBuffers(1, &renderer.vbo);
+    glGenBuffers(1, &renderer.ebo);
+
+    glBindVertexArray(renderer.vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, renderer.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer.ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // Position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    // Texture coord attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+
+    // Charger la texture
+    int width, height, nrChannels;
+    unsigned char *data = stbi_load("../src/ressources/texture/pierre.jpg", &width, &height, &nrChannels, 0);
+    if (!data) {
+        std::cerr << "Failed to load texture" << std::endl;
+        return false;
+    }
+
+    glGenTextures(1, &renderer.texture);
+    glBindTexture(GL_TEXTURE_2D, renderer.texture);
+
+    // Définir les paramètres de la texture
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // Charger les données de l'image
+    if (nrChannels == 3) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+    } else if (nrChannels == 4) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    }
+
+    glGenerateMipmap(GL_TEXTURE_2D);
+    stbi_image_free(data);
+    return true;
+}
+
+// Bloc FrameUniforms du fragment shader, disposition std140 : chaque vec3 est suivi d'un scalaire qui
+// occupe son quatrième composant, et les bool sont des entiers de 4 octets
+struct FrameUniforms {
+    glm::vec2 resolution;
+    glm::vec2 mouse;
+    glm::vec3 objectPosition;
+    float time;
+    float fov;
+    float objectRotationX;
+    float objectRotationY;
+    float objectRotationZ;
+
+    glm::vec3 staticFieldMin;
+    float staticFieldResolution;
+    glm::vec3 staticFieldMax;
+    float staticFieldBand;
+    float staticFieldMargin;
+
+    float shadowSoftness;
+    float colorLutRange;
+    float colorLutSize;
+
+    GLint boundsEnabled;
+    GLint softShadowsEnabled;
+    GLint shadowsAllModels;
+    GLint staticFieldEnabled;
+    GLint coneDepthEnabled;
+    GLint coneTileSize;
+    GLint materialCount;
+    float marchRelaxation;
+
+    glm::vec2 previousMouse;
+    glm::vec2 previousResolution;
+    float previousFov;
+    GLint checkerParity;
+    GLint checkerHistoryValid;
+
+    GLint analyticIntersections;
+    GLint edgeAntialiasing;
+    GLint edgePyramidTop;
+    GLint edgeColorTexels;
+    GLint padding;
+};
+static_assert(sizeof(FrameUniforms) == 176, "FrameUniforms must match the std140 layout of the shader block");
+
+// Bloc DrawUniforms : ce qui change d'un tracé plein écran à l'autre dans une même image
+struct DrawUniforms {
+    GLint deferredPass = 0;
+    GLint conePrepass = GL_FALSE;
+    GLint sdfCounterEnabled = GL_FALSE;
+    GLint stepHeatmap = 0;
+};
+
+// Lie les blocs uniformes d'une variante à leurs points de liaison et fixe les unités de ses textures
+static void bindProgramInterface(const SceneProgram& program) {
+    GLuint shaderProgram = program.program;
+    const std::pair<const char*, GLuint> blocks[] = {
+        { "Materials", kMaterialsBinding },
+        { "FrameUniforms", kFrameUniformsBinding },
+        { "DrawUniforms", kDrawUniformsBinding },
+        { "SceneAnimation", kSceneAnimationBinding },
+    };
+    for (const auto& block : blocks) {
+        GLuint index = glGetUniformBlockIndex(shaderProgram, block.first);
+        if (index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(shaderProgram, index, block.second);
+        }
+    }
+
+    const std::pair<const char*, GLint> samplers[] = {
+        { "texture1", 0 },
+        { "staticField", 1 },
+        { "coneDepth", 2 },
+        { "gBufferSurface", 3 },
+        { "gBufferNormal", 4 },
+        { "shadedColor", 5 },
+        { "colorLut", 6 },
+        { "checkerColor", 7 },
+        { "checkerSurface", 8 },
+        { "historyColor", 9 },
+        { "historySurface", 10 },
+        { "edgePyramid", 11 },
+        { "edgeColor", 12 },
+    };
+    glUseProgram(shaderProgram);
+    for (const auto& sampler : samplers) {
+        glUniform1i(glGetUniformLocation(shaderProgram, sampler.first), sampler.second);
+    }
+    glUseProgram(0);
+}
+
+// Source complète de la variante key : les #define sont insérés après #version. Renvoie faux sans #version.
+static bool variantFragmentSource(const std::string& sceneFragmentSource, unsigned key, std::string& fragmentShader) {
+    fragmentShader = sceneFragmentSource;
+    return insertShaderDefines(fragmentShader, shaderVariantDefines(key));
+}
+
+// La source contient déjà les #define de la variante ; la clé de variante distingue en plus les permutations
+static uint64_t variantCacheKey(const std::string& vertexSource, const std::string& fragmentShader, unsigned key) {
+    return programCacheKey(vertexSource, fragmentShader, "scene variant " + std::to_string(key));
+}
+
+// Compile la variante key du fragment shader de la scène sur le thread appelant, ou la relit dans le cache
+// des programmes. Renvoie un programme nul en cas d'échec.
+static SceneProgram compileVariant(SceneRenderer& renderer, const std::string& vertexSource,
+                                   const std::string& sceneFragmentSource, unsigned key, std::string* errorLog) {
+    SceneProgram variant;
+    std::string fragmentShader;
+    if (!variantFragmentSource(sceneFragmentSource, key, fragmentShader)) {
+        std::cerr << "Missing #version line in fragment shader" << std::endl;
+        return variant;
+    }
+    uint64_t cacheKey = variantCacheKey(vertexSource, fragmentShader, key);
+    variant.program = createCachedProgram(renderer.programCacheDirectory, cacheKey, [&]() {
+        return createShaderProgram(vertexSource, fragmentShader, errorLog);
+    }, &renderer.programCacheStats);
+    if (variant.program != 0) {
+        bindProgramInterface(variant);
+    }
+    return variant;
+}
+
+// Confie la variante key au thread de compilation
+static void submitVariant(SceneRenderer& renderer, unsigned long long generation, const std::string& vertexSource,
+                          const std::string& sceneFragmentSource, unsigned key) {
+    ShaderCompileJob job;
+    job.generation = generation;
+    job.variantKey = key;
+    job.vertexSource = vertexSource;
+    if (!variantFragmentSource(sceneFragmentSource, key, job.fragmentSource)) {
+        renderer.buildLog = "Ligne #version absente du fragment shader";
+        return;
+    }
+    job.cacheKey = variantCacheKey(vertexSource, job.fragmentSource, key);
+    submitShaderCompile(*renderer.compiler, std::move(job));
+}
+
+static void deleteVariants(SceneRenderer& renderer) {
+    for (auto& entry : renderer.programs) {
+        glDeleteProgram(entry.second.program);
+    }
+    renderer.programs.clear();
+}
+
+// Journal de démarrage : à froid (variantes compilées) ou à chaud (binaires relus dans le cache)
+static void logStartup(const SceneRenderer& renderer) {
+    const ProgramCacheStats& cache = renderer.programCacheStats;
+    double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - renderer.initStart).count();
+    std::cout << "Scene program ready " << startupMs << " ms after startup ("
+              << (cache.hits > 0 && cache.misses == 0 ? "warm" : "cold") << " start: " << cache.hits
+              << " program(s) loaded from cache in " << cache.loadMilliseconds << " ms, " << cache.misses
+              << " compiled in " << cache.compileMilliseconds << " ms, " << cache.rejected << " rejected)" << std::endl;
+}
+
+// Remplace les variantes par le premier programme lié des nouvelles sources
+static void commitSceneBuild(SceneRenderer& renderer, PendingSceneBuild& build, SceneProgram variant) {
+    bool firstProgram = renderer.programs.empty();
+    deleteVariants(renderer);
+    renderer.requestedVariants.clear();
+    renderer.programs[build.variantKey] = std::move(variant);
+    renderer.activeVariant = build.variantKey;
+    renderer.generation = build.generation;
+    renderer.vertexSource = std::move(build.vertexSource);
+    renderer.fragmentSource = std::move(build.fragmentSource);
+    renderer.sceneFragmentSource = std::move(build.sceneFragmentSource);
+    renderer.generatedScene = std::move(build.generated);
+    renderer.buildLog.clear();
+    build.active = false;
+    updateStaticField(renderer.staticField, renderer.sceneGraph, renderer.staticFieldResolution, renderer.staticFieldCacheDirectory);
+    if (firstProgram) {
+        logStartup(renderer);
+    }
+}
+
+// Régénère scene() dans fragmentSource puis compile la variante active, tout de suite ou sur le thread de
+// compilation. Les sources ne remplacent celles du renderer qu'une fois la variante liée.
+static bool buildScene(SceneRenderer& renderer, const std::string& vertexSource, const std::string& fragmentSource,
+                       std::string* errorLog) {
+    PendingSceneBuild build;
+    build.vertexSource = vertexSource;
+    build.fragmentSource = fragmentSource;
+    build.variantKey = renderer.activeVariant;
+
+    // staticScene() n'est générée que s'il existe des objets statiques finis à précalculer
+    glm::vec3 boundsMin, boundsMax;
+    bool staticField = staticFieldBounds(staticObjects(renderer.sceneGraph), boundsMin, boundsMax);
+    build.generated = generateSceneGlsl(renderer.sceneGraph, staticField);
+    build.sceneFragmentSource = fragmentSource;
+    if (!spliceSceneGlsl(build.sceneFragmentSource, build.generated.glsl)) {
+        renderer.buildLog = "Marqueurs @scene-begin / @scene-end absents du fragment shader";
+        if (errorLog) {
+            *errorLog = renderer.buildLog;
+        }
+        return false;
+    }
+    build.generation = ++renderer.generationCounter;
+
+    // Seule la variante active est compilée tout de suite, les autres le seront à leur prochaine utilisation
+    if (renderer.compiler) {
+        submitVariant(renderer, build.generation, build.vertexSource, build.sceneFragmentSource, build.variantKey);
+        build.active = true;
+        renderer.pendingBuild = std::move(build);
+        return true;
+    }
+
+    std::string log;
+    SceneProgram variant = compileVariant(renderer, build.vertexSource, build.sceneFragmentSource, build.variantKey, &log);
+    if (errorLog) {
+        *errorLog = log;
+    }
+    if (variant.program == 0) {
+        renderer.buildLog = log;
+        return false;
+    }
+    commitSceneBuild(renderer, build, std::move(variant));
+    return true;
+}
+
+bool rebuildSceneProgram(SceneRenderer& renderer, std::string* errorLog) {
+    // Des shaders rechargés mais encore en compilation ne doivent pas être remplacés par les anciens
+    const PendingSceneBuild& pending = renderer.pendingBuild;
+    if (pending.active) {
+        return buildScene(renderer, pending.vertexSource, pending.fragmentSource, errorLog);
+    }
+    return buildScene(renderer, renderer.vertexSource, renderer.fragmentSource, errorLog);
+}
+
+bool reloadSceneShaders(SceneRenderer& renderer) {
+    std::string vertexSource = readFile(kSceneVertexShaderPath);
+    std::string fragmentSource = readFile(kSceneFragmentShaderPath);
+    if (vertexSource.empty() || fragmentSource.empty()) {
+        return false;
+    }
+    std::cout << "Reloading scene shaders" << std::endl;
+    return buildScene(renderer, vertexSource, fragmentSource, nullptr);
+}
+
+bool updateSceneCompilation(SceneRenderer& renderer) {
+    bool changed = false;
+
+    // Rechargement à chaud : les dates des fichiers ne sont relues que toutes les kShaderWatchInterval secondes
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (renderer.hotReloadEnabled && now - renderer.lastShaderWatch >= std::chrono::duration<double>(kShaderWatchInterval)) {
+        renderer.lastShaderWatch = now;
+        if (shaderFilesChanged(renderer.shaderWatcher)) {
+            reloadSceneShaders(renderer);
+            changed = true;
+        }
+    }
+
+    if (!renderer.compiler) {
+        return changed;
+    }
+    for (ShaderCompileResult& result : takeShaderCompileResults(*renderer.compiler)) {
+        changed = true;
+        ProgramCacheStats& cache = renderer.programCacheStats;
+        cache.rejected += result.rejectedFromCache ? 1 : 0;
+        if (result.program != 0) {
+            // Attente côté GPU seulement : le thread de rendu n'est pas bloqué
+            glWaitSync(result.ready, 0, GL_TIMEOUT_IGNORED);
+            ++(result.fromCache ? cache.hits : cache.misses);
+            (result.fromCache ? cache.loadMilliseconds : cache.compileMilliseconds) += result.milliseconds;
+        }
+        glDeleteSync(result.ready);
+
+        SceneProgram variant;
+        variant.program = result.program;
+        PendingSceneBuild& build = renderer.pendingBuild;
+        if (build.active && result.generation == build.generation && result.variantKey == build.variantKey) {
+            // Première variante des nouvelles sources : en cas d'échec, l'ancien programme reste en place
+            if (variant.program == 0) {
+                renderer.buildLog = result.log;
+                build.active = false;
+                // Les variantes demandées pendant la compilation ont pu être abandonnées au profit de celle-ci
+                renderer.requestedVariants.clear();
+                continue;
+            }
+            bindProgramInterface(variant);
+            commitSceneBuild(renderer, build, std::move(variant));
+        } else if (result.generation == renderer.generation && renderer.generation != 0) {
+            if (variant.program == 0) {
+                // La variante reste marquée comme demandée pour ne pas être recompilée à chaque image
+                renderer.buildLog = result.log;
+                continue;
+            }
+            bindProgramInterface(variant);
+            glDeleteProgram(renderer.programs[result.variantKey].program);
+            renderer.programs[result.variantKey] = std::move(variant);
+        } else {
+            // Sources remplacées depuis la soumission
+            glDeleteProgram(result.program);
+        }
+    }
+    return changed;
+}
+
+bool sceneVariantReady(SceneRenderer& renderer, const SceneParams& params) {
+    unsigned key = shaderVariantKey(params);
+    if (renderer.programs.count(key) != 0) {
+        return true;
+    }
+    if (renderer.compiler && !renderer.programs.empty() && renderer.requestedVariants.insert(key).second) {
+        submitVariant(renderer, renderer.generation, renderer.vertexSource, renderer.sceneFragmentSource, key);
+    }
+    return false;
+}
+
+// Variante qui correspond à params. Sans thread de compilation, elle est compilée à la première demande ;
+// avec, elle est demandée au thread et la variante active est utilisée en attendant. Si la compilation
+// échoue, la variante active reste utilisée.
+static const SceneProgram& useVariant(SceneRenderer& renderer, const SceneParams& params) {
+    unsigned key = shaderVariantKey(params);
+    auto found = renderer.programs.find(key);
+    if (found == renderer.programs.end() && renderer.compiler) {
+        sceneVariantReady(renderer, params);
+        return renderer.programs.at(renderer.activeVariant);
+    }
+    if (found == renderer.programs.end()) {
+        SceneProgram variant = compileVariant(renderer, renderer.vertexSource, renderer.sceneFragmentSource, key, nullptr);
+        if (variant.program == 0) {
+            std::cerr << "Failed to compile shader variant " << key << std::endl;
+            return renderer.programs.at(renderer.activeVariant);
+        }
+        found = renderer.programs.emplace(key, std::move(variant)).first;
+    }
+    renderer.activeVariant = key;
+    return found->second;
+}
+
+// Écrit le bloc DrawUniforms d'un tracé dans l'anneau et le lie
+static void bindDrawUniforms(SceneRenderer& renderer, int deferredPass, bool conePrepass = false, bool sdfCounter = false,
+                             int stepHeatmap = 0) {
+    DrawUniforms draw;
+    draw.deferredPass = deferredPass;
+    draw.conePrepass = conePrepass;
+    draw.sdfCounterEnabled = sdfCounter;
+    draw.stepHeatmap = stepHeatmap;
+    bindUniformRingBlock(renderer.uniformRing, kDrawUniformsBinding, &draw, sizeof(draw));
+}
+
+// Lie la variante de params, les textures et le quad, puis écrit les blocs FrameUniforms et SceneAnimation
+// de params dans l'anneau. Le bloc DrawUniforms est lié ensuite par chaque passe.
+static void applySceneUniforms(SceneRenderer& renderer, const SceneParams& params, int width, int height) {
+    glViewport(0, 0, width, height);
+
+    const SceneProgram& program = useVariant(renderer, params);
+    glUseProgram(program.program);
+
+    // La LUT n'est recalculée que si la sépia, la teinte ou la correction gamma ont changé
+    if (colorGradingActive(params)) {
+        updateColorGrading(renderer.colorGrading, params);
+    }
+    if (renderer.materialsDirty) {
+        uploadMaterials(renderer.materialUbo, renderer.materials);
+        renderer.materialsDirty = false;
+    }
+    glBindBufferBase(GL_UNIFORM_BUFFER, kMaterialsBinding, renderer.materialUbo);
+
+    const StaticField& field = renderer.staticField;
+    FrameUniforms frame;
+    frame.resolution = glm::vec2((float)width, (float)height);
+    frame.mouse = glm::vec2(params.mouseX, params.mouseY);
+    frame.objectPosition = params.objectPosition;
+    frame.time = params.time;
+    frame.fov = glm::radians(params.fov);
+    frame.objectRotationX = glm::radians(params.objectRotationX);
+    frame.objectRotationY = glm::radians(params.objectRotationY);
+    frame.objectRotationZ = glm::radians(params.objectRotationZ);
+    frame.staticFieldMin = field.boundsMin;
+    frame.staticFieldResolution = (float)field.resolution;
+    frame.staticFieldMax = field.boundsMax;
+    frame.staticFieldBand = field.band;
+    frame.staticFieldMargin = field.margin;
+    frame.shadowSoftness = params.shadowSoftness;
+    frame.colorLutRange = kColorLutRange;
+    frame.colorLutSize = (float)kColorLutSize;
+    frame.boundsEnabled = params.boundsEnabled;
+    frame.softShadowsEnabled = params.softShadowsEnabled;
+    frame.shadowsAllModels = params.shadowsAllModels;
+    frame.staticFieldEnabled = params.staticFieldEnabled && field.texture != 0;
+    frame.coneDepthEnabled = params.conePrepassEnabled;
+    frame.coneTileSize = params.coneTileSize;
+    frame.materialCount = std::min((int)renderer.materials.size(), kMaxMaterials);
+    frame.marchRelaxation = params.overRelaxationEnabled ? params.marchRelaxation : 1.0f;
+    frame.previousMouse = renderer.historyMouse;
+    frame.previousResolution = renderer.historyResolution;
+    frame.previousFov = glm::radians(renderer.historyFov);
+    frame.checkerParity = renderer.checkerParity;
+    frame.checkerHistoryValid = renderer.historyValid;
+    frame.analyticIntersections = params.analyticIntersectionsEnabled;
+    frame.edgeAntialiasing = params.antialiasing == 1 && !params.checkerboardEnabled;
+    frame.edgePyramidTop = std::max(renderer.edgePyramidLevels - 1, 0);
+    frame.edgeColorTexels = renderer.edgeColorRows * kEdgeListWidth;
+    frame.padding = 0;
+    bindUniformRingBlock(renderer.uniformRing, kFrameUniformsBinding, &frame, sizeof(frame));
+
+    // Transformations animées du graphe de scène, évaluées sur le CPU une fois par image, puis leurs
+    // volumes englobants, dans l'ordre des membres du bloc SceneAnimation généré
+    const SdfGeneratedScene& generated = renderer.generatedScene;
+    if (!generated.animatedObjects.empty()) {
+        std::vector<glm::vec4>& animation = renderer.animationStaging;
+        animation.clear();
+        for (const SdfTransform& transform : generated.animatedTransforms) {
+            animation.push_back(glm::vec4(animatedTransformValue(transform, params), 0.0f));
+        }
+        for (const SdfFlatObject& object : generated.animatedObjects) {
+            animation.push_back(animatedObjectBound(object, params));
+        }
+        bindUniformRingBlock(renderer.uniformRing, kSceneAnimationBinding, animation.data(),
+                             animation.size() * sizeof(glm::vec4));
+    }
+
+    glActiveTexture(GL_TEXTURE6);
+    glBindTexture(GL_TEXTURE_3D, renderer.colorGrading.texture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_3D, field.texture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, params.conePrepassEnabled ? renderer.coneTexture : 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, renderer.texture);
+
+    glBindVertexArray(renderer.vao);
+}
+
+// Marche un cône par tuile dans la cible basse résolution. Le framebuffer lié avant l'appel est restauré.
+static void renderConePrepass(SceneRenderer& renderer, const SceneParams& params, int width, int height) {
+    GLint previousFbo = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+
+    // Une tuile partielle couvre le bord droit et le bord haut
+    int tileSize = std::max(1, params.coneTileSize);
+    int coneWidth = (width + tileSize - 1) / tileSize;
+    int coneHeight = (height + tileSize - 1) / tileSize;
+    if (renderer.coneFbo == 0 || renderer.coneWidth != coneWidth || renderer.coneHeight != coneHeight) {
+        if (renderer.coneFbo == 0) {
+            glGenFramebuffers(1, &renderer.coneFbo);
+            glGenTextures(1, &renderer.coneTexture);
+        }
+        glBindTexture(GL_TEXTURE_2D, renderer.coneTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, coneWidth, coneHeight, 0, GL_RG, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, renderer.coneFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderer.coneTexture, 0);
+        renderer.coneWidth = coneWidth;
+        renderer.coneHeight = coneHeight;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer.coneFbo);
+    // iResolution reste celle de l'image finale : le shader reconstruit les rayons de chaque tuile
+    SceneParams prepassParams = params;
+    prepassParams.conePrepassEnabled = false;
+    applySceneUniforms(renderer, prepassParams, width, height);
+    glViewport(0, 0, coneWidth, coneHeight);
+    bindDrawUniforms(renderer, 0, true);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+}
+
+// Texture d'une cible du rendu différé, lue texel par texel
+static void allocateTarget(GLuint texture, GLint internalFormat, GLenum format, int width, int height) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+// Requêtes d'horodatage des passes, partagées par le rendu différé et le damier
+static void ensurePassQueries(SceneRenderer& renderer) {
+    if (renderer.passQueries[0][0] != 0) {
+        return;
+    }
+    for (int i = 0; i < kDeferredTimingFrames; ++i) {
+        glGenQueries(kDeferredTimestamps, renderer.passQueries[i]);
+    }
+}
+
+// Taille d'allocation des cibles intermédiaires pour une image de width x height : celle de la cible finale,
+// que l'image peut ne couvrir qu'en partie
+static void allocationSize(const SceneRenderer& renderer, int width, int height, int& allocatedWidth, int& allocatedHeight) {
+    allocatedWidth = std::max(width, renderer.targetWidth);
+    allocatedHeight = std::max(height, renderer.targetHeight);
+}
+
+// (Ré)alloue le G-buffer et la cible éclairée à la taille de la cible finale ; l'image en occupe le coin
+// inférieur gauche
+static void resizeGBuffer(SceneRenderer& renderer, int width, int height) {
+    ensurePassQueries(renderer);
+    allocationSize(renderer, width, height, width, height);
+    if (renderer.gBufferFbo != 0 && renderer.gBufferWidth == width && renderer.gBufferHeight == height) {
+        return;
+    }
+    if (renderer.gBufferFbo == 0) {
+        glGenFramebuffers(1, &renderer.gBufferFbo);
+        glGenFramebuffers(1, &renderer.shadedFbo);
+        glGenTextures(1, &renderer.gBufferSurface);
+        glGenTextures(1, &renderer.gBufferNormal);
+        glGenTextures(1, &renderer.shadedColor);
+    }
+    allocateTarget(renderer.gBufferSurface, GL_RG32F, GL_RG, width, height);
+    allocateTarget(renderer.gBufferNormal, GL_RGBA16F, GL_RGBA, width, height);
+    allocateTarget(renderer.shadedColor, GL_RGBA16F, GL_RGBA, width, height);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer.gBufferFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderer.gBufferSurface, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, renderer.gBufferNormal, 0);
+    const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer.shadedFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderer.shadedColor, 0);
+
+    renderer.gBufferWidth = width;
+    renderer.gBufferHeight = height;
+    renderer.skipNextPassTiming = true;
+}
+
+// (Ré)alloue la cible du damier en demi-largeur et les deux images reconstruites à la taille de la cible finale.
+// L'historique n'est perdu qu'à une nouvelle allocation : d'une échelle à l'autre de la résolution dynamique, il
+// est relu à sa propre taille (historyResolution).
+static void resizeCheckerboard(SceneRenderer& renderer, int width, int height) {
+    ensurePassQueries(renderer);
+    allocationSize(renderer, width, height, width, height);
+    if (renderer.checkerFbo != 0 && renderer.checkerWidth == width && renderer.checkerHeight == height) {
+        return;
+    }
+    if (renderer.checkerFbo == 0) {
+        glGenFramebuffers(1, &renderer.checkerFbo);
+        glGenTextures(1, &renderer.checkerColor);
+        glGenTextures(1, &renderer.checkerSurface);
+        glGenFramebuffers(2, renderer.historyFbo);
+        glGenTextures(2, renderer.historyColor);
+        glGenTextures(2, renderer.historySurface);
+    }
+    const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+
+    // Une colonne de plus pour une largeur impaire : la ligne dont le damier commence à 0 a un pixel de plus
+    allocateTarget(renderer.checkerColor, GL_RGBA16F, GL_RGBA, (width + 1) / 2, height);
+    allocateTarget(renderer.checkerSurface, GL_RG32F, GL_RG, (width + 1) / 2, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer.checkerFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderer.checkerColor, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, renderer.checkerSurface, 0);
+    glDrawBuffers(2, drawBuffers);
+
+    for (int i = 0; i < 2; ++i) {
+        allocateTarget(renderer.historyColor[i], GL_RGBA16F, GL_RGBA, width, height);
+        allocateTarget(renderer.historySurface[i], GL_RG32F, GL_RG, width, height);
+        glBindFramebuffer(GL_FRAMEBUFFER, renderer.historyFbo[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderer.historyColor[i], 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, renderer.historySurface[i], 0);
+        glDrawBuffers(2, drawBuffers);
+    }
+
+    renderer.checkerWidth = width;
+    renderer.checkerHeight = height;
+    renderer.historyValid = false;
+    renderer.skipNextPassTiming = true;
+}
+
+// Programme de la pyramide des bords, compilé à la première image anticrénelée. Nul si la compilation échoue :
+// la pyramide reste alors vide et aucun pixel n'est anticrénelé.
+static void createEdgePyramidProgram(SceneRenderer& renderer) {
+    std::string errorLog;
+    renderer.edgePyramidProgram = createShaderProgram(readFile(kSceneVertexShaderPath), readFile(kEdgePyramidShaderPath),
+                                                      &errorLog);
+    if (renderer.edgePyramidProgram == 0) {
+        std::cerr << "Failed to create edge pyramid shader program:\n" << errorLog << std::endl;
+        return;
+    }
+    GLuint program = renderer.edgePyramidProgram;
+    renderer.edgePyramidPassLocation = glGetUniformLocation(program, "pyramidPass");
+    renderer.edgeImageSizeLocation = glGetUniformLocation(program, "imageSize");
+    renderer.edgeThresholdLocation = glGetUniformLocation(program, "edgeThreshold");
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "gBufferSurface"), 3);
+    glUniform1i(glGetUniformLocation(program, "edgePyramid"), 11);
+    glUseProgram(0);
+}
+
+// (Ré)alloue la pyramide des bords, aux puissances de deux de la cible finale pour que chaque niveau soit
+// exactement la moitié du précédent, et la cible compacte de leurs couleurs, assez grande pour tous les pixels
+static void resizeEdgeTargets(SceneRenderer& renderer, int width, int height) {
+    allocationSize(renderer, width, height, width, height);
+    int pyramidWidth = 1;
+    int pyramidHeight = 1;
+    while (pyramidWidth < width) {
+        pyramidWidth *= 2;
+    }
+    while (pyramidHeight < height) {
+        pyramidHeight *= 2;
+    }
+    if (renderer.edgePyramidFbo != 0 && renderer.edgePyramidWidth == pyramidWidth
+        && renderer.edgePyramidHeight == pyramidHeight) {
+        return;
+    }
+    if (renderer.edgePyramidFbo == 0) {
+        createEdgePyramidProgram(renderer);
+        glGenFramebuffers(1, &renderer.edgePyramidFbo);
+        glGenTextures(1, &renderer.edgePyramid);
+        glGenFramebuffers(1, &renderer.edgeColorFbo);
+        glGenTextures(1, &renderer.edgeColor);
+        glGenBuffers(1, &renderer.edgeCountBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, renderer.edgeCountBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(float), nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    allocateTarget(renderer.edgePyramid, GL_R32F, GL_RED, pyramidWidth, pyramidHeight);
+    int levels = 1;
+    for (int w = pyramidWidth, h = pyramidHeight; w > 1 || h > 1; ++levels) {
+        w = std::max(w / 2, 1);
+        h = std::max(h / 2, 1);
+        glTexImage2D(GL_TEXTURE_2D, levels, GL_R32F, w, h, 0, GL_RED, GL_FLOAT, nullptr);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+
+    int rows = (width * height + kEdgeListWidth - 1) / kEdgeListWidth;
+    allocateTarget(renderer.edgeColor, GL_RGBA16F, GL_RGBA, kEdgeListWidth, rows);
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer.edgeColorFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderer.edgeColor, 0);
+
+    renderer.edgePyramidWidth = pyramidWidth;
+    renderer.edgePyramidHeight = pyramidHeight;
+    renderer.edgePyramidLevels = levels;
+    renderer.edgeCountRead = -1;
+    renderer.skipNextPassTiming = true;
+}
+
+// Lignes de edgeColor tracées au-delà du double du dernier nombre de bords relu
+static const int kEdgeRowMargin = 8;
+
+// Repérage des bords dans le niveau 0 de la pyramide, puis sommes de niveau en niveau jusqu'au sommet 1x1. Chaque
+// passe ne voit que le niveau qu'elle lit, jamais celui qu'elle écrit. Avec readCount, le sommet est copié dans
+// edgeCountBuffer, relu par updateEdgePixelCount() quand le GPU l'a écrit. Le programme de la scène est ensuite
+// remis en place pour les passes suivantes.
+static void buildEdgePyramid(SceneRenderer& renderer, const SceneParams& params, int width, int height,
+                             bool readCount) {
+    glActiveTexture(GL_TEXTURE11);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer.edgePyramidFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderer.edgePyramid, 0);
+    const GLfloat zero[4] = {};
+    glClearBufferfv(GL_COLOR, 0, zero);
+
+    if (renderer.edgePyramidProgram != 0) {
+        glUseProgram(renderer.edgePyramidProgram);
+        glUniform2f(renderer.edgeImageSizeLocation, (float)width, (float)height);
+        glUniform1f(renderer.edgeThresholdLocation, params.edgeThreshold);
+        glUniform1i(renderer.edgePyramidPassLocation, 0);
+        glViewport(0, 0, width, height);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, renderer.edgePyramid);
+    glUniform1i(renderer.edgePyramidPassLocation, 1);
+    for (int level = 1; level < renderer.edgePyramidLevels; ++level) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderer.edgePyramid, level);
+        if (renderer.edgePyramidProgram != 0) {
+            glViewport(0, 0, std::max(renderer.edgePyramidWidth >> level, 1),
+                       std::max(renderer.edgePyramidHeight >> level, 1));
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        } else {
+            glClearBufferfv(GL_COLOR, 0, zero);
+        }
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, renderer.edgePyramidLevels - 1);
+    glUseProgram(renderer.programs.at(renderer.activeVariant).program);
+
+    // Le framebuffer lit encore le sommet ; une seule lecture en vol à la fois
+    if (readCount && renderer.edgeCountFence == nullptr) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, renderer.edgeCountBuffer);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glReadPixels(0, 0, 1, 1, GL_RED, GL_FLOAT, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        renderer.edgeCountFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+void updateEdgePixelCount(SceneRenderer& renderer) {
+    if (renderer.edgeCountFence == nullptr) {
+        return;
+    }
+    GLenum status = glClientWaitSync(renderer.edgeCountFence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        return;
+    }
+    glDeleteSync(renderer.edgeCountFence);
+    renderer.edgeCountFence = nullptr;
+    float count = 0.0f;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, renderer.edgeCountBuffer);
+    glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, sizeof(count), &count);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    renderer.edgePixelCount = (int)count;
+    renderer.edgeCountRead = (int)count;
+}
+
+// Lit les horodatages revenus et met à jour renderer.passTimings
+static void readPassTimings(SceneRenderer& renderer) {
+    for (int i = 0; i < kDeferredTimingFrames; ++i) {
+        if (!renderer.passQueryPending[i]) {
+            continue;
+        }
+        // Les requêtes se terminent dans l'ordre : la dernière disponible, toutes le sont
+        GLint available = 0;
+        glGetQueryObjectiv(renderer.passQueries[i][kDeferredTimestamps - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            continue;
+        }
+        GLuint64 stamps[kDeferredTimestamps];
+        for (int j = 0; j < kDeferredTimestamps; ++j) {
+            glGetQueryObjectui64v(renderer.passQueries[i][j], GL_QUERY_RESULT, &stamps[j]);
+        }
+        renderer.passQueryPending[i] = false;
+
+        // La première image après une allocation paie la compilation des variantes du shader pour ces cibles
+        if (renderer.skipNextPassTiming) {
+            renderer.skipNextPassTiming = false;
+            continue;
+        }
+        DeferredPassTimings& timings = renderer.passTimings;
+        timings.prepassMs = (stamps[1] - stamps[0]) / 1.0e6;
+        timings.marchMs = (stamps[2] - stamps[1]) / 1.0e6;
+        timings.shadingMs = (stamps[3] - stamps[2]) / 1.0e6;
+        timings.edgeDetectMs = (stamps[4] - stamps[3]) / 1.0e6;
+        timings.supersampleMs = (stamps[5] - stamps[4]) / 1.0e6;
+        timings.postMs = (stamps[6] - stamps[5]) / 1.0e6;
+        ++timings.samples;
+    }
+}
+
+// Marche vers le G-buffer, éclairage dans la cible éclairée, puis post-traitements dans le framebuffer lié
+// avant l'appel. Chaque passe est un tracé plein écran du même programme, sélectionné par deferredPass.
+// En damier, la marche et l'éclairage d'un pixel sur deux remplacent les deux premières passes, et la
+// reconstruction de l'image complète, gardée comme historique de l'image suivante, remplace l'éclairage.
+// Hors damier, l'anticrénelage remarche les pixels de bord, repris par les post-traitements ; le 4x SSAA remplace
+// la marche et l'éclairage par quatre rayons pour chaque pixel.
+// Sans measured, l'image n'est ni chronométrée ni comptée (images de référence des comparaisons).
+static void renderSceneDeferred(SceneRenderer& renderer, const SceneParams& params, int width, int height,
+                                bool measured) {
+    GLint previousFbo = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+    bool checkerboard = params.checkerboardEnabled;
+    int antialiasing = checkerboard ? 0 : params.antialiasing;
+    if (checkerboard) {
+        resizeCheckerboard(renderer, width, height);
+        renderer.checkerParity ^= 1;
+    } else {
+        resizeGBuffer(renderer, width, height);
+    }
+    readPassTimings(renderer);
+    if (antialiasing == 1) {
+        resizeEdgeTargets(renderer, width, height);
+        updateEdgePixelCount(renderer);
+
+        // Les rayons des bords ne couvrent que deux fois le dernier nombre de bords relu, plus une marge : toute la
+        // cible compacte coûterait un fragment par pixel de l'image, même rejeté à la lecture du sommet
+        int rows = (width * height + kEdgeListWidth - 1) / kEdgeListWidth;
+        if (renderer.edgeCountRead >= 0) {
+            rows = std::min(rows, (2 * renderer.edgeCountRead + kEdgeListWidth - 1) / kEdgeListWidth + kEdgeRowMargin);
+        }
+        renderer.edgeColorRows = rows;
+    }
+
+    // Une image dont les requêtes sont encore en vol n'est pas chronométrée, plutôt que d'attendre le GPU
+    int query = renderer.nextPassQuery;
+    bool timed = measured && !renderer.passQueryPending[query];
+    if (timed) {
+        renderer.nextPassQuery = (renderer.nextPassQuery + 1) % kDeferredTimingFrames;
+    }
+    GLuint* stamps = renderer.passQueries[query];
+    auto timestamp = [&](int index) {
+        if (timed) {
+            glQueryCounter(stamps[index], GL_TIMESTAMP);
+        }
+    };
+
+    timestamp(0);
+    if (params.conePrepassEnabled) {
+        ProfilerScope scope(renderer.profiler, "Pré-passe de cônes");
+        renderConePrepass(renderer, params, width, height);
+    }
+    timestamp(1);
+
+    if (checkerboard) {
+        ProfilerScope scope(renderer.profiler, "Marche en damier");
+        glBindFramebuffer(GL_FRAMEBUFFER, renderer.checkerFbo);
+        applySceneUniforms(renderer, params, width, height);
+        glViewport(0, 0, (width + 1) / 2, height);
+        bindDrawUniforms(renderer, 4);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    } else if (antialiasing == 2) {
+        applySceneUniforms(renderer, params, width, height);
+    } else {
+        ProfilerScope scope(renderer.profiler, "Marche (G-buffer)");
+        glBindFramebuffer(GL_FRAMEBUFFER, renderer.gBufferFbo);
+        applySceneUniforms(renderer, params, width, height);
+        bindDrawUniforms(renderer, 1);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    timestamp(2);
+
+    GLuint litColor = renderer.shadedColor;
+    if (checkerboard) {
+        ProfilerScope scope(renderer.profiler, "Reconstruction");
+        int current = renderer.historyIndex ^ 1;
+        int previous = renderer.historyIndex;
+        glBindFramebuffer(GL_FRAMEBUFFER, renderer.historyFbo[current]);
+        glViewport(0, 0, width, height);
+        bindDrawUniforms(renderer, 5);
+        const std::pair<GLenum, GLuint> textures[] = {
+            { GL_TEXTURE7, renderer.checkerColor },
+            { GL_TEXTURE8, renderer.checkerSurface },
+            { GL_TEXTURE9, renderer.historyColor[previous] },
+            { GL_TEXTURE10, renderer.historySurface[previous] },
+        };
+        for (const auto& texture : textures) {
+            glActiveTexture(texture.first);
+            glBindTexture(GL_TEXTURE_2D, texture.second);
+        }
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+        // L'image reconstruite devient l'historique de la suivante, vue par la caméra de celle-ci
+        litColor = renderer.historyColor[current];
+        renderer.historyIndex = current;
+        renderer.historyValid = true;
+        renderer.historyMouse = glm::vec2(params.mouseX, params.mouseY);
+        renderer.historyResolution = glm::vec2((float)width, (float)height);
+        renderer.historyFov = params.fov;
+    } else if (antialiasing != 2) {
+        ProfilerScope scope(renderer.profiler, "Éclairage");
+        glBindFramebuffer(GL_FRAMEBUFFER, renderer.shadedFbo);
+        bindDrawUniforms(renderer, 2);
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, renderer.gBufferSurface);
+        glActiveTexture(GL_TEXTURE4);
+        glBindTexture(GL_TEXTURE_2D, renderer.gBufferNormal);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    timestamp(3);
+
+    // Anticrénelage : la pyramide compacte les pixels de bord sur le GPU. Les rayons supplémentaires ne sont
+    // lancés que pour les texels de la cible compacte, sans fragments inactifs autour d'eux ; les texels au-delà du
+    // nombre de bords s'arrêtent à la lecture du sommet.
+    if (antialiasing == 1) {
+        ProfilerScope scope(renderer.profiler, "Repérage des bords");
+        buildEdgePyramid(renderer, params, width, height, measured);
+    }
+    timestamp(4);
+    if (measured && antialiasing != 1) {
+        renderer.edgePixelCount = antialiasing == 2 ? width * height : 0;
+    }
+    if (antialiasing == 1) {
+        ProfilerScope scope(renderer.profiler, "Rayons des bords");
+        glBindFramebuffer(GL_FRAMEBUFFER, renderer.edgeColorFbo);
+        glViewport(0, 0, kEdgeListWidth, renderer.edgeColorRows);
+        bindDrawUniforms(renderer, 7);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        glActiveTexture(GL_TEXTURE12);
+        glBindTexture(GL_TEXTURE_2D, renderer.edgeColor);
+    } else if (antialiasing == 2) {
+        ProfilerScope scope(renderer.profiler, "4x SSAA");
+        glBindFramebuffer(GL_FRAMEBUFFER, renderer.shadedFbo);
+        bindDrawUniforms(renderer, 6);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    timestamp(5);
+
+    {
+        ProfilerScope scope(renderer.profiler, "Post-traitements");
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+        glViewport(0, 0, width, height);
+        bindDrawUniforms(renderer, 3);
+        glActiveTexture(GL_TEXTURE5);
+        glBindTexture(GL_TEXTURE_2D, litColor);
+        glActiveTexture(GL_TEXTURE0);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    timestamp(6);
+
+    if (timed) {
+        renderer.passQueryPending[query] = true;
+    }
+}
+
+static void submitScene(SceneRenderer& renderer, const SceneParams& params, int width, int height,
+                        bool measured = true) {
+    // La carte de coût a besoin des compteurs de la marche et de l'éclairage dans le même fragment
+    bool deferred = params.deferredEnabled || params.checkerboardEnabled || params.antialiasing != 0;
+    if (deferred && params.stepHeatmap == 0) {
+        renderSceneDeferred(renderer, params, width, height, measured);
+        return;
+    }
+    if (params.conePrepassEnabled) {
+        ProfilerScope scope(renderer.profiler, "Pré-passe de cônes");
+        renderConePrepass(renderer, params, width, height);
+    }
+    ProfilerScope scope(renderer.profiler, "Raymarching");
+    applySceneUniforms(renderer, params, width, height);
+    bindDrawUniforms(renderer, 0, false, false, params.stepHeatmap);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+}
+
+void renderScene(SceneRenderer& renderer, const SceneParams& params, int width, int height) {
+    // Premier programme encore en compilation sur le thread de compilation : l'image reste noire
+    if (renderer.programs.empty()) {
+        glViewport(0, 0, width, height);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        return;
+    }
+    // Une image rendue autrement rend l'historique du damier obsolète
+    if (!params.checkerboardEnabled) {
+        renderer.historyValid = false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    submitScene(renderer, params, width, height);
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    SubmitTimings& timings = renderer.submitTimings;
+    timings.lastMs = elapsed;
+    timings.totalMs += elapsed;
+    ++timings.samples;
+}
+
+// Lie la cible hors écran du mode compteur, flottante et recréée quand la résolution change : les compteurs
+// y sont exacts
+static void bindCounterTarget(SceneRenderer& renderer, int width, int height) {
+    if (renderer.counterFbo == 0 || renderer.counterWidth != width || renderer.counterHeight != height) {
+        if (renderer.counterFbo == 0) {
+            glGenFramebuffers(1, &renderer.counterFbo);
+            glGenRenderbuffers(1, &renderer.counterColorBuffer);
+        }
+        glBindRenderbuffer(GL_RENDERBUFFER, renderer.counterColorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA32F, width, height);
+        glBindFramebuffer(GL_FRAMEBUFFER, renderer.counterFbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderer.counterColorBuffer);
+        renderer.counterWidth = width;
+        renderer.counterHeight = height;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer.counterFbo);
+}
+
+bool readSceneSurface(SceneRenderer& renderer, const SceneParams& params, int width, int height,
+                      std::vector<float>& surface) {
+    if (renderer.programs.empty()) {
+        return false;
+    }
+    GLint previousFbo = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+
+    SceneParams surfaceParams = params;
+    surfaceParams.stepHeatmap = 0;
+    if (surfaceParams.conePrepassEnabled) {
+        renderConePrepass(renderer, surfaceParams, width, height);
+    }
+    resizeGBuffer(renderer, width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, renderer.gBufferFbo);
+    applySceneUniforms(renderer, surfaceParams, width, height);
+    bindDrawUniforms(renderer, 1);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+    surface.resize((size_t)width * height * 2);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RG, GL_FLOAT, surface.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+    return true;
+}
+
+SdfCounterStats countSdfEvaluations(SceneRenderer& renderer, const SceneParams& params, int width, int height) {
+    if (renderer.programs.empty()) {
+        return SdfCounterStats();
+    }
+    GLint previousFbo = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+
+    if (params.conePrepassEnabled) {
+        renderConePrepass(renderer, params, width, height);
+    }
+    bindCounterTarget(renderer, width, height);
+    applySceneUniforms(renderer, params, width, height);
+    bindDrawUniforms(renderer, 0, false, true);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+    std::vector<float> pixels((size_t)width * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_FLOAT, pixels.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+
+    // Rouge = évaluations SDF, vert = pas primaires, bleu = pas d'ombre,
+    // alpha = rayons à court de pas (1 pour le primaire + 2 par rayon d'ombre)
+    SdfCounterStats stats;
+    double total = 0.0;
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        int count = (int)pixels[i];
+        int primarySteps = (int)pixels[i + 1];
+        int shadowSteps = (int)pixels[i + 2];
+        int exhausted = (int)pixels[i + 3];
+        total += count;
+        stats.maxEvaluations = std::max(stats.maxEvaluations, count);
+        stats.totalPrimarySteps += primarySteps;
+        stats.totalShadowSteps += shadowSteps;
+        stats.maxPrimarySteps = std::max(stats.maxPrimarySteps, primarySteps);
+        stats.maxShadowSteps = std::max(stats.maxShadowSteps, shadowSteps);
+        stats.exhaustedPrimaryRays += exhausted & 1;
+        stats.exhaustedShadowRays += exhausted >> 1;
+    }
+    double pixelCount = (double)width * height;
+    stats.meanEvaluations = total / pixelCount;
+    stats.meanPrimarySteps = stats.totalPrimarySteps / pixelCount;
+    stats.meanShadowSteps = stats.totalShadowSteps / pixelCount;
+
+    // Pas des cônes, relus dans le canal vert de la cible de la pré-passe
+    if (params.conePrepassEnabled) {
+        std::vector<float> cones((size_t)renderer.coneWidth * renderer.coneHeight * 2);
+        glBindFramebuffer(GL_FRAMEBUFFER, renderer.coneFbo);
+        glReadPixels(0, 0, renderer.coneWidth, renderer.coneHeight, GL_RG, GL_FLOAT, cones.data());
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+        double coneSteps = 0.0;
+        for (size_t i = 1; i < cones.size(); i += 2) {
+            coneSteps += cones[i];
+        }
+        stats.meanPrepassSteps = coneSteps / ((double)width * height);
+    }
+    return stats;
+}
+
+// Composantes RGBA 8 bits du framebuffer de lecture lié
+static std::vector<unsigned char> readFramebufferPixels(int width, int height) {
+    std::vector<unsigned char> pixels((size_t)width * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+// PSNR sur les composantes RGB, 99 dB pour des images identiques
+static double imagePsnr(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b) {
+    double squaredError = 0.0;
+    for (size_t i = 0; i < a.size(); i += 4) {
+        for (int c = 0; c < 3; ++c) {
+            double difference = (double)a[i + c] - b[i + c];
+            squaredError += difference * difference;
+        }
+    }
+    double meanSquaredError = squaredError / (3.0 * (a.size() / 4));
+    return meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+}
+
+// Rend params dans la cible hors écran, sans horodatages des passes, et relit l'image. Renvoie le temps GPU
+// du rendu en ms. La cible hors écran reste liée.
+static double renderOffscreen(SceneRenderer& renderer, const SceneParams& params, int width, int height,
+                              std::vector<unsigned char>& pixels) {
+    bindCounterTarget(renderer, width, height);
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    submitScene(renderer, params, width, height, false);
+    glEndQuery(GL_TIME_ELAPSED);
+    pixels = readFramebufferPixels(width, height);
+
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    glDeleteQueries(1, &query);
+    return elapsed / 1.0e6;
+}
+
+// Somme des temps GPU des passes de la dernière image chronométrée
+static double passTimingsTotalMs(const DeferredPassTimings& passes) {
+    return passes.prepassMs + passes.marchMs + passes.shadingMs + passes.edgeDetectMs + passes.supersampleMs
+        + passes.postMs;
+}
+
+ImageComparison compareCheckerboard(SceneRenderer& renderer, const SceneParams& params, int width, int height) {
+    ImageComparison comparison;
+    if (renderer.programs.empty() || !renderer.historyValid) {
+        return comparison;
+    }
+    GLint previousFbo = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+
+    // Image en damier, telle qu'elle vient d'être rendue
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previousFbo);
+    std::vector<unsigned char> checkerPixels = readFramebufferPixels(width, height);
+
+    // Image complète en une passe ; l'historique du damier n'est pas touché
+    SceneParams fullParams = params;
+    fullParams.checkerboardEnabled = false;
+    fullParams.deferredEnabled = false;
+    fullParams.antialiasing = 0;
+    fullParams.stepHeatmap = 0;
+    std::vector<unsigned char> fullPixels;
+    comparison.referenceMs = renderOffscreen(renderer, fullParams, width, height, fullPixels);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+
+    comparison.psnr = imagePsnr(checkerPixels, fullPixels);
+    comparison.renderedMs = passTimingsTotalMs(renderer.passTimings);
+    comparison.valid = true;
+    return comparison;
+}
+
+ImageComparison compareEdgeAntialiasing(SceneRenderer& renderer, const SceneParams& params, int width, int height) {
+    ImageComparison comparison;
+    if (renderer.programs.empty() || params.antialiasing != 1 || params.checkerboardEnabled || params.stepHeatmap != 0) {
+        return comparison;
+    }
+    GLint previousFbo = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFbo);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previousFbo);
+    std::vector<unsigned char> edgePixels = readFramebufferPixels(width, height);
+
+    // Quatre rayons pour tous les pixels, puis un seul
+    SceneParams referenceParams = params;
+    referenceParams.antialiasing = 2;
+    std::vector<unsigned char> referencePixels;
+    comparison.referenceMs = renderOffscreen(renderer, referenceParams, width, height, referencePixels);
+    SceneParams aliasedParams = params;
+    aliasedParams.antialiasing = 0;
+    std::vector<unsigned char> aliasedPixels;
+    renderOffscreen(renderer, aliasedParams, width, height, aliasedPixels);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFbo);
+
+    comparison.psnr = imagePsnr(edgePixels, referencePixels);
+    comparison.aliasedPsnr = imagePsnr(aliasedPixels, referencePixels);
+    comparison.renderedMs = passTimingsTotalMs(renderer.passTimings);
+    comparison.valid = true;
+    return comparison;
+}
+
+void destroySceneRenderer(SceneRenderer& renderer) {
+    if (renderer.gBufferFbo != 0) {
+        glDeleteFramebuffers(1, &renderer.gBufferFbo);
+        glDeleteFramebuffers(1, &renderer.shadedFbo);
+        glDeleteTextures(1, &renderer.gBufferSurface);
+        glDeleteTextures(1, &renderer.gBufferNormal);
+        glDeleteTextures(1, &renderer.shadedColor);
+    }
+    if (renderer.passQueries[0][0] != 0) {
+        for (int i = 0; i < kDeferredTimingFrames; ++i) {
+            glDeleteQueries(kDeferredTimestamps, renderer.passQueries[i]);
+        }
+    }
+    if (renderer.checkerFbo != 0) {
+        glDeleteFramebuffers(1, &renderer.checkerFbo);
+        glDeleteTextures(1, &renderer.checkerColor);
+        glDeleteTextures(1, &renderer.checkerSurface);
+        glDeleteFramebuffers(2, renderer.historyFbo);
+        glDeleteTextures(2, renderer.historyColor);
+        glDeleteTextures(2, renderer.historySurface);
+    }
+    if (renderer.edgePyramidFbo != 0) {
+        glDeleteFramebuffers(1, &renderer.edgePyramidFbo);
+        glDeleteTextures(1, &renderer.edgePyramid);
+        glDeleteFramebuffers(1, &renderer.edgeColorFbo);
+        glDeleteTextures(1, &renderer.edgeColor);
+        glDeleteBuffers(1, &renderer.edgeCountBuffer);
+        glDeleteProgram(renderer.edgePyramidProgram);
+    }
+    if (renderer.edgeCountFence != nullptr) {
+        glDeleteSync(renderer.edgeCountFence);
+    }
+    if (renderer.counterFbo != 0) {
+        glDeleteFramebuffers(1, &renderer.counterFbo);
+        glDeleteRenderbuffers(1, &renderer.counterColorBuffer);
+    }
+    if (renderer.coneFbo != 0) {
+        glDeleteFramebuffers(1, &renderer.coneFbo);
+        glDeleteTextures(1, &renderer.coneTexture);
+    }
+    glDeleteVertexArrays(1, &renderer.vao);
+    glDeleteBuffers(1, &renderer.vbo);
+    glDeleteBuffers(1, &renderer.ebo);
+    glDeleteTextures(1, &renderer.texture);
+    deleteVariants(renderer);
+    glDeleteBuffers(1, &renderer.materialUbo);
+    destroyUniformRing(renderer.uniformRing);
+    destroyColorGrading(renderer.colorGrading);
+    destroyStaticField(renderer.staticField);
+}
@@ -0,0 +1,295 @@
+#ifndef SCENE_RENDERER_H
+#define SCENE_RENDERER_H
+
+#include <GL/glew.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "scene_params.h"
+#include "sdf_scene.h"
+#include "static_field.h"
+#include "color_grading.h"
+#include "materials.h"
+#include "uniform_ring.h"
+#include "program_cache.h"
+#include "shader_compiler.h"
+#include "gpu_profiler.h"
+#include <chrono>
+#include <unordered_set>
+
+// Nombre d'évaluations de SDF exactes par pixel, mesuré avec le mode compteur du shader
+struct SdfCounterStats {
+    double meanEvaluations = 0.0;
+    int maxEvaluations = 0;
+    double meanPrimarySteps = 0.0; // Pas de marche du rayon primaire
+    double meanPrepassSteps = 0.0; // Pas de la pré-passe de cônes, rapportés à un pixel pleine résolution
+
+    // Pas de toute l'image : rayons primaires et rayons d'ombre de chaque pixel
+    long long totalPrimarySteps = 0;
+    long long totalShadowSteps = 0;
+    int maxPrimarySteps = 0;
+    int maxShadowSteps = 0;
+    double meanShadowSteps = 0.0;
+
+    // Rayons à court de pas : le budget STEPS ou SHADOW_STEPS est épuisé avant d'atteindre une surface ou la sortie
+    long long exhaustedPrimaryRays = 0;
+    long long exhaustedShadowRays = 0;
+};
+
+// Image qui vient d'être rendue comparée à une image de référence rendue hors écran avec les mêmes paramètres
+struct ImageComparison {
+    bool valid = false;
+    double psnr = 0.0;        // En dB, sur les composantes RGB 8 bits (99 si les images sont identiques)
+    double referenceMs = 0.0; // Temps GPU de l'image de référence
+    double renderedMs = 0.0;  // Temps GPU des passes de la dernière image chronométrée
+    double aliasedPsnr = 0.0; // Anticrénelage seulement : PSNR de l'image sans anticrénelage contre la même référence
+};
+
+// Nombre d'images dont les requêtes d'horodatage des passes différées sont en vol
+const int kDeferredTimingFrames = 4;
+// Horodatages par image : début, après la pré-passe de cônes, après la marche, l'éclairage, le repérage des
+// bords, les rayons supplémentaires des bords et les post-traitements
+const int kDeferredTimestamps = 7;
+
+// Texels par ligne de la cible compacte des couleurs des pixels de bord (EDGE_LIST_WIDTH dans le shader)
+const int kEdgeListWidth = 256;
+
+// Temps GPU de chaque passe du rendu différé, de la dernière image dont les requêtes sont revenues.
+// En damier, marchMs est la marche d'un pixel sur deux et shadingMs la reconstruction.
+struct DeferredPassTimings {
+    double prepassMs = 0.0;
+    double marchMs = 0.0;
+    double shadingMs = 0.0;
+    double edgeDetectMs = 0.0;  // Anticrénelage : repérage des bords
+    double supersampleMs = 0.0; // Anticrénelage : quatre rayons par pixel retenu
+    double postMs = 0.0;
+    long long samples = 0; // Nombre d'images chronométrées depuis la création du renderer
+};
+
+// Points de liaison des blocs uniformes de la scène (Materials utilise kMaterialsBinding)
+const GLuint kFrameUniformsBinding = 1;
+const GLuint kDrawUniformsBinding = 2;
+const GLuint kSceneAnimationBinding = 3;
+// Taille d'un segment de l'anneau des blocs uniformes, qui couvre plusieurs images
+const GLsizeiptr kUniformRingSegmentSize = 64 * 1024;
+
+// Shaders de la scène, relus quand ils sont modifiés sur le disque
+const char* const kSceneVertexShaderPath = "../src/shaders/vertex_shader.glsl";
+const char* const kSceneFragmentShaderPath = "../src/shaders/fragment_shader.glsl";
+const char* const kEdgePyramidShaderPath = "../src/shaders/edge_pyramid_fragment_shader.glsl";
+// Intervalle, en secondes, entre deux lectures des dates de modification des shaders
+const double kShaderWatchInterval = 0.5;
+
+// Variante compilée du programme de la scène. Les constantes passent par des blocs uniformes et
+// les unités de texture sont fixées à l'édition de liens : aucune location n'est conservée.
+struct SceneProgram {
+    GLuint program = 0;
+};
+
+// Temps CPU de soumission de renderScene() : écriture des blocs uniformes, liaisons et tracés
+struct SubmitTimings {
+    double lastMs = 0.0;
+    double totalMs = 0.0;
+    long long samples = 0;
+};
+
+// Sources régénérées dont la première variante est en cours de compilation sur le thread de compilation.
+// Elles ne remplacent celles du renderer qu'une fois cette variante liée.
+struct PendingSceneBuild {
+    bool active = false;
+    unsigned long long generation = 0;
+    unsigned variantKey = 0;
+    std::string vertexSource;
+    std::string fragmentSource;      // Fragment shader tel que lu sur le disque
+    std::string sceneFragmentSource; // Avec scene() générée
+    SdfGeneratedScene generated;
+};
+
+// Ressources OpenGL nécessaires au rendu de la scène en raymarching
+struct SceneRenderer {
+    // Variantes du programme compilées à la demande, par clé (shader_variants.h). Vidé quand scene() est
+    // régénérée ; activeVariant est la dernière variante utilisée.
+    std::unordered_map<unsigned, SceneProgram> programs;
+    unsigned activeVariant = 0;
+    std::string sceneFragmentSource; // Fragment shader avec scene() générée, avant les #define de la variante
+
+    // Compilation en arrière-plan (shader_compiler.h), fournie par l'appelant avant initSceneRenderer. Nulle :
+    // les variantes sont compilées sur le thread de rendu. La génération numérote les sources ; les programmes
+    // d'une génération remplacée sont écartés à leur retour.
+    ShaderCompiler* compiler = nullptr;
+    unsigned long long generation = 0;        // Génération des programmes de programs
+    unsigned long long generationCounter = 0;
+    PendingSceneBuild pendingBuild;
+    std::unordered_set<unsigned> requestedVariants; // Variantes demandées au thread pour la génération courante
+    std::string buildLog; // Journal de la dernière compilation échouée, affiché dans le panneau ImGui
+
+    // Rechargement à chaud des fichiers de shader
+    bool hotReloadEnabled = true;
+    ShaderFileWatcher shaderWatcher;
+    std::chrono::steady_clock::time_point lastShaderWatch;
+    std::chrono::steady_clock::time_point initStart;
+
+    // Binaires des variantes liées, relus au lancement suivant (program_cache.h) ; vide : pas de cache
+    std::string programCacheDirectory = "../cache";
+    ProgramCacheStats programCacheStats;
+
+    GLuint vao = 0, vbo = 0, ebo = 0;
+    GLuint texture = 0;
+
+    // Graphe de scène et sources à partir desquelles le programme est régénéré
+    SdfScene sceneGraph;
+    SdfGeneratedScene generatedScene;
+
+    // Champ de distance des objets statiques, précalculé ou relu dans le cache
+    StaticField staticField;
+    int staticFieldResolution = 64;
+    std::string staticFieldCacheDirectory = "../cache";
+    std::string vertexSource;
+    std::string fragmentSource;
+
+    // Table des matériaux, renvoyée dans le bloc uniforme Materials quand materialsDirty est levé
+    std::vector<Material> materials;
+    GLuint materialUbo = 0;
+    bool materialsDirty = true;
+
+    // Tampon en anneau des blocs FrameUniforms, DrawUniforms et SceneAnimation, mappé en persistance
+    UniformRing uniformRing;
+    std::vector<glm::vec4> animationStaging; // Contenu du bloc SceneAnimation, réutilisé d'une image à l'autre
+    SubmitTimings submitTimings;
+    GpuProfiler* profiler = nullptr; // Sections par passe (gpu_profiler.h), nul pour ne rien chronométrer
+
+    // LUT 3D de la sépia, du changement de teinte et de la correction gamma
+    ColorGrading colorGrading;
+
+    // Cible RG32F de la pré-passe de cônes : distance de départ et nombre de pas par tuile
+    GLuint coneFbo = 0;
+    GLuint coneTexture = 0;
+    int coneWidth = 0;
+    int coneHeight = 0;
+
+    // Taille de la cible finale, fixée par renderSceneDynamic(). Avec la résolution dynamique, l'image n'en couvre
+    // que le coin inférieur gauche : les cibles intermédiaires sont allouées à cette taille et rendues dans le même
+    // coin, pour ne pas être réallouées à chaque changement d'échelle.
+    int targetWidth = 0;
+    int targetHeight = 0;
+
+    // G-buffer du rendu différé : (distance, matériau) en RG32F et normale en RGBA16F, puis couleur éclairée
+    // en RGBA16F dans une seconde cible, relue par les post-traitements. gBufferWidth x gBufferHeight est la
+    // taille allouée.
+    GLuint gBufferFbo = 0;
+    GLuint gBufferSurface = 0;
+    GLuint gBufferNormal = 0;
+    GLuint shadedFbo = 0;
+    GLuint shadedColor = 0;
+    int gBufferWidth = 0;
+    int gBufferHeight = 0;
+
+    // Rendu en damier : couleur éclairée en RGBA16F et (distance, matériau) en RG32F d'un pixel sur deux, dans
+    // une cible en demi-largeur, puis image reconstruite dans deux cibles alternées : celle de l'image
+    // précédente sert d'historique, vue par la caméra historyMouse et historyFov à la taille historyResolution.
+    // checkerWidth x checkerHeight est la taille allouée.
+    GLuint checkerFbo = 0;
+    GLuint checkerColor = 0;
+    GLuint checkerSurface = 0;
+    GLuint historyFbo[2] = {};
+    GLuint historyColor[2] = {};
+    GLuint historySurface[2] = {};
+    int checkerWidth = 0;
+    int checkerHeight = 0;
+    int checkerParity = 0;
+    int historyIndex = 0; // Cible écrite par la dernière image en damier
+    bool historyValid = false;
+    glm::vec2 historyMouse = glm::vec2(0.0f);
+    glm::vec2 historyResolution = glm::vec2(1.0f);
+    float historyFov = 55.0f;
+
+    // Anticrénelage : pyramide des bords R32F (histopyramide), aux puissances de deux de la cible finale, construite
+    // par son propre programme. Le niveau 0 est le masque des pixels de bord, chaque niveau suivant somme 2x2 texels
+    // du précédent. Les quatre rayons de chaque pixel de bord sont moyennés dans edgeColor (RGBA16F, kEdgeListWidth
+    // texels par ligne) au texel de son rang dans la pyramide, d'où les post-traitements les reprennent. Rien n'est
+    // relu pour le rendu : seul le sommet, le nombre de pixels de bord, revient au CPU une image plus tard.
+    GLuint edgePyramidProgram = 0;
+    GLint edgePyramidPassLocation = -1;
+    GLint edgeImageSizeLocation = -1;
+    GLint edgeThresholdLocation = -1;
+    GLuint edgePyramidFbo = 0;
+    GLuint edgePyramid = 0;
+    int edgePyramidWidth = 0;
+    int edgePyramidHeight = 0;
+    int edgePyramidLevels = 0;
+    GLuint edgeColorFbo = 0;
+    GLuint edgeColor = 0;
+    int edgeColorRows = 0;   // Lignes de edgeColor tracées par l'image en cours
+    GLuint edgeCountBuffer = 0;
+    GLsync edgeCountFence = nullptr; // Lecture du sommet en vol
+    int edgeCountRead = -1;  // Dernier sommet relu, -1 avant la première lecture de ces cibles
+    int edgePixelCount = 0; // Pixels anticrénelés de la dernière image relue, 0 sans anticrénelage
+
+    // Horodatages GPU des passes différées ou du damier, relus quelques images plus tard sans attente
+    GLuint passQueries[kDeferredTimingFrames][kDeferredTimestamps] = {};
+    bool passQueryPending[kDeferredTimingFrames] = {};
+    int nextPassQuery = 0;
+    bool skipNextPassTiming = false;
+    DeferredPassTimings passTimings;
+
+    // Cible hors écran du mode compteur et des images de référence des comparaisons
+    GLuint counterFbo = 0;
+    GLuint counterColorBuffer = 0;
+    int counterWidth = 0;
+    int counterHeight = 0;
+};
+
+// Charge les shaders, la texture et le quad plein écran, et génère scene() depuis le graphe par défaut.
+// Un contexte OpenGL doit être courant.
+bool initSceneRenderer(SceneRenderer& renderer);
+
+// Régénère scene() depuis renderer.sceneGraph et remplace les variantes du programme par la variante active
+// recompilée, puis met à jour le champ statique. En cas d'échec de compilation, les anciennes variantes restent
+// en place et le journal est copié dans errorLog et renderer.buildLog. Avec renderer.compiler, la variante est
+// compilée en arrière-plan et remplace les anciennes dans updateSceneCompilation() ; les erreurs arrivent
+// alors dans renderer.buildLog.
+bool rebuildSceneProgram(SceneRenderer& renderer, std::string* errorLog = nullptr);
+
+// Relit les fichiers de shader de la scène et les recompile comme rebuildSceneProgram()
+bool reloadSceneShaders(SceneRenderer& renderer);
+
+// À appeler à chaque tour de la boucle de rendu : recharge les shaders modifiés sur le disque et installe
+// les programmes rendus par le thread de compilation. Renvoie vrai si une nouvelle image est nécessaire.
+bool updateSceneCompilation(SceneRenderer& renderer);
+
+// Vrai si la variante de params est prête. Sinon, elle est demandée au thread de compilation.
+bool sceneVariantReady(SceneRenderer& renderer, const SceneParams& params);
+
+// Dessine la scène dans le framebuffer actuellement lié, à la résolution donnée, précédée de la
+// pré-passe de cônes si params.conePrepassEnabled. La variante qui correspond à params est compilée à la
+// première utilisation puis réutilisée. Avec params.deferredEnabled, la marche, l'éclairage et
+// les post-traitements sont des passes séparées, chronométrées dans renderer.passTimings. Avec
+// params.checkerboardEnabled, un pixel sur deux est marché et les autres sont reprojetés depuis l'image précédente.
+// Avec params.antialiasing, les pixels de bord repérés dans le G-buffer reçoivent quatre rayons chacun.
+void renderScene(SceneRenderer& renderer, const SceneParams& params, int width, int height);
+
+// Relit le nombre de pixels anticrénelés dans renderer.edgePixelCount si la lecture en vol est terminée, sans
+// attendre le GPU. Le rendu le fait à chaque image ; après glFinish, le compte est celui de la dernière image.
+void updateEdgePixelCount(SceneRenderer& renderer);
+
+// Rend la scène en mode compteur dans une cible hors écran et relit le nombre d'évaluations SDF de chaque pixel.
+// Le framebuffer lié avant l'appel est restauré.
+SdfCounterStats countSdfEvaluations(SceneRenderer& renderer, const SceneParams& params, int width, int height);
+
+// Marche les rayons primaires de params vers le G-buffer, comme la première passe du rendu différé, et relit
+// (distance, matériau) de chaque pixel, ligne du bas en premier. Le framebuffer lié avant l'appel est restauré.
+bool readSceneSurface(SceneRenderer& renderer, const SceneParams& params, int width, int height,
+                      std::vector<float>& surface);
+
+// Compare l'image en damier qui vient d'être rendue dans le framebuffer lié, à width x height, avec l'image
+// complète rendue en une passe hors écran. Sans historique du damier, le résultat n'est pas valide.
+ImageComparison compareCheckerboard(SceneRenderer& renderer, const SceneParams& params, int width, int height);
+
+// Compare l'image anticrénelée qui vient d'être rendue dans le framebuffer lié avec le 4x SSAA de tous les pixels,
+// rendu hors écran et non chronométré dans renderer.passTimings, puis rend l'image sans anticrénelage pour
+// aliasedPsnr.
+ImageComparison compareEdgeAntialiasing(SceneRenderer& renderer, const SceneParams& params, int width, int height);
+
+void destroySceneRenderer(SceneRenderer& renderer);
+
+#endif
@@ -0,0 +1,609 @@
+#include "sdf_scene.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <utility>
+
+SdfTransform sdfTranslate(const glm::vec3& translation) {
+    SdfTransform transform;
+    transform.type = SdfTransform::Type::Translate;
+    transform.translation = translation;
+    return transform;
+}
+
+SdfTransform sdfTranslate(std::function<glm::vec3(const SceneParams&)> translation, const std::string& label) {
+    SdfTransform transform;
+    transform.type = SdfTransform::Type::Translate;
+    transform.animatedTranslation = std::move(translation);
+    transform.animationLabel = label;
+    return transform;
+}
+
+SdfTransform sdfRotate(SdfTransform::Type axis, float angle) {
+    SdfTransform transform;
+    transform.type = axis;
+    transform.angle = angle;
+    return transform;
+}
+
+SdfTransform sdfRotate(SdfTransform::Type axis, std::function<float(const SceneParams&)> angle, const std::string& label) {
+    SdfTransform transform;
+    transform.type = axis;
+    transform.animatedAngle = std::move(angle);
+    transform.animationLabel = label;
+    return transform;
+}
+
+SdfNode sdfGroup(const std::string& name) {
+    SdfNode node;
+    node.name = name;
+    node.isGroup = true;
+    return node;
+}
+
+SdfNode sdfPrimitive(const std::string& name, SdfPrimitive primitive, const glm::vec3& size, int materialId, float rounding) {
+    SdfNode node;
+    node.name = name;
+    node.primitive = primitive;
+    node.size = size;
+    node.materialId = materialId;
+    node.rounding = rounding;
+    return node;
+}
+
+const char* const kObjectPositionLabel = "objectPosition";
+
+SdfScene makeDefaultSdfScene() {
+    SdfScene scene;
+    scene.root = sdfGroup("Scène");
+    std::vector<SdfNode>& objects = scene.root.children;
+
+    objects.push_back(sdfPrimitive("Sphère centrale", SdfPrimitive::Sphere, glm::vec3(0.5f), 1));
+
+    // Mouvement elliptique autour de (0, 0.5, -0.5)
+    SdfNode sphere2 = sdfPrimitive("Sphère mobile", SdfPrimitive::Sphere, glm::vec3(0.3f), 5);
+    sphere2.transforms.push_back(sdfTranslate([](const SceneParams& params) {
+        return glm::vec3(-0.1f * std::cos(params.time), 0.5f - 0.1f * std::sin(params.time), -0.5f);
+    }, "ellipse(iTime)"));
+    objects.push_back(sphere2);
+
+    objects.push_back(sdfPrimitive("Sol", SdfPrimitive::Plane, glm::vec3(0.0f), 0));
+    objects.push_back(sdfPrimitive("Tore", SdfPrimitive::Torus, glm::vec3(1.0f, 0.2f, 0.0f), 3));
+
+    SdfNode cylinder = sdfPrimitive("Cylindre", SdfPrimitive::Cylinder, glm::vec3(0.3f, 0.2f, 0.0f), 4, 0.05f);
+    cylinder.transforms.push_back(sdfTranslate(glm::vec3(0.3f, 1.2f, 0.0f)));
+    cylinder.transforms.push_back(sdfRotate(SdfTransform::Type::RotateX, [](const SceneParams& params) {
+        return params.time * 0.3f;
+    }, "iTime * 0.3"));
+    objects.push_back(cylinder);
+
+    SdfNode texturedBox = sdfPrimitive("Boîte texturée", SdfPrimitive::Box, glm::vec3(0.3f, 0.1f, 0.3f), 2, 0.1f);
+    texturedBox.transforms.push_back(sdfTranslate(glm::vec3(0.8f, 0.5f, 0.3f)));
+    objects.push_back(texturedBox);
+
+    // Boîte en marbre pilotée par le panneau ImGui
+    SdfNode marbleBox = sdfPrimitive("Boîte en marbre", SdfPrimitive::Box, glm::vec3(0.3f, 0.3f, 0.05f), 6);
+    marbleBox.transforms.push_back(sdfTranslate([](const SceneParams& params) {
+        return params.objectPosition;
+    }, kObjectPositionLabel));
+    marbleBox.transforms.push_back(sdfRotate(SdfTransform::Type::RotateX, [](const SceneParams& params) {
+        return glm::radians(params.objectRotationX);
+    }, "objectRotationX"));
+    marbleBox.transforms.push_back(sdfRotate(SdfTransform::Type::RotateY, [](const SceneParams& params) {
+        return glm::radians(params.objectRotationY);
+    }, "objectRotationY"));
+    marbleBox.transforms.push_back(sdfRotate(SdfTransform::Type::RotateZ, [](const SceneParams& params) {
+        return glm::radians(params.objectRotationZ);
+    }, "objectRotationZ"));
+    objects.push_back(marbleBox);
+
+    return scene;
+}
+
+// Matrices identiques à celles de rotateX/Y/Z() dans le shader (glm et GLSL sont en colonnes)
+static glm::mat3 rotationMatrix(SdfTransform::Type axis, float angle) {
+    float s = std::sin(angle);
+    float c = std::cos(angle);
+    switch (axis) {
+    case SdfTransform::Type::RotateX:
+        return glm::mat3(1.0f, 0.0f, 0.0f,
+                         0.0f, c, -s,
+                         0.0f, s, c);
+    case SdfTransform::Type::RotateY:
+        return glm::mat3(c, 0.0f, s,
+                         0.0f, 1.0f, 0.0f,
+                         -s, 0.0f, c);
+    case SdfTransform::Type::RotateZ:
+        return glm::mat3(c, -s, 0.0f,
+                         s, c, 0.0f,
+                         0.0f, 0.0f, 1.0f);
+    default:
+        return glm::mat3(1.0f);
+    }
+}
+
+void appendTransform(SdfAffine& affine, const SdfTransform& transform, const SceneParams& params) {
+    if (transform.type == SdfTransform::Type::Translate) {
+        affine.offset -= transform.animatedTranslation ? transform.animatedTranslation(params) : transform.translation;
+    } else {
+        glm::mat3 rotation = rotationMatrix(transform.type, transform.animatedAngle ? transform.animatedAngle(params) : transform.angle);
+        affine.linear = rotation * affine.linear;
+        affine.offset = rotation * affine.offset;
+    }
+}
+
+SdfAffine composeTransforms(const std::vector<SdfTransform>& chain, const SceneParams& params) {
+    SdfAffine affine;
+    for (const SdfTransform& transform : chain) {
+        appendTransform(affine, transform, params);
+    }
+    return affine;
+}
+
+// Rayon de la sphère englobante locale, centrée à l'origine de la primitive
+static float localBoundRadius(const SdfNode& leaf) {
+    const glm::vec3& s = leaf.size;
+    switch (leaf.primitive) {
+    case SdfPrimitive::Sphere:
+        return s.x + leaf.rounding;
+    case SdfPrimitive::Box:
+        return glm::length(s) + leaf.rounding;
+    case SdfPrimitive::Torus:
+        return s.x + s.y + leaf.rounding;
+    case SdfPrimitive::Cylinder:
+        return std::sqrt(s.x * s.x + s.y * s.y) + leaf.rounding;
+    default:
+        return 0.0f;
+    }
+}
+
+// Demi-tailles de la boîte englobante locale alignée sur les axes
+static glm::vec3 localBoundHalfSize(const SdfNode& leaf) {
+    const glm::vec3& s = leaf.size;
+    switch (leaf.primitive) {
+    case SdfPrimitive::Sphere:
+        return glm::vec3(s.x + leaf.rounding);
+    case SdfPrimitive::Box:
+        return s + glm::vec3(leaf.rounding);
+    case SdfPrimitive::Torus:
+        return glm::vec3(s.x + s.y, s.y, s.x + s.y) + glm::vec3(leaf.rounding);
+    case SdfPrimitive::Cylinder:
+        return glm::vec3(s.x, s.y, s.x) + glm::vec3(leaf.rounding);
+    default:
+        return glm::vec3(0.0f);
+    }
+}
+
+// Centre de la primitive dans le repère monde : linear est orthonormée, donc inversée par sa transposée
+static glm::vec3 worldCenter(const SdfAffine& affine) {
+    return glm::transpose(affine.linear) * -affine.offset;
+}
+
+glm::vec3 animatedTransformValue(const SdfTransform& transform, const SceneParams& params) {
+    if (transform.type == SdfTransform::Type::Translate) {
+        return transform.animatedTranslation ? transform.animatedTranslation(params) : transform.translation;
+    }
+    float angle = transform.animatedAngle ? transform.animatedAngle(params) : transform.angle;
+    return glm::vec3(std::sin(angle), std::cos(angle), 0.0f);
+}
+
+glm::vec4 animatedObjectBound(const SdfFlatObject& object, const SceneParams& params) {
+    return glm::vec4(worldCenter(composeTransforms(object.chain, params)), localBoundRadius(object.leaf));
+}
+
+static void flattenNode(const SdfNode& node, std::vector<SdfTransform> chain, std::vector<SdfFlatObject>& objects) {
+    chain.insert(chain.end(), node.transforms.begin(), node.transforms.end());
+    if (node.isGroup) {
+        for (const SdfNode& child : node.children) {
+            flattenNode(child, chain, objects);
+        }
+        return;
+    }
+
+    SdfFlatObject object;
+    object.leaf = node;
+    object.chain = std::move(chain);
+    for (const SdfTransform& transform : object.chain) {
+        object.animated = object.animated || transform.isAnimated();
+    }
+    objects.push_back(std::move(object));
+}
+
+std::vector<SdfFlatObject> flattenScene(const SdfScene& scene) {
+    std::vector<SdfFlatObject> objects;
+    flattenNode(scene.root, {}, objects);
+    return objects;
+}
+
+glm::vec2 evaluatePrimitive(const SdfNode& leaf, const glm::vec3& p) {
+    const glm::vec3& s = leaf.size;
+    float d = 0.0f;
+    switch (leaf.primitive) {
+    case SdfPrimitive::Plane:
+        d = p.y;
+        break;
+    case SdfPrimitive::Sphere:
+        d = glm::length(p) - s.x;
+        break;
+    case SdfPrimitive::Box: {
+        glm::vec3 diff = glm::abs(p) - s;
+        d = glm::length(glm::max(diff, glm::vec3(0.0f))) + std::min(std::max(diff.x, std::max(diff.y, diff.z)), 0.0f);
+        break;
+    }
+    case SdfPrimitive::Torus:
+        d = glm::length(glm::vec2(glm::length(glm::vec2(p.x, p.z)) - s.x, p.y)) - s.y;
+        break;
+    case SdfPrimitive::Cylinder: {
+        float dX = glm::length(glm::vec2(p.x, p.z)) - s.x;
+        float dY = std::abs(p.y) - s.y;
+        d = glm::length(glm::vec2(std::max(dX, 0.0f), std::max(dY, 0.0f))) + std::min(std::max(dX, dY), 0.0f);
+        break;
+    }
+    }
+    return glm::vec2((float)leaf.materialId, d - leaf.rounding);
+}
+
+glm::vec2 evaluateObjects(const std::vector<SdfFlatObject>& objects, const glm::vec3& p, const SceneParams& params) {
+    glm::vec2 res(100.0f, 1e30f);
+    for (const SdfFlatObject& object : objects) {
+        SdfAffine affine = composeTransforms(object.chain, params);
+        glm::vec2 d = evaluatePrimitive(object.leaf, affine.linear * p + affine.offset);
+        if (d.y < res.y) {
+            res = d;
+        }
+    }
+    return res;
+}
+
+namespace {
+
+// Écriture décimale la plus courte qui relit exactement la même valeur, toujours avec un point
+std::string glslFloat(float value) {
+    if (value == 0.0f) {
+        value = 0.0f; // Pas de -0.0 dans le code généré
+    }
+    char buffer[32];
+    for (int precision = 1; precision <= 9; ++precision) {
+        std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        if (std::strtof(buffer, nullptr) == value) {
+            break;
+        }
+    }
+    std::string text = buffer;
+    if (text.find_first_of(".e") == std::string::npos) {
+        text += ".0";
+    }
+    return text;
+}
+
+std::string glslVec3(const glm::vec3& v) {
+    return "vec3(" + glslFloat(v.x) + ", " + glslFloat(v.y) + ", " + glslFloat(v.z) + ")";
+}
+
+std::string glslMat3(const glm::mat3& m) {
+    std::string text = "mat3(";
+    for (int column = 0; column < 3; ++column) {
+        for (int row = 0; row < 3; ++row) {
+            text += glslFloat(m[column][row]);
+            text += (column == 2 && row == 2) ? ")" : ", ";
+        }
+    }
+    return text;
+}
+
+bool isIdentity(const glm::mat3& m) {
+    for (int column = 0; column < 3; ++column) {
+        for (int row = 0; row < 3; ++row) {
+            if (std::abs(m[column][row] - (column == row ? 1.0f : 0.0f)) > 1e-6f) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool isZero(const glm::vec3& v) {
+    return v.x == 0.0f && v.y == 0.0f && v.z == 0.0f;
+}
+
+// Applique une transformation affine constante à l'expression point
+std::string applyAffine(const SdfAffine& affine, const std::string& point, bool& compound) {
+    if (isIdentity(affine.linear)) {
+        if (isZero(affine.offset)) {
+            return point;
+        }
+        compound = true;
+        return point + " - " + glslVec3(-affine.offset);
+    }
+    std::string expression = glslMat3(affine.linear) + " * " + (compound ? "(" + point + ")" : point);
+    compound = !isZero(affine.offset);
+    if (compound) {
+        expression += " + " + glslVec3(affine.offset);
+    }
+    return expression;
+}
+
+// Point exprimé dans le repère local de l'objet. Les suites de transformations statiques sont repliées
+// en une seule transformation affine constante ; chaque transformation animée lit son uniforme sdfTransformK.
+std::string localPointExpression(const SdfFlatObject& object, std::vector<SdfTransform>& animatedTransforms) {
+    std::string point = "p";
+    bool compound = false;
+    SdfAffine pending;
+    for (const SdfTransform& transform : object.chain) {
+        if (!transform.isAnimated()) {
+            appendTransform(pending, transform, SceneParams());
+            continue;
+        }
+
+        point = applyAffine(pending, point, compound);
+        pending = SdfAffine();
+
+        std::string uniform = "sdfTransform" + std::to_string(animatedTransforms.size());
+        animatedTransforms.push_back(transform);
+        switch (transform.type) {
+        case SdfTransform::Type::Translate:
+            point = point + " - " + uniform + ".xyz";
+            compound = true;
+            break;
+        case SdfTransform::Type::RotateX:
+            point = "rotateXSinCos(" + point + ", " + uniform + ".xy)";
+            compound = false;
+            break;
+        case SdfTransform::Type::RotateY:
+            point = "rotateYSinCos(" + point + ", " + uniform + ".xy)";
+            compound = false;
+            break;
+        case SdfTransform::Type::RotateZ:
+            point = "rotateZSinCos(" + point + ", " + uniform + ".xy)";
+            compound = false;
+            break;
+        }
+    }
+    return applyAffine(pending, point, compound);
+}
+
+std::string primitiveCall(const SdfNode& leaf, const std::string& point) {
+    std::string id = glslFloat((float)leaf.materialId);
+    const glm::vec3& s = leaf.size;
+    switch (leaf.primitive) {
+    case SdfPrimitive::Plane:
+        return "dPlane(" + point + ", 0.0, " + id + ")";
+    case SdfPrimitive::Sphere:
+        return "dSphere(" + point + ", " + glslFloat(s.x) + ", " + id + ")";
+    case SdfPrimitive::Box:
+        return "dBox(" + point + ", " + glslVec3(s) + ", " + id + ")";
+    case SdfPrimitive::Torus:
+        return "dTorus(" + point + ", " + glslFloat(s.x) + ", " + glslFloat(s.y) + ", " + id + ")";
+    case SdfPrimitive::Cylinder:
+        return "dCylinder(" + point + ", " + glslFloat(s.x) + ", " + glslFloat(s.y) + ", " + id + ")";
+    }
+    return "";
+}
+
+// Code des objets d'une fonction de scène : plans et sphères d'abord, moins chers que n'importe quel
+// volume englobant, puis les autres derrière leur volume englobant
+struct GeneratedObjects {
+    std::ostringstream cheap;
+    std::ostringstream bounded;
+    bool declareResult = true; // Le premier objet déclare res
+
+    std::string code() const {
+        std::string text = declareResult ? "    vec2 res = vec2(100.0, MAX_DIST + 10.0);\n\n" : "";
+        return text + cheap.str() + bounded.str();
+    }
+};
+
+} // namespace
+
+bool staticObjectBounds(const SdfFlatObject& object, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    if (object.animated || object.leaf.primitive == SdfPrimitive::Plane) {
+        return false;
+    }
+    SdfAffine affine = composeTransforms(object.chain, SceneParams());
+    glm::vec3 center = worldCenter(affine);
+    glm::vec3 half = isIdentity(affine.linear) ? localBoundHalfSize(object.leaf) : glm::vec3(localBoundRadius(object.leaf));
+    boundsMin = center - half;
+    boundsMax = center + half;
+    return true;
+}
+
+SdfGeneratedScene generateSceneGlsl(const SdfScene& scene, bool staticField) {
+    std::vector<SdfFlatObject> objects = flattenScene(scene);
+
+    SdfGeneratedScene generated;
+    std::ostringstream transformUniforms;
+    std::ostringstream boundUniforms;
+    std::ostringstream dynamicBounds;
+
+    // Avec le champ précalculé, les objets statiques vont dans staticScene() et scene() part de son résultat
+    GeneratedObjects staticObjects;
+    GeneratedObjects sceneObjects;
+    sceneObjects.declareResult = !staticField;
+
+    // Rendu hybride : les plans statiques et les sphères sont intersectés analytiquement dans analyticHit()
+    // et analyticShadow(), les autres objets sont regroupés dans nonAnalyticScene(), sans le champ précalculé
+    GeneratedObjects marchedObjects;
+    std::ostringstream analyticHits;
+    std::ostringstream analyticShadows;
+
+    const float big = 1e4f;
+    glm::vec3 staticMin(big), staticMax(-big);
+    bool unbounded = false;
+    bool hasGroundPlane = false;
+    float groundHeight = -big;
+
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const SdfFlatObject& object = objects[i];
+        const SdfNode& leaf = object.leaf;
+        SdfAffine affine = composeTransforms(object.chain, SceneParams());
+
+        size_t firstTransform = generated.animatedTransforms.size();
+        std::string call = primitiveCall(leaf, localPointExpression(object, generated.animatedTransforms));
+
+        int uniformIndex = -1;
+        if (object.animated) {
+            uniformIndex = (int)generated.animatedObjects.size();
+            generated.animatedObjects.push_back(object);
+            for (size_t k = firstTransform; k < generated.animatedTransforms.size(); ++k) {
+                const SdfTransform& transform = generated.animatedTransforms[k];
+                bool translation = transform.type == SdfTransform::Type::Translate;
+                transformUniforms << "    vec4 sdfTransform" << k << "; // " << leaf.name << " : "
+                                  << transform.animationLabel << (translation ? "\n" : " (sin, cos)\n");
+            }
+            boundUniforms << "    vec4 sdfBound" << uniformIndex << "; // " << leaf.name
+                          << " : centre et rayon de la sphère englobante\n";
+        }
+
+        // Contribution à sceneBounds() et au plan au sol de clipRay()
+        bool axisAligned = !object.animated && isIdentity(affine.linear);
+        if (leaf.primitive == SdfPrimitive::Plane) {
+            if (axisAligned) {
+                hasGroundPlane = true;
+                groundHeight = std::max(groundHeight, -affine.offset.y);
+            } else {
+                unbounded = true;
+            }
+        } else if (object.animated) {
+            std::string bound = "sdfBound" + std::to_string(uniformIndex);
+            dynamicBounds << "    bMin = min(bMin, " << bound << ".xyz - " << bound << ".w);\n";
+            dynamicBounds << "    bMax = max(bMax, " << bound << ".xyz + " << bound << ".w);\n";
+        } else {
+            glm::vec3 center = worldCenter(affine);
+            glm::vec3 half = axisAligned ? localBoundHalfSize(leaf) : glm::vec3(localBoundRadius(leaf));
+            staticMin = glm::min(staticMin, center - half);
+            staticMax = glm::max(staticMax, center + half);
+        }
+
+        std::string d = "d" + std::to_string(i);
+        auto evaluation = [&](const std::string& indent) {
+            std::string code = indent + "vec2 " + d + " = " + call + ";\n";
+            if (leaf.rounding != 0.0f) {
+                code += indent + d + ".y -= " + glslFloat(leaf.rounding) + ";\n";
+            }
+            return code + indent + "sdfEvaluations++;\n";
+        };
+
+        std::string comment = "    // " + leaf.name + (object.animated ? " (animé)" : "") + "\n";
+        auto emit = [&](GeneratedObjects& target) {
+            if (leaf.primitive == SdfPrimitive::Plane || leaf.primitive == SdfPrimitive::Sphere) {
+                target.cheap << comment << evaluation("    ");
+                target.cheap << (target.declareResult ? "    vec2 res = " + d + ";\n\n" : "    res = minVec2(" + d + ", res);\n\n");
+                target.declareResult = false;
+                return;
+            }
+
+            std::string boundTest;
+            if (object.animated) {
+                std::string bound = "sdfBound" + std::to_string(uniformIndex);
+                boundTest = "dBoundSphere(p, " + bound + ".xyz, " + bound + ".w)";
+            } else if (axisAligned) {
+                boundTest = "dBoundBox(p, " + glslVec3(worldCenter(affine)) + ", " + glslVec3(localBoundHalfSize(leaf)) + ")";
+            } else {
+                boundTest = "dBoundSphere(p, " + glslVec3(worldCenter(affine)) + ", " + glslFloat(localBoundRadius(leaf)) + ")";
+            }
+            target.bounded << comment;
+            target.bounded << "    if (!boundsEnabled || " << boundTest << " < res.y) {\n";
+            target.bounded << evaluation("        ");
+            target.bounded << "        res = minVec2(" << d << ", res);\n";
+            target.bounded << "    }\n\n";
+        };
+        emit(staticField && !object.animated ? staticObjects : sceneObjects);
+
+        // Sphère : centre et rayon, arrondi compris, constants ou lus dans sdfBoundK (la rotation ne la change pas).
+        // Plan statique : demi-espace dot(p, n) < h, n étant la deuxième ligne de la matrice orthonormée.
+        std::string id = glslFloat((float)leaf.materialId);
+        if (leaf.primitive == SdfPrimitive::Sphere) {
+            std::string bound = "sdfBound" + std::to_string(uniformIndex);
+            std::string center = object.animated ? bound + ".xyz" : glslVec3(worldCenter(affine));
+            std::string radius = object.animated ? bound + ".w" : glslFloat(localBoundRadius(leaf));
+            analyticHits << comment << "    res = minVec2(intersectSphere(r0, rD, " << center << ", " << radius << ", "
+                         << id << "), res);\n";
+            analyticShadows << comment << "    visibility = min(visibility, sphereVisibility(r0, rD, tMax, " << center
+                            << ", " << radius << "));\n";
+        } else if (leaf.primitive == SdfPrimitive::Plane && !object.animated) {
+            const glm::mat3& m = affine.linear;
+            std::string n = glslVec3(glm::vec3(m[0][1], m[1][1], m[2][1]));
+            std::string h = glslFloat(leaf.rounding - affine.offset.y);
+            analyticHits << comment << "    res = minVec2(intersectPlane(r0, rD, " << n << ", " << h << ", " << id
+                         << "), res);\n";
+            analyticShadows << comment << "    visibility = min(visibility, planeVisibility(r0, rD, tMax, " << n << ", "
+                            << h << "));\n";
+        } else {
+            emit(marchedObjects);
+        }
+    }
+
+    std::ostringstream glsl;
+    glsl << "// Code généré par generateSceneGlsl() depuis le graphe de scène\n\n";
+    // Un bloc vide n'est pas permis en GLSL : il n'est déclaré que s'il y a des objets animés
+    if (!generated.animatedObjects.empty()) {
+        glsl << "// Transformations puis volumes englobants animés, tous en vec4 pour un pas std140 de 16 octets\n";
+        glsl << "layout(std140) uniform SceneAnimation {\n";
+        glsl << transformUniforms.str() << boundUniforms.str();
+        glsl << "};\n\n";
+    }
+
+    if (staticField) {
+        glsl << "// Objets statiques, évalués analytiquement près des surfaces et hors du champ précalculé\n";
+        glsl << "vec2 staticScene(vec3 p) {\n";
+        glsl << staticObjects.code();
+        glsl << "    return res;\n}\n\n";
+    }
+
+    glsl << "vec2 scene(vec3 p) {\n";
+    if (staticField) {
+        glsl << "    float dStatic = staticFieldEnabled ? staticFieldDistance(p) : -1.0;\n";
+        glsl << "    vec2 res = dStatic >= 0.0 ? vec2(0.0, dStatic) : staticScene(p);\n\n";
+    }
+    glsl << sceneObjects.code();
+    glsl << "    return res;\n}\n\n";
+
+    glsl << "vec2 nonAnalyticScene(vec3 p) {\n";
+    glsl << marchedObjects.code();
+    glsl << "    return res;\n}\n\n";
+
+    glsl << "vec2 analyticHit(vec3 r0, vec3 rD) {\n";
+    glsl << "    vec2 res = vec2(100.0, MAX_DIST + 10.0);\n";
+    glsl << analyticHits.str();
+    glsl << "    return res;\n}\n\n";
+
+    glsl << "float analyticShadow(vec3 r0, vec3 rD, float tMax) {\n";
+    glsl << "    float visibility = 1.0;\n";
+    glsl << analyticShadows.str();
+    glsl << "    return visibility;\n}\n\n";
+
+    glsl << "void sceneBounds(out vec3 bMin, out vec3 bMax) {\n";
+    if (unbounded) {
+        // Un plan incliné ou animé n'a pas de boîte englobante : pas de découpage
+        glsl << "    bMin = vec3(" << glslFloat(-big) << ");\n";
+        glsl << "    bMax = vec3(" << glslFloat(big) << ");\n";
+    } else {
+        glsl << "    bMin = " << glslVec3(staticMin) << ";\n";
+        glsl << "    bMax = " << glslVec3(staticMax) << ";\n";
+        glsl << dynamicBounds.str();
+    }
+    glsl << "}\n\n";
+
+    glsl << "const bool sceneHasGroundPlane = " << (hasGroundPlane ? "true" : "false") << ";\n";
+    glsl << "const float sceneGroundHeight = " << glslFloat(hasGroundPlane ? groundHeight : 0.0f) << ";\n";
+
+    generated.glsl = glsl.str();
+    return generated;
+}
+
+bool spliceSceneGlsl(std::string& shaderSource, const std::string& sceneGlsl) {
+    const std::string beginMarker = "// @scene-begin";
+    const std::string endMarker = "// @scene-end";
+
+    size_t begin = shaderSource.find(beginMarker);
+    size_t end = shaderSource.find(endMarker);
+    if (begin == std::string::npos || end == std::string::npos || end < begin) {
+        return false;
+    }
+
+    begin += beginMarker.size();
+    shaderSource.replace(begin, end - begin, "\n" + sceneGlsl + "\n");
+    return true;
+}
@@ -0,0 +1,121 @@
+#ifndef SDF_SCENE_H
+#define SDF_SCENE_H
+
+#include <glm/glm.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+#include "scene_params.h"
+
+// Primitives disponibles, évaluées par les fonctions d* de fragment_shader.glsl
+enum class SdfPrimitive {
+    Plane,    // Demi-espace y < 0
+    Sphere,   // size.x = rayon
+    Box,      // size = demi-tailles
+    Torus,    // size.x = grand rayon, size.y = épaisseur
+    Cylinder  // size.x = rayon, size.y = demi-hauteur
+};
+
+// Transformation appliquée au point p avant l'évaluation d'un nœud, dans le même sens que
+// translate() et rotateX/Y/Z() du shader. Un paramètre animé est évalué sur le CPU à chaque image.
+struct SdfTransform {
+    enum class Type { Translate, RotateX, RotateY, RotateZ };
+
+    Type type = Type::Translate;
+    glm::vec3 translation = glm::vec3(0.0f);
+    float angle = 0.0f; // Radians
+
+    std::function<glm::vec3(const SceneParams&)> animatedTranslation;
+    std::function<float(const SceneParams&)> animatedAngle;
+    std::string animationLabel; // Affiché dans le panneau ImGui
+
+    bool isAnimated() const { return animatedTranslation || animatedAngle; }
+};
+
+SdfTransform sdfTranslate(const glm::vec3& translation);
+SdfTransform sdfTranslate(std::function<glm::vec3(const SceneParams&)> translation, const std::string& label);
+SdfTransform sdfRotate(SdfTransform::Type axis, float angle);
+SdfTransform sdfRotate(SdfTransform::Type axis, std::function<float(const SceneParams&)> angle, const std::string& label);
+
+// Nœud du graphe : une union de ses enfants, ou une primitive
+struct SdfNode {
+    std::string name;
+    bool isGroup = false;
+    std::vector<SdfTransform> transforms; // Appliquées dans l'ordre, après celles des parents
+    std::vector<SdfNode> children;
+
+    // Primitive
+    SdfPrimitive primitive = SdfPrimitive::Sphere;
+    glm::vec3 size = glm::vec3(0.5f);
+    float rounding = 0.0f; // Distance retranchée à la SDF
+    int materialId = 0;    // Identifiant renvoyé par scene() et lu par material()
+};
+
+SdfNode sdfGroup(const std::string& name);
+SdfNode sdfPrimitive(const std::string& name, SdfPrimitive primitive, const glm::vec3& size, int materialId, float rounding = 0.0f);
+
+struct SdfScene {
+    SdfNode root;
+};
+
+// Libellé de la translation animée qui suit SceneParams::objectPosition (déplaçable à la souris, voir scene_picking.h)
+extern const char* const kObjectPositionLabel;
+
+// Graphe équivalent à la scène écrite à la main dans fragment_shader.glsl
+SdfScene makeDefaultSdfScene();
+
+// Transformation affine p' = linear * p + offset, composition d'une chaîne de SdfTransform
+struct SdfAffine {
+    glm::mat3 linear = glm::mat3(1.0f);
+    glm::vec3 offset = glm::vec3(0.0f);
+};
+
+// Primitive du graphe aplati avec la chaîne complète de ses transformations
+struct SdfFlatObject {
+    SdfNode leaf;
+    std::vector<SdfTransform> chain;
+    bool animated = false;
+};
+
+// Aplatit le graphe dans l'ordre des unions, chaque primitive portant les transformations de ses parents
+std::vector<SdfFlatObject> flattenScene(const SdfScene& scene);
+
+// Boîte englobante monde d'un objet statique fini. Renvoie faux pour un plan ou un objet animé.
+bool staticObjectBounds(const SdfFlatObject& object, glm::vec3& boundsMin, glm::vec3& boundsMax);
+
+// Évaluation CPU des SDF, identique aux fonctions d* du shader. Renvoie (matériau, distance).
+glm::vec2 evaluatePrimitive(const SdfNode& leaf, const glm::vec3& p);
+glm::vec2 evaluateObjects(const std::vector<SdfFlatObject>& objects, const glm::vec3& p, const SceneParams& params);
+
+void appendTransform(SdfAffine& affine, const SdfTransform& transform, const SceneParams& params);
+SdfAffine composeTransforms(const std::vector<SdfTransform>& chain, const SceneParams& params);
+
+// Valeur de l'uniforme sdfTransformK d'une transformation animée : la translation,
+// ou (sin, cos, 0) de l'angle pour une rotation
+glm::vec3 animatedTransformValue(const SdfTransform& transform, const SceneParams& params);
+
+// Valeur de l'uniforme sdfBoundK d'un objet animé : centre et rayon de sa sphère englobante
+glm::vec4 animatedObjectBound(const SdfFlatObject& object, const SceneParams& params);
+
+// Code de la section @scene et paramètres de ses uniformes. Le bloc std140 SceneAnimation contient
+// les vec4 sdfTransform0..N-1 puis sdfBound0..M-1 : animatedTransforms[K] alimente sdfTransformK,
+// animatedObjects[K] alimente sdfBoundK
+struct SdfGeneratedScene {
+    std::string glsl;
+    std::vector<SdfTransform> animatedTransforms;
+    std::vector<SdfFlatObject> animatedObjects;
+};
+
+// Génère scene(), sceneBounds() et les constantes du plan au sol. Les suites de transformations
+// statiques sont repliées en une transformation affine constante ; chaque transformation animée
+// devient un uniforme calculé sur le CPU, sans trigonométrie à chaque pas de la marche.
+// Avec staticField, les objets statiques sont regroupés dans staticScene() et scene() lit d'abord
+// leur distance précalculée dans la texture 3D staticField (voir static_field.h).
+// Pour le rendu hybride, génère aussi analyticHit() et analyticShadow(), qui intersectent les plans statiques
+// et les sphères, et nonAnalyticScene(), qui ne contient que les autres objets.
+SdfGeneratedScene generateSceneGlsl(const SdfScene& scene, bool staticField = false);
+
+// Remplace la section comprise entre // @scene-begin et // @scene-end de shaderSource
+bool spliceSceneGlsl(std::string& shaderSource, const std::string& sceneGlsl);
+
+#endif
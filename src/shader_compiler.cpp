@@ -0,0 +1,263 @@
+#include "shader_compiler.h"
+#include "program_cache.h"
+#include <algorithm>
+#include <chrono>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Programme dont la compilation et l'édition de liens ont été lancées sans attendre leur fin
+struct PendingLink {
+    ShaderCompileJob job;
+    GLuint vertexShader = 0;
+    GLuint fragmentShader = 0;
+    GLuint program = 0;
+    bool rejectedFromCache = false;
+    Clock::time_point start;
+};
+
+GLuint startCompile(GLenum type, const std::string& source) {
+    GLuint shader = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+// Lance la compilation des deux étapes et l'édition de liens. Aucun état n'est lu : avec la compilation
+// parallèle, le pilote poursuit le travail sur ses propres threads.
+PendingLink startLink(const ShaderCompileJob& job) {
+    PendingLink link;
+    link.job = job;
+    link.start = Clock::now();
+    link.vertexShader = startCompile(GL_VERTEX_SHADER, job.vertexSource);
+    link.fragmentShader = startCompile(GL_FRAGMENT_SHADER, job.fragmentSource);
+    link.program = glCreateProgram();
+    glAttachShader(link.program, link.vertexShader);
+    glAttachShader(link.program, link.fragmentShader);
+    if (GLEW_ARB_get_program_binary) {
+        glProgramParameteri(link.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(link.program);
+    return link;
+}
+
+std::string shaderLog(GLuint shader, const char* stage) {
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status == GL_TRUE) {
+        return "";
+    }
+    GLint length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+    std::string log(std::max(length, 1), '\0');
+    glGetShaderInfoLog(shader, length, &length, &log[0]);
+    log.resize(std::max(length, 0));
+    return std::string(stage) + " shader:\n" + log;
+}
+
+// Lit l'état final d'une édition de liens terminée et remplit le résultat
+ShaderCompileResult finishLink(PendingLink& link, const std::string& cacheDirectory) {
+    ShaderCompileResult result;
+    result.generation = link.job.generation;
+    result.variantKey = link.job.variantKey;
+    result.rejectedFromCache = link.rejectedFromCache;
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(link.program, GL_LINK_STATUS, &linked);
+    if (linked == GL_TRUE) {
+        result.program = link.program;
+        if (!cacheDirectory.empty() && programBinarySupported()) {
+            saveCachedProgram(cacheDirectory, link.job.cacheKey, link.program);
+        }
+    } else {
+        result.log = shaderLog(link.vertexShader, "Vertex") + shaderLog(link.fragmentShader, "Fragment");
+        GLint length = 0;
+        glGetProgramiv(link.program, GL_INFO_LOG_LENGTH, &length);
+        if (length > 1) {
+            std::string log(length, '\0');
+            glGetProgramInfoLog(link.program, length, &length, &log[0]);
+            log.resize(std::max(length, 0));
+            result.log += "Link:\n" + log;
+        }
+        glDeleteProgram(link.program);
+    }
+    glDeleteShader(link.vertexShader);
+    glDeleteShader(link.fragmentShader);
+    result.milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - link.start).count();
+    return result;
+}
+
+bool linkCompleted(const PendingLink& link, bool parallelCompile) {
+    if (!parallelCompile) {
+        return true;
+    }
+    GLint completed = GL_FALSE;
+    glGetProgramiv(link.program, GL_COMPLETION_STATUS_KHR, &completed);
+    return completed == GL_TRUE;
+}
+
+void publishResult(ShaderCompiler& compiler, ShaderCompileResult result) {
+    // Le programme n'est visible du contexte de rendu qu'une fois les commandes de ce contexte exécutées
+    result.ready = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+    {
+        std::lock_guard<std::mutex> lock(compiler.mutex);
+        compiler.results.push_back(std::move(result));
+        --compiler.inFlight;
+    }
+    if (compiler.notify) {
+        compiler.notify();
+    }
+}
+
+void compilerLoop(ShaderCompiler& compiler) {
+    for (;;) {
+        std::vector<ShaderCompileJob> batch;
+        {
+            std::unique_lock<std::mutex> lock(compiler.mutex);
+            compiler.wake.wait(lock, [&]() { return compiler.stopping || !compiler.jobs.empty(); });
+            if (compiler.stopping) {
+                return;
+            }
+            batch.assign(compiler.jobs.begin(), compiler.jobs.end());
+            compiler.jobs.clear();
+        }
+
+        // Les binaires en cache sont relus tout de suite, les autres programmes sont lancés ensemble
+        std::vector<PendingLink> links;
+        for (const ShaderCompileJob& job : batch) {
+            Clock::time_point start = Clock::now();
+            bool rejected = false;
+            GLuint program = 0;
+            if (!compiler.cacheDirectory.empty() && programBinarySupported()) {
+                program = loadCachedProgram(compiler.cacheDirectory, job.cacheKey, &rejected);
+            }
+            if (program != 0) {
+                ShaderCompileResult result;
+                result.generation = job.generation;
+                result.variantKey = job.variantKey;
+                result.program = program;
+                result.fromCache = true;
+                result.milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                publishResult(compiler, std::move(result));
+                continue;
+            }
+            links.push_back(startLink(job));
+            links.back().rejectedFromCache = rejected;
+        }
+
+        while (!links.empty()) {
+            bool progressed = false;
+            for (size_t i = 0; i < links.size();) {
+                if (linkCompleted(links[i], compiler.parallelCompile)) {
+                    publishResult(compiler, finishLink(links[i], compiler.cacheDirectory));
+                    links.erase(links.begin() + i);
+                    progressed = true;
+                } else {
+                    ++i;
+                }
+            }
+            if (!progressed) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool startShaderCompiler(ShaderCompiler& compiler, std::function<void()> attachContext,
+                         std::function<void()> detachContext, std::function<void()> notify) {
+    compiler.notify = std::move(notify);
+    compiler.stopping = false;
+    compiler.worker = std::thread([&compiler, attachContext, detachContext]() {
+        attachContext();
+        // Laisser le pilote choisir son nombre de threads de compilation
+        if (GLEW_KHR_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+            compiler.parallelCompile = true;
+        } else if (GLEW_ARB_parallel_shader_compile) {
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+            compiler.parallelCompile = true;
+        }
+        compilerLoop(compiler);
+        detachContext();
+    });
+    return compiler.worker.joinable();
+}
+
+void submitShaderCompile(ShaderCompiler& compiler, ShaderCompileJob job) {
+    {
+        std::lock_guard<std::mutex> lock(compiler.mutex);
+        // Des sources plus récentes rendent inutiles les travaux plus anciens qui n'ont pas commencé
+        for (auto it = compiler.jobs.begin(); it != compiler.jobs.end();) {
+            if (it->generation < job.generation) {
+                it = compiler.jobs.erase(it);
+                --compiler.inFlight;
+            } else {
+                ++it;
+            }
+        }
+        compiler.jobs.push_back(std::move(job));
+        ++compiler.inFlight;
+    }
+    compiler.wake.notify_one();
+}
+
+std::vector<ShaderCompileResult> takeShaderCompileResults(ShaderCompiler& compiler) {
+    std::lock_guard<std::mutex> lock(compiler.mutex);
+    std::vector<ShaderCompileResult> results;
+    results.swap(compiler.results);
+    return results;
+}
+
+bool shaderCompilerBusy(ShaderCompiler& compiler) {
+    std::lock_guard<std::mutex> lock(compiler.mutex);
+    return compiler.inFlight > 0;
+}
+
+void stopShaderCompiler(ShaderCompiler& compiler) {
+    if (!compiler.worker.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(compiler.mutex);
+        compiler.stopping = true;
+        compiler.jobs.clear();
+    }
+    compiler.wake.notify_one();
+    compiler.worker.join();
+
+    for (ShaderCompileResult& result : takeShaderCompileResults(compiler)) {
+        if (result.ready) {
+            glDeleteSync(result.ready);
+        }
+        glDeleteProgram(result.program);
+    }
+    compiler.inFlight = 0;
+}
+
+void watchShaderFiles(ShaderFileWatcher& watcher, const std::vector<std::string>& paths) {
+    watcher.paths = paths;
+    watcher.writeTimes.assign(paths.size(), fs::file_time_type());
+    shaderFilesChanged(watcher);
+}
+
+bool shaderFilesChanged(ShaderFileWatcher& watcher) {
+    bool changed = false;
+    for (size_t i = 0; i < watcher.paths.size(); ++i) {
+        // Un fichier en cours d'enregistrement peut manquer un instant : il sera relu au prochain appel
+        std::error_code ec;
+        fs::file_time_type time = fs::last_write_time(watcher.paths[i], ec);
+        if (!ec && time != watcher.writeTimes[i]) {
+            watcher.writeTimes[i] = time;
+            changed = true;
+        }
+    }
+    return changed;
+}
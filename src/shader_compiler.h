@@ -0,0 +1,81 @@
+#ifndef SHADER_COMPILER_H
+#define SHADER_COMPILER_H
+
+#include <GL/glew.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Programme à compiler et lier sur le thread de compilation
+struct ShaderCompileJob {
+    unsigned long long generation = 0; // Génération des sources du renderer, pour écarter les résultats périmés
+    unsigned variantKey = 0;
+    std::string vertexSource;
+    std::string fragmentSource;
+    uint64_t cacheKey = 0;             // Clé du cache des programmes (program_cache.h)
+};
+
+// Programme rendu par le thread de compilation
+struct ShaderCompileResult {
+    unsigned long long generation = 0;
+    unsigned variantKey = 0;
+    GLuint program = 0;      // 0 si la compilation ou l'édition de liens a échoué
+    GLsync ready = nullptr;  // Fence posée après l'édition de liens, attendue avant la première utilisation
+    std::string log;         // Journal du compilateur et de l'éditeur de liens en cas d'échec
+    double milliseconds = 0.0;
+    bool fromCache = false;
+    bool rejectedFromCache = false;
+};
+
+// Thread de compilation avec son propre contexte OpenGL, partagé avec celui du rendu. Les programmes liés
+// sont relus par le thread de rendu sans bloquer. Avec GL_KHR_parallel_shader_compile, les programmes en
+// attente sont liés ensemble par les threads du pilote.
+struct ShaderCompiler {
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<ShaderCompileJob> jobs;          // Protégé par mutex
+    std::vector<ShaderCompileResult> results;   // Protégé par mutex
+    int inFlight = 0;                           // Travaux soumis et pas encore rendus, protégé par mutex
+    bool stopping = false;                      // Protégé par mutex
+    bool parallelCompile = false;               // Fixé au démarrage du thread
+    std::string cacheDirectory;                 // Cache des programmes, vide pour le désactiver
+    std::function<void()> notify;               // Appelé par le thread de compilation après chaque résultat
+};
+
+// Démarre le thread. attachContext rend courant sur ce thread un contexte partagé avec celui du rendu,
+// detachContext le libère avant la fin du thread. notify réveille la boucle de rendu (glfwPostEmptyEvent).
+bool startShaderCompiler(ShaderCompiler& compiler, std::function<void()> attachContext,
+                         std::function<void()> detachContext, std::function<void()> notify);
+
+// Ajoute un travail. Les travaux en file d'une génération plus ancienne sont abandonnés.
+void submitShaderCompile(ShaderCompiler& compiler, ShaderCompileJob job);
+
+// Résultats rendus depuis le dernier appel. La fence de chaque programme doit être attendue
+// (glWaitSync) avant son utilisation.
+std::vector<ShaderCompileResult> takeShaderCompileResults(ShaderCompiler& compiler);
+
+// Vrai tant qu'un travail est en file ou en cours
+bool shaderCompilerBusy(ShaderCompiler& compiler);
+
+// Arrête le thread et supprime les programmes rendus mais non relus. Le contexte du rendu doit être courant.
+void stopShaderCompiler(ShaderCompiler& compiler);
+
+// Dates de modification des fichiers de shader surveillés pour le rechargement à chaud
+struct ShaderFileWatcher {
+    std::vector<std::string> paths;
+    std::vector<std::filesystem::file_time_type> writeTimes;
+};
+
+void watchShaderFiles(ShaderFileWatcher& watcher, const std::vector<std::string>& paths);
+
+// Vrai si un fichier surveillé a été modifié depuis le dernier appel
+bool shaderFilesChanged(ShaderFileWatcher& watcher);
+
+#endif
@@ -0,0 +1,84 @@
+#include "shader_utils.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+// Fonction pour lire un fichier shader
+std::string readFile(const char* filePath) {
+    std::ifstream file(filePath);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return buffer.str();
+}
+
+// Fonction pour compiler un shader
+GLuint compileShader(GLenum type, const std::string& source, std::string* errorLog) {
+    GLuint shader = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+
+    int result;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &result);
+    if (result == GL_FALSE) {
+        int length;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        char* message = new char[length];
+        glGetShaderInfoLog(shader, length, &length, message);
+        // Avec errorLog, l'appelant affiche le journal lui-même (panneau ImGui)
+        if (errorLog) {
+            *errorLog += message;
+        } else {
+            std::cerr << "Failed to compile shader!" << std::endl;
+            std::cerr << message << std::endl;
+        }
+        delete[] message;
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+// Fonction pour créer un programme shader
+GLuint createShaderProgram(const std::string& vertexShader, const std::string& fragmentShader, std::string* errorLog) {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShader, errorLog);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentShader, errorLog);
+    if (vs == 0 || fs == 0) {
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        return 0;
+    }
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    // Le binaire lié peut être enregistré dans le cache des programmes (program_cache.h)
+    if (GLEW_ARB_get_program_binary) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(program);
+    glValidateProgram(program);
+
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    int result;
+    glGetProgramiv(program, GL_LINK_STATUS, &result);
+    if (result == GL_FALSE) {
+        int length;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        std::string message(length, '\0');
+        glGetProgramInfoLog(program, length, &length, &message[0]);
+        if (errorLog) {
+            *errorLog += message;
+        } else {
+            std::cerr << "Failed to link shader program!" << std::endl;
+            std::cerr << message << std::endl;
+        }
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
@@ -0,0 +1,17 @@
+#ifndef SHADER_UTILS_H
+#define SHADER_UTILS_H
+
+#include <GL/glew.h>
+#include <string>
+
+// Fonction pour lire un fichier shader
+std::string readFile(const char* filePath);
+
+// Fonction pour compiler un shader. Renvoie 0 en cas d'échec ; le journal est copié dans errorLog s'il est fourni,
+// sinon affiché sur la sortie d'erreur.
+GLuint compileShader(GLenum type, const std::string& source, std::string* errorLog = nullptr);
+
+// Fonction pour créer un programme shader. Renvoie 0 si la compilation ou l'édition de liens échoue.
+GLuint createShaderProgram(const std::string& vertexShader, const std::string& fragmentShader, std::string* errorLog = nullptr);
+
+#endif
@@ -0,0 +1,54 @@
+#include "shader_variants.h"
+#include "color_grading.h"
+#include <algorithm>
+
+const ShaderQualityTier kShaderQualityTiers[kShaderQualityTierCount] = {
+    { "Rapide", 64, 64 },
+    { "Normale", 100, 96 },
+    { "Fine", 160, 160 },
+};
+
+unsigned shaderVariantKey(const SceneParams& params) {
+    unsigned key = 0;
+    if (params.vignetteEnabled) {
+        key |= kVariantVignette;
+    }
+    if (params.gammaCorrectionEnabled) {
+        key |= kVariantGammaCorrection;
+    }
+    if (colorGradingActive(params)) {
+        key |= kVariantColorLut;
+    }
+    unsigned tier = (unsigned)std::clamp(params.qualityTier, 0, kShaderQualityTierCount - 1);
+    return key | (tier << kVariantQualityShift);
+}
+
+std::string shaderVariantDefines(unsigned key) {
+    const ShaderQualityTier& tier = kShaderQualityTiers[(key & kVariantQualityMask) >> kVariantQualityShift];
+    std::string defines;
+    defines += "#define STEPS " + std::to_string(tier.steps) + "\n";
+    defines += "#define SHADOW_STEPS " + std::to_string(tier.shadowSteps) + "\n";
+    if (key & kVariantVignette) {
+        defines += "#define VIGNETTE\n";
+    }
+    if (key & kVariantGammaCorrection) {
+        defines += "#define GAMMA_CORRECTION\n";
+    }
+    if (key & kVariantColorLut) {
+        defines += "#define COLOR_LUT\n";
+    }
+    return defines;
+}
+
+bool insertShaderDefines(std::string& source, const std::string& defines) {
+    size_t version = source.find("#version");
+    if (version == std::string::npos) {
+        return false;
+    }
+    size_t lineEnd = source.find('\n', version);
+    if (lineEnd == std::string::npos) {
+        return false;
+    }
+    source.insert(lineEnd + 1, defines);
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <string>
+#include "scene_params.h"
+
+// Clé d'une variante du fragment shader de la scène : la vignette, la lecture de la LUT d'étalonnage
+// (color_grading.h, qui contient sépia, teinte et gamma) et la correction gamma, dont dépend l'exposant de
+// la vignette, puis le niveau de qualité (nombre de pas de marche) sur deux bits. Changer la sépia ou la
+// teinte ne recalcule que la LUT.
+const unsigned kVariantVignette = 1u << 0;
+const unsigned kVariantGammaCorrection = 1u << 1;
+const unsigned kVariantColorLut = 1u << 2;
+const unsigned kVariantQualityShift = 3;
+const unsigned kVariantQualityMask = 3u << kVariantQualityShift;
+
+// Nombre de pas des rayons primaires et des rayons d'ombre pour chaque niveau de qualité
+struct ShaderQualityTier {
+    const char* name;
+    int steps;
+    int shadowSteps;
+};
+const int kShaderQualityTierCount = 3;
+extern const ShaderQualityTier kShaderQualityTiers[kShaderQualityTierCount];
+
+// Clé de la variante qui correspond aux post-traitements et au niveau de qualité de params
+unsigned shaderVariantKey(const SceneParams& params);
+
+// Lignes #define de la variante, à insérer après #version
+std::string shaderVariantDefines(unsigned key);
+
+// Insère defines après la ligne #version de source. Renvoie faux si la ligne est absente.
+bool insertShaderDefines(std::string& source, const std::string& defines);
+
+#endif
@@ -0,0 +1,47 @@
+#version 330 core
+
+out vec4 FragColor;
+
+// Pyramide des bords de l'anticrénelage (histopyramide) : le niveau 0 est le masque des pixels de bord, chaque
+// niveau suivant somme 2x2 texels du précédent. Programme à part du shader de la scène : ces passes ne font que
+// quelques lectures de texture par pixel.
+uniform int pyramidPass;          // 0 = repérage des bords (niveau 0), 1 = niveau suivant
+uniform sampler2D gBufferSurface; // (distance, matériau) du rayon primaire
+uniform sampler2D edgePyramid;    // Seul le niveau lu est visible (GL_TEXTURE_BASE_LEVEL), pas celui écrit
+uniform vec2 imageSize;           // Taille en pixels de l'image rendue
+uniform float edgeThreshold;      // Écart relatif de 1/distance au-delà duquel un pixel est un bord
+
+// Bord à anticréneler : un voisin direct voit un autre matériau, ou 1/distance s'écarte de plus de edgeThreshold
+// de la moyenne de ses deux voisins d'un même axe. 1/distance variant linéairement à l'écran sur un plan, les
+// surfaces planes vues en biais ne sont pas des bords.
+bool edgePixel(ivec2 pixel) {
+    ivec2 last = ivec2(imageSize) - 1;
+    vec2 center = texelFetch(gBufferSurface, pixel, 0).rg;
+    float inverse = 1.0 / center.x;
+    ivec2 axes[2] = ivec2[2](ivec2(1, 0), ivec2(0, 1));
+    for (int i = 0; i < 2; i++) {
+        vec2 a = texelFetch(gBufferSurface, clamp(pixel - axes[i], ivec2(0), last), 0).rg;
+        vec2 b = texelFetch(gBufferSurface, clamp(pixel + axes[i], ivec2(0), last), 0).rg;
+        if (a.y != center.y || b.y != center.y
+            || abs(1.0 / a.x + 1.0 / b.x - 2.0 * inverse) > 2.0 * edgeThreshold * inverse) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Compte d'un texel du niveau lu, nul hors du niveau quand l'une de ses dimensions est déjà 1
+float previousCount(ivec2 texel) {
+    return all(lessThan(texel, textureSize(edgePyramid, 0))) ? texelFetch(edgePyramid, texel, 0).r : 0.0;
+}
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    if (pyramidPass == 0) {
+        FragColor = vec4(edgePixel(pixel) ? 1.0 : 0.0);
+    } else {
+        ivec2 children = pixel * 2;
+        FragColor = vec4(previousCount(children) + previousCount(children + ivec2(1, 0))
+                         + previousCount(children + ivec2(0, 1)) + previousCount(children + ivec2(1, 1)));
+    }
+}
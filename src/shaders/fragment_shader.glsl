@@ -1,24 +1,109 @@
 #version 330 core
 
-out vec4 FragColor;
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out vec4 gBufferNormalOut; // Normale, écrite par la passe de marche du rendu différé ;
+                                                // (distance, matériau) pour les passes du damier
 
-uniform vec2 iResolution;
-uniform float iTime;
-uniform vec2 iMouse; 
 uniform sampler2D texture1;
-uniform float fov; // Uniform pour le champ de vision
-uniform vec3 objectPosition; // Uniform pour la position de l'objet
-uniform float objectRotationX; // Uniform pour la rotation de l'objet autour de X
-uniform float objectRotationY; // Uniform pour la rotation de l'objet autour de Y
-uniform float objectRotationZ; // Uniform pour la rotation de l'objet autour de Z
 
-uniform bool vignetteEnabled;
-uniform bool gammaCorrectionEnabled;
-uniform bool sepiaEnabled;
-uniform bool hueShiftEnabled;
+// Constantes de l'image, écrites d'un bloc par scene_renderer.cpp dans un tampon en anneau (uniform_ring.cpp).
+// L'ordre et le bourrage suivent FrameUniforms côté C++ : chaque vec3 est complété par un float.
+layout(std140) uniform FrameUniforms {
+    vec2 iResolution;
+    vec2 iMouse;
+    vec3 objectPosition;         // Position de l'objet
+    float iTime;
+    float fov;                   // Champ de vision, en radians
+    float objectRotationX;       // Rotations de l'objet, en radians
+    float objectRotationY;
+    float objectRotationZ;
+
+    // Distances des objets statiques précalculées dans une texture 3D (static_field.cpp)
+    vec3 staticFieldMin;
+    float staticFieldResolution;
+    vec3 staticFieldMax;
+    float staticFieldBand;       // En deçà, les SDF analytiques sont évaluées
+    float staticFieldMargin;     // Erreur maximale du filtrage trilinéaire
+
+    float shadowSoftness;        // Plus la valeur est grande, plus la pénombre est étroite
+    float colorLutRange;         // Couleur linéaire maximale couverte, la LUT est indexée par sqrt(col / colorLutRange)
+    float colorLutSize;
+
+    bool boundsEnabled;          // Volumes englobants et découpage des rayons primaires
+    bool softShadowsEnabled;     // Pénombre estimée pendant la marche d'ombre, sinon ombres dures
+    bool shadowsAllModels;       // Ombres portées aussi pour Phong, Blinn-Phong, toon et la boîte texturée
+    bool staticFieldEnabled;
+    bool coneDepthEnabled;       // Passe pleine résolution : les rayons primaires partent de coneDepth
+    int coneTileSize;            // Pré-passe de cônes : une distance de départ sûre par tuile de coneTileSize pixels
+    int materialCount;
+    float marchRelaxation;       // Facteur de sur-relaxation des rayons primaires, 1 = sphere tracing exact
+
+    // Rendu en damier : caméra de l'image précédente, dont l'image reconstruite sert d'historique
+    vec2 previousMouse;
+    vec2 previousResolution;     // Taille de l'image précédente, différente avec la résolution dynamique
+    float previousFov;
+    int checkerParity;           // Les pixels (x, y) marchés sont ceux où x + y + checkerParity est pair
+    bool checkerHistoryValid;    // Faux à la première image, ou après un changement de résolution
+
+    bool analyticIntersections;  // Rendu hybride : plans et sphères intersectés analytiquement, le reste marché
+    bool edgeAntialiasing;       // Anticrénelage : les post-traitements reprennent la couleur moyennée des pixels de bord
+    int edgePyramidTop;          // Dernier niveau (1x1) de edgePyramid, qui compte tous les pixels de bord
+    int edgeColorTexels;         // Texels de edgeColor tracés : les bords de rang supérieur gardent leur rayon
+};
+
+// Constantes propres à chaque tracé plein écran de l'image
+layout(std140) uniform DrawUniforms {
+    int deferredPass;            // Rendu différé : 0 = tout en une passe, 1 = marche vers le G-buffer, 2 = éclairage, 3 = post-traitements,
+                                 // 4 = marche et éclairage d'un pixel sur deux (damier), 5 = reconstruction du damier,
+                                 // 6 = quatre rayons par pixel (4x SSAA), 7 = quatre rayons par pixel de bord
+    bool conePrepass;            // Passe basse résolution : le pixel est une tuile, sortie (distance, pas)
+    bool sdfCounterEnabled;      // Mode compteur : le pixel encode le nombre d'évaluations SDF et de pas
+    int stepHeatmap;             // Carte de coût : 0 = image normale, 1 = pas primaires, 2 = pas d'ombre, 3 = total
+};
+
+// Les post-traitements (VIGNETTE, COLOR_LUT, GAMMA_CORRECTION) et STEPS / SHADOW_STEPS sont définis
+// par la variante compilée (shader_variants.cpp), insérés après #version
+
+// Sépia, changement de teinte et correction gamma précalculés sur le CPU (color_grading.cpp)
+uniform sampler3D colorLut;
+
+// Table des matériaux indexée par l'identifiant renvoyé par scene() (materials.cpp)
+#define MAX_MATERIALS 64
+#define LIGHTING_BASIC 0
+#define LIGHTING_TOON 1
+#define LIGHTING_PHONG 2
+#define LIGHTING_BLINN_PHONG 3
+#define LIGHTING_TEXTURED 4
+#define LIGHTING_MARBLE 5
+
+struct MaterialData {
+    vec4 albedo; // rgb
+    vec4 params; // x = modèle d'éclairage (LIGHTING_*), y = emplacement de texture (-1 : aucune), z = brillance
+};
+layout(std140) uniform Materials {
+    MaterialData materials[MAX_MATERIALS];
+};
+
+// Textures lues par les passes ; leurs unités sont fixées une fois pour toutes à l'édition de liens
+uniform sampler3D staticField;
+uniform sampler2D coneDepth;
+uniform sampler2D gBufferSurface; // (distance, matériau) du rayon primaire
+uniform sampler2D gBufferNormal;
+uniform sampler2D shadedColor;    // Couleur éclairée, avant post-traitements
+uniform sampler2D checkerColor;   // Damier de l'image, en demi-largeur : couleur éclairée
+uniform sampler2D checkerSurface; // et (distance, matériau)
+uniform sampler2D historyColor;   // Image reconstruite précédente : couleur éclairée
+uniform sampler2D historySurface; // et (distance, matériau)
+uniform sampler2D edgePyramid;    // Anticrénelage : masque des bords au niveau 0, puis sommes de 2x2 texels
+uniform sampler2D edgeColor;      // Couleurs moyennées des pixels de bord, dans l'ordre de la pyramide
 
 #define MAX_DIST 20.0
+#ifndef STEPS
 #define STEPS 100
+#endif
+#ifndef SHADOW_STEPS
+#define SHADOW_STEPS 96
+#endif
 #define PI 3.141592
 #define DEG2RAD 0.01745329251
 
@@ -53,6 +138,20 @@ vec3 rotateZ(vec3 p, float angle) {
     return rot * p;
 }
 
+// Rotations dont le sinus et le cosinus sont précalculés sur le CPU (sc = (sin, cos)),
+// mêmes matrices que rotateX/Y/Z
+vec3 rotateXSinCos(vec3 p, vec2 sc) {
+    return vec3(p.x, sc.y * p.y + sc.x * p.z, -sc.x * p.y + sc.y * p.z);
+}
+
+vec3 rotateYSinCos(vec3 p, vec2 sc) {
+    return vec3(sc.y * p.x - sc.x * p.z, p.y, sc.x * p.x + sc.y * p.z);
+}
+
+vec3 rotateZSinCos(vec3 p, vec2 sc) {
+    return vec3(sc.y * p.x + sc.x * p.y, -sc.x * p.x + sc.y * p.y, p.z);
+}
+
 vec2 dPlane(vec3 p, float h, float i) {
     return vec2(i, p.y - h);
 }
@@ -93,60 +192,291 @@ vec2 minVec2(vec2 a, vec2 b) {
     return a.y < b.y ? a : b;
 }
 
-vec2 scene(vec3 p) {
-    // Transformation de box2 et du cylindre
-    vec3 pBox2 = translate(p, objectPosition); // Utiliser la position de l'objet
-    vec3 pCylinder = translate(p, vec3(0.3, 1.2, 0));
+// Volumes englobants : minorants peu coûteux de la distance aux objets
+float dBoundSphere(vec3 p, vec3 c, float r) {
+    return length(p - c) - r;
+}
+
+float dBoundBox(vec3 p, vec3 c, vec3 s) {
+    vec3 diff = abs(p - c) - s;
+    return max(diff.x, max(diff.y, diff.z));
+}
+
+// Distance filtrée des objets statiques, minorée de l'erreur du filtrage.
+// Renvoie -1.0 hors du volume précalculé ou près d'une surface, où la SDF analytique prend le relais.
+float staticFieldDistance(vec3 p) {
+    vec3 uvw = (p - staticFieldMin) / (staticFieldMax - staticFieldMin);
+    if (any(lessThan(uvw, vec3(0.0))) || any(greaterThan(uvw, vec3(1.0)))) {
+        return -1.0;
+    }
+    // Les échantillons extrêmes sont aux centres des texels de bord
+    vec3 texCoord = (uvw * (staticFieldResolution - 1.0) + 0.5) / staticFieldResolution;
+    float d = textureLod(staticField, texCoord, 0.0).r;
+    return d > staticFieldBand ? d - staticFieldMargin : -1.0;
+}
+
+// Intersections analytiques du rendu hybride : (matériau, distance) du point d'entrée du rayon, (100, MAX_DIST + 10)
+// s'il n'y en a pas. Un rayon parti de l'intérieur touche à la distance 0, comme le sphere tracing.
+vec2 intersectPlane(vec3 r0, vec3 rD, vec3 n, float h, float i) {
+    float height = dot(r0, n) - h;
+    float speed = dot(rD, n);
+    if (height <= 0.0) {
+        return vec2(i, 0.0);
+    }
+    return speed < 0.0 ? vec2(i, -height / speed) : vec2(100.0, MAX_DIST + 10.0);
+}
+
+vec2 intersectSphere(vec3 r0, vec3 rD, vec3 c, float r, float i) {
+    vec3 oc = r0 - c;
+    float b = dot(oc, rD);
+    float e = dot(oc, oc) - r * r;
+    if (e <= 0.0) {
+        return vec2(i, 0.0);
+    }
+    float discriminant = b * b - e;
+    return b < 0.0 && discriminant >= 0.0 ? vec2(i, -b - sqrt(discriminant)) : vec2(100.0, MAX_DIST + 10.0);
+}
+
+// Visibilité le long d'un rayon d'ombre de longueur tMax : 0 si l'objet le coupe, sinon la pénombre
+// shadowSoftness * h / t de shadow(), prise là où elle est minimale pour un plan (au bout du rayon, h / t
+// y étant monotone) et au point le plus proche du centre pour une sphère
+float planeVisibility(vec3 r0, vec3 rD, float tMax, vec3 n, float h) {
+    if (intersectPlane(r0, rD, n, h, 0.0).y < tMax) {
+        return 0.0;
+    }
+    return softShadowsEnabled ? min(1.0, shadowSoftness * (dot(r0 + rD * tMax, n) - h) / tMax) : 1.0;
+}
 
-    // Rotation appliquée uniquement à box2 et au cylindre
-    pBox2 = rotateX(pBox2, objectRotationX); // Utiliser la rotation de l'objet autour de X
-    pBox2 = rotateY(pBox2, objectRotationY); // Utiliser la rotation de l'objet autour de Y
-    pBox2 = rotateZ(pBox2, objectRotationZ); // Utiliser la rotation de l'objet autour de Z
-    pCylinder = rotateX(pCylinder, iTime * 0.3);
+float sphereVisibility(vec3 r0, vec3 rD, float tMax, vec3 c, float r) {
+    if (intersectSphere(r0, rD, c, r, 0.0).y < tMax) {
+        return 0.0;
+    }
+    float t = min(dot(c - r0, rD), tMax);
+    if (!softShadowsEnabled || t <= 0.0) {
+        return 1.0;
+    }
+    return min(1.0, shadowSoftness * (length(r0 + rD * t - c) - r) / t);
+}
+
+// Nombre de SDF exactes évaluées et de pas de marche du pixel courant (mode compteur et carte de coût)
+int sdfEvaluations = 0;
+int marchSteps = 0;
+int shadowMarchSteps = 0;
+bool marchExhausted = false; // Le rayon primaire a épuisé STEPS sans toucher ni sortir
+int shadowExhausted = 0;     // Rayons d'ombre qui ont épuisé SHADOW_STEPS
+
+// @scene-begin
+// Cette section est remplacée par le code généré depuis le graphe de scène (sdf_scene.cpp).
+// Elle reste la version de référence de la scène par défaut.
+
+vec2 scene(vec3 p) {
+    // Les objets sont combinés du plus imbriqué au plus externe, dans l'ordre des minVec2 d'origine.
+    // Un objet n'est évalué que si son volume englobant est plus proche que le minimum courant :
+    // sinon sa distance exacte, supérieure au minorant, ne peut pas gagner le minVec2.
 
     // Mouvement elliptique pour sphere2
     vec3 pSphere2 = p - vec3(0.0, 0.5, -0.5);
     pSphere2.x += 0.1 * cos(iTime); // Mouvement sur l'axe X
     pSphere2.y += 0.1 * sin(iTime); // Mouvement sur l'axe Y
 
-    // Définition des objets avec transformations appliquées
-    vec2 dp = dPlane(p, 0.0, 0.0);
+    // Le plan et les sphères coûtent moins cher que n'importe quel volume englobant
     vec2 ds = dSphere(p - vec3(0.0, 0.0, 0.0), 0.5, 1.0);
     vec2 ds2 = dSphere(pSphere2, 0.3, 5.0);
-    vec2 dT = dTorus(p, 1.0, 0.2, 3.0);
-    vec2 dC = dCylinder(pCylinder, 0.3, 0.2, 4.0);
-    vec2 dB = dBox(p - vec3(0.8, 0.5, 0.3), vec3(0.3, 0.1, 0.3), 2.0);
-    vec2 dMarbleBox = dBox(pBox2, vec3(0.3, 0.3, 0.05), 6.0);
-    
-    dB.y -= 0.1;
-    dC.y -= 0.05;
+    vec2 dp = dPlane(p, 0.0, 0.0);
+    sdfEvaluations += 3;
+
+    vec2 res = minVec2(dp, minVec2(ds, ds2));
 
-    return minVec2(dMarbleBox, minVec2(dB, minVec2(dC, minVec2(dT, minVec2(dp, minVec2(ds, ds2))))));
+    // Tore : boîte de demi-taille (1.2, 0.2, 1.2)
+    if (!boundsEnabled || dBoundBox(p, vec3(0.0), vec3(1.2, 0.2, 1.2)) < res.y) {
+        vec2 dT = dTorus(p, 1.0, 0.2, 3.0);
+        sdfEvaluations++;
+        res = minVec2(dT, res);
+    }
+
+    // Cylindre en rotation autour de son centre : sphère de rayon length(0.3, 0.2) + 0.05
+    if (!boundsEnabled || dBoundSphere(p, vec3(0.3, 1.2, 0.0), 0.42) < res.y) {
+        vec3 pCylinder = translate(p, vec3(0.3, 1.2, 0));
+        pCylinder = rotateX(pCylinder, iTime * 0.3);
+        vec2 dC = dCylinder(pCylinder, 0.3, 0.2, 4.0);
+        dC.y -= 0.05;
+        sdfEvaluations++;
+        res = minVec2(dC, res);
+    }
+
+    // Boîte texturée arrondie de 0.1
+    if (!boundsEnabled || dBoundBox(p, vec3(0.8, 0.5, 0.3), vec3(0.4, 0.2, 0.4)) < res.y) {
+        vec2 dB = dBox(p - vec3(0.8, 0.5, 0.3), vec3(0.3, 0.1, 0.3), 2.0);
+        dB.y -= 0.1;
+        sdfEvaluations++;
+        res = minVec2(dB, res);
+    }
+
+    // Boîte en marbre : sphère de rayon length(0.3, 0.3, 0.05), les trois rotations ne sont calculées qu'à proximité
+    if (!boundsEnabled || dBoundSphere(p, objectPosition, 0.43) < res.y) {
+        vec3 pBox2 = translate(p, objectPosition); // Utiliser la position de l'objet
+        pBox2 = rotateX(pBox2, objectRotationX); // Utiliser la rotation de l'objet autour de X
+        pBox2 = rotateY(pBox2, objectRotationY); // Utiliser la rotation de l'objet autour de Y
+        pBox2 = rotateZ(pBox2, objectRotationZ); // Utiliser la rotation de l'objet autour de Z
+        vec2 dMarbleBox = dBox(pBox2, vec3(0.3, 0.3, 0.05), 6.0);
+        sdfEvaluations++;
+        res = minVec2(dMarbleBox, res);
+    }
+
+    return res;
 }
 
-vec2 march(vec3 r0, vec3 rD) {
+// Rendu hybride : objets sans intersection analytique, seuls marchés. Sans le champ précalculé, qui contient
+// aussi le sol et la sphère centrale.
+vec2 nonAnalyticScene(vec3 p) {
+    vec2 res = vec2(100.0, MAX_DIST + 10.0);
+
+    if (!boundsEnabled || dBoundBox(p, vec3(0.0), vec3(1.2, 0.2, 1.2)) < res.y) {
+        vec2 dT = dTorus(p, 1.0, 0.2, 3.0);
+        sdfEvaluations++;
+        res = minVec2(dT, res);
+    }
+
+    if (!boundsEnabled || dBoundSphere(p, vec3(0.3, 1.2, 0.0), 0.42) < res.y) {
+        vec3 pCylinder = translate(p, vec3(0.3, 1.2, 0));
+        pCylinder = rotateX(pCylinder, iTime * 0.3);
+        vec2 dC = dCylinder(pCylinder, 0.3, 0.2, 4.0);
+        dC.y -= 0.05;
+        sdfEvaluations++;
+        res = minVec2(dC, res);
+    }
+
+    if (!boundsEnabled || dBoundBox(p, vec3(0.8, 0.5, 0.3), vec3(0.4, 0.2, 0.4)) < res.y) {
+        vec2 dB = dBox(p - vec3(0.8, 0.5, 0.3), vec3(0.3, 0.1, 0.3), 2.0);
+        dB.y -= 0.1;
+        sdfEvaluations++;
+        res = minVec2(dB, res);
+    }
+
+    if (!boundsEnabled || dBoundSphere(p, objectPosition, 0.43) < res.y) {
+        vec3 pBox2 = translate(p, objectPosition);
+        pBox2 = rotateX(pBox2, objectRotationX);
+        pBox2 = rotateY(pBox2, objectRotationY);
+        pBox2 = rotateZ(pBox2, objectRotationZ);
+        vec2 dMarbleBox = dBox(pBox2, vec3(0.3, 0.3, 0.05), 6.0);
+        sdfEvaluations++;
+        res = minVec2(dMarbleBox, res);
+    }
+
+    return res;
+}
+
+// Plus proche intersection analytique du rayon : (matériau, distance)
+vec2 analyticHit(vec3 r0, vec3 rD) {
+    vec2 res = vec2(100.0, MAX_DIST + 10.0);
+    res = minVec2(intersectSphere(r0, rD, vec3(0.0), 0.5, 1.0), res);
+    res = minVec2(intersectSphere(r0, rD, vec3(-0.1 * cos(iTime), 0.5 - 0.1 * sin(iTime), -0.5), 0.3, 5.0), res);
+    res = minVec2(intersectPlane(r0, rD, vec3(0.0, 1.0, 0.0), 0.0, 0.0), res);
+    return res;
+}
+
+// Visibilité de la lumière à travers les objets intersectés analytiquement
+float analyticShadow(vec3 r0, vec3 rD, float tMax) {
+    float visibility = 1.0;
+    visibility = min(visibility, sphereVisibility(r0, rD, tMax, vec3(0.0), 0.5));
+    visibility = min(visibility, sphereVisibility(r0, rD, tMax, vec3(-0.1 * cos(iTime), 0.5 - 0.1 * sin(iTime), -0.5), 0.3));
+    visibility = min(visibility, planeVisibility(r0, rD, tMax, vec3(0.0, 1.0, 0.0), 0.0));
+    return visibility;
+}
+
+// Boîte englobant tous les objets finis ; la boîte en marbre suit objectPosition
+void sceneBounds(out vec3 bMin, out vec3 bMax) {
+    bMin = min(vec3(-1.25, -0.55, -1.25), objectPosition - vec3(0.43));
+    bMax = max(vec3(1.25, 1.7, 1.25), objectPosition + vec3(0.43));
+}
+
+// Plan au sol horizontal utilisé par clipRay
+const bool sceneHasGroundPlane = true;
+const float sceneGroundHeight = 0.0;
+
+// @scene-end
+
+// Distance marchée : toute la scène, ou en rendu hybride les seuls objets sans intersection analytique
+vec2 marchScene(vec3 p) {
+    return analyticIntersections ? nonAnalyticScene(p) : scene(p);
+}
+
+// Marche entre tMin et tMax : au-delà de tMax le rayon est considéré comme sorti de la scène.
+// Avec marchRelaxation > 1, chaque pas est allongé de ce facteur (sphere tracing sur-relaxé) : tant que les
+// sphères vides de deux points successifs se recouvrent, aucune surface n'a été franchie entre eux. Sinon le
+// rayon revient au pas exact depuis le point précédent et finit sa marche sans relaxation.
+vec2 marchRange(vec3 r0, vec3 rD, float tMin, float tMax) {
     vec3 cP = r0;
-    float d = 0.0;
+    float d = tMin;
     vec2 s = vec2(0.0);
+    float omega = marchRelaxation;
+    float previousRadius = 0.0;
+    float stepLength = 0.0;
+    bool hit = false;
 
     for (int i = 0; i < STEPS; i++) {
         cP = r0 + rD * d;
-        s = scene(cP);
-        d += s.y;
+        s = marchScene(cP);
+        marchSteps++;
+
+        if (omega > 1.0 && s.y + previousRadius < stepLength) {
+            d -= stepLength - previousRadius;
+            stepLength = previousRadius;
+            omega = 1.0;
+            continue;
+        }
+        stepLength = s.y * omega;
+        previousRadius = s.y;
 
         if (s.y < 0.001) {
+            d += s.y;
+            hit = true;
             break;
         }
 
-        if (d > MAX_DIST) {
+        // Sortie décidée sur le pas exact : un pas allongé au-delà de tMax peut encore revenir en arrière
+        if (d + s.y > tMax) {
             return vec2(100.0, MAX_DIST + 10.0);
         }
+        d += stepLength;
     }
+    marchExhausted = marchExhausted || !hit;
 
     s.y = d;
     return s;
 }
 
+vec2 march(vec3 r0, vec3 rD) {
+    return marchRange(r0, rD, 0.0, MAX_DIST);
+}
+
+// Découpe un rayon primaire aux limites de la scène : le plan au sol et la boîte englobante.
+// Renvoie faux si le rayon ne peut rien toucher.
+bool clipRay(vec3 r0, vec3 rD, out float tMin, out float tMax) {
+    vec3 bMin, bMax;
+    sceneBounds(bMin, bMax);
+
+    vec3 invD = 1.0 / rD;
+    vec3 t0 = (bMin - r0) * invD;
+    vec3 t1 = (bMax - r0) * invD;
+    vec3 tNear = min(t0, t1);
+    vec3 tFar = max(t0, t1);
+    float tEnter = max(max(tNear.x, tNear.y), max(tNear.z, 0.0));
+    float tExit = min(min(tFar.x, tFar.y), tFar.z);
+
+    bool hitsBox = tEnter <= tExit;
+    bool hitsPlane = sceneHasGroundPlane && rD.y < 0.0 && r0.y > sceneGroundHeight;
+    float tPlane = hitsPlane ? (sceneGroundHeight - r0.y) / rD.y : MAX_DIST;
+
+    if (!hitsBox && !hitsPlane) {
+        return false;
+    }
+
+    tMin = hitsBox ? min(tEnter, tPlane) : tPlane;
+    tMax = min(MAX_DIST, hitsBox ? max(tExit, hitsPlane ? tPlane : 0.0) + 0.01 : tPlane + 0.01);
+    return tMin < tMax;
+}
+
 vec3 normal(vec3 p) {
     float dp = scene(p).y;
 
@@ -159,19 +489,66 @@ vec3 normal(vec3 p) {
     return normalize(vec3(dx, dy, dz));
 }
 
-float basicLighting(vec3 p, vec3 n) {
-    vec3 lP = vec3(cos(iTime) * 2.0, 1.0, sin(iTime) * 2.0);
-    vec3 lD = lP - p;
-    vec3 lN = normalize(lD);
+// Rayon d'ombre : seule compte l'occlusion entre le point et la lumière, la marche s'arrête donc à tMax,
+// dès qu'une surface est touchée ou dès que la pénombre est noire, avec son propre budget de pas.
+// La pénombre est le minimum de shadowSoftness * h / t le long du rayon : un objet qui passe près du
+// rayon sans le couper assombrit d'autant plus qu'il en est proche et loin du point éclairé.
+// Renvoie la visibilité de la lumière, de 0 (ombre) à 1 (éclairé).
+// En rendu hybride, la pénombre part de celle des objets intersectés analytiquement.
+float shadow(vec3 r0, vec3 rD, float tMax) {
+    float visibility = analyticIntersections ? analyticShadow(r0, rD, tMax) : 1.0;
+    if (visibility < 0.01) {
+        return 0.0;
+    }
+    float t = 0.0;
+
+    for (int i = 0; i < SHADOW_STEPS; i++) {
+        float h = marchScene(r0 + rD * t).y;
+        shadowMarchSteps++;
+        if (h < 0.001) {
+            return 0.0;
+        }
+        if (softShadowsEnabled) {
+            visibility = min(visibility, shadowSoftness * h / max(t, 0.001));
+            if (visibility < 0.01) {
+                return 0.0;
+            }
+        }
+        t += h;
+        if (t >= tMax) {
+            return visibility;
+        }
+    }
+
+    // Budget épuisé : le rayon longe une surface de trop près pour avancer, il est considéré comme bloqué
+    shadowExhausted++;
+    return 0.0;
+}
 
-    if (march(p + n * 0.01, lN).y < length(lD)) {
+// Visibilité de la lumière depuis un point de surface de normale n. Une face tournée à l'opposé
+// de la lumière n'en reçoit pas : aucun rayon n'est lancé.
+float lightVisibility(vec3 p, vec3 n, vec3 lightPos) {
+    vec3 lD = lightPos - p;
+    if (dot(n, lD) <= 0.0) {
         return 0.0;
     }
+    float lightDistance = length(lD);
+    return shadow(p + n * 0.01, lD / lightDistance, lightDistance);
+}
 
-    return max(0.0, dot(n, lN));
+// Visibilité utilisée par les modèles d'éclairage autres que basicLighting
+float modelShadow(vec3 p, vec3 n, vec3 lightPos) {
+    return shadowsAllModels ? lightVisibility(p, n, lightPos) : 1.0;
 }
 
-vec3 phongLighting(vec3 p, vec3 n, vec3 viewDir, vec3 materialColor) {
+float basicLighting(vec3 p, vec3 n) {
+    vec3 lP = vec3(cos(iTime) * 2.0, 1.0, sin(iTime) * 2.0);
+    vec3 lN = normalize(lP - p);
+
+    return lightVisibility(p, n, lP) * max(0.0, dot(n, lN));
+}
+
+vec3 phongLighting(vec3 p, vec3 n, vec3 viewDir, vec3 materialColor, float shininess) {
     vec3 lightPos = vec3(cos(iTime) * 2.0, 1.0, sin(iTime) * 2.0);
     vec3 lightColor = vec3(1.0, 1.0, 1.0);
     vec3 ambient = 0.1 * materialColor * lightColor;
@@ -181,13 +558,13 @@ vec3 phongLighting(vec3 p, vec3 n, vec3 viewDir, vec3 materialColor) {
     vec3 diffuse = diff * materialColor * lightColor;
 
     vec3 reflectDir = reflect(-lightDir, n);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
     vec3 specular = spec * lightColor; // Specular component is usually white
 
-    return (ambient + diffuse + specular);
+    return ambient + modelShadow(p, n, lightPos) * (diffuse + specular);
 }
 
-vec3 blinnPhongLighting(vec3 p, vec3 n, vec3 viewDir, vec3 materialColor) {
+vec3 blinnPhongLighting(vec3 p, vec3 n, vec3 viewDir, vec3 materialColor, float shininess) {
     vec3 lightPos = vec3(cos(iTime) * 2.0, 1.0, sin(iTime) * 2.0);
     vec3 lightColor = vec3(1.0, 1.0, 1.0);
     vec3 ambient = 0.1 * materialColor * lightColor;
@@ -197,10 +574,10 @@ vec3 blinnPhongLighting(vec3 p, vec3 n, vec3 viewDir, vec3 materialColor) {
     vec3 diffuse = diff * materialColor * lightColor;
 
     vec3 halfwayDir = normalize(lightDir + viewDir);
-    float spec = pow(max(dot(n, halfwayDir), 0.0), 32.0);
+    float spec = pow(max(dot(n, halfwayDir), 0.0), shininess);
     vec3 specular = spec * lightColor; // Specular component is usually white
 
-    return (ambient + diffuse + specular);
+    return ambient + modelShadow(p, n, lightPos) * (diffuse + specular);
 }
 
 vec3 toonLighting(vec3 p, vec3 n, vec3 viewDir, vec3 materialColor) {
@@ -209,7 +586,8 @@ vec3 toonLighting(vec3 p, vec3 n, vec3 viewDir, vec3 materialColor) {
 
     vec3 lightDir = normalize(lightPos - p);
     float diff = max(dot(n, lightDir), 0.0);
-    
+    diff *= diff > 0.25 ? modelShadow(p, n, lightPos) : 1.0; // Le niveau le plus sombre ne dépend pas de l'ombre
+
     // Toon shading: discrete levels
     if (diff > 0.5) {
         diff = 1.0;
@@ -232,41 +610,13 @@ vec3 marbleShader(vec3 p) {
     return color;
 }
 
-vec3 material(float i) {
-    vec3 col = vec3(0.0, 0.0, 0.0);
-
-    if (i < 0.5) {
-        col = vec3(1, 2, 2);
-    } else if (i < 1.5) {
-        col = vec3(1.0, 0.2, 0.3);
-    } else if (i < 2.5) {
-        col = vec3(0.3, 0.2, 5.0);
-    }
-    else if (i < 3.5) {
-        col = vec3(0.5, 0.2, 3.0);
-    }
-    else if (i < 4.5) {
-        col = vec3(0.3, 5.0, 5.0);
-    }
-    else if (i < 5.5) {
-        col = vec3(0.7, 0.7, 0.7); // Color for the second sphere
-    }
-    else if (i < 6.5) {
-        col = vec3(0.9, 0.9, 0.9); // Color for the glass box
-    }
-
-    return col * vec3(0.2);
-}
-
-void mainImage(out vec4 fragColor, in vec2 fragCoord) {
-    vec2 uv = (fragCoord - (iResolution.xy * 0.5)) / iResolution.y;
-
-    // Utilisez les coordonnées de la souris ici
-    vec2 mouse = iMouse / iResolution;
+// Caméra en orbite autour de la scène, placée par la souris (en pixels)
+void orbitCamera(vec2 mouse, out vec3 r0, out vec3 fwd, out vec3 side, out vec3 up) {
+    // Coordonnées de la souris normalisées par la résolution de leur image
 
     float initA = -DEG2RAD * 90.0;
 
-    vec3 r0 = vec3(
+    r0 = vec3(
         cos(mouse.x * 2.0 * PI + initA) * 2.0,
         mouse.y + 0.5,
         sin(mouse.x * 2.0 * PI + initA) * 2.0
@@ -274,35 +624,123 @@ void mainImage(out vec4 fragColor, in vec2 fragCoord) {
 
     vec3 target = vec3(0, 0.5, 0);
 
-    vec3 fwd = normalize(target - r0);
-    vec3 side = normalize(cross(vec3(0, 1.0, 0), fwd));
-    vec3 up = cross(fwd, side);
+    fwd = normalize(target - r0);
+    side = normalize(cross(vec3(0, 1.0, 0), fwd));
+    up = cross(fwd, side);
+}
+
+// Rayon primaire passant par fragCoord, en pixels de la résolution pleine
+void primaryRay(vec2 fragCoord, out vec3 r0, out vec3 rD) {
+    vec2 uv = (fragCoord - (iResolution.xy * 0.5)) / iResolution.y;
+
+    vec3 fwd, side, up;
+    orbitCamera(iMouse / iResolution, r0, fwd, side, up);
+
+    rD = normalize(tan(fov * 0.5) * fwd + side * uv.x + up * uv.y);
+}
+
+// Inverse de primaryRay() pour la caméra de l'image précédente : pixel où p était vu et position de cette
+// caméra. Faux si p était derrière la caméra ou hors de l'image.
+bool previousPixel(vec3 p, out vec2 fragCoord, out vec3 r0) {
+    vec3 fwd, side, up;
+    orbitCamera(previousMouse / previousResolution, r0, fwd, side, up);
+
+    vec3 q = p - r0;
+    float depth = dot(q, fwd);
+    if (depth <= 0.0) {
+        return false;
+    }
+    vec2 uv = tan(previousFov * 0.5) * vec2(dot(q, side), dot(q, up)) / depth;
+    fragCoord = uv * previousResolution.y + previousResolution * 0.5;
+    return all(greaterThanEqual(fragCoord, vec2(0.0))) && all(lessThan(fragCoord, previousResolution));
+}
+
+// Marche le cône qui contient tous les rayons de la tuile et renvoie (distance de départ sûre, pas).
+// Un rayon de la tuile est à au plus t * k du rayon central à la distance t, k étant la corde maximale
+// entre la direction centrale et celles des coins. Avancer de d - t * k garde donc chacun d'eux dans
+// la sphère vide de rayon d : aucune surface ne peut se trouver avant la distance renvoyée.
+vec2 coneMarch(vec2 tile) {
+    float size = float(coneTileSize);
+    vec2 corner = tile * size;
+    vec3 r0, rD;
+    primaryRay(corner + 0.5 * size, r0, rD);
+
+    float k = 0.0;
+    for (int i = 0; i < 4; i++) {
+        vec3 c0, cD;
+        primaryRay(corner + vec2(i & 1, i >> 1) * size, c0, cD);
+        k = max(k, length(cD - rD));
+    }
+
+    float t = 0.0;
+    int steps = 0;
+    for (int i = 0; i < STEPS; i++) {
+        float advance = scene(r0 + rD * t).y - t * k;
+        steps++;
+        // Le cône touche une surface : les pas suivants deviendraient de plus en plus courts
+        if (advance < 0.001 + 0.5 * t * k) {
+            break;
+        }
+        t += advance;
+        if (t > MAX_DIST) {
+            break;
+        }
+    }
+    return vec2(t, float(steps));
+}
 
-    vec3 rD = normalize(tan(fov * 0.5) * fwd + side * uv.x + up * uv.y);
+// Marche le rayon primaire du pixel et renvoie (matériau, distance). En rendu hybride, la marche s'arrête
+// à l'intersection analytique la plus proche, renvoyée si aucun objet marché n'est touché avant.
+vec2 tracePrimary(vec2 fragCoord, vec3 r0, vec3 rD) {
+    // Distance de départ fournie par la pré-passe de cônes
+    float tMin = coneDepthEnabled ? texelFetch(coneDepth, ivec2(fragCoord) / coneTileSize, 0).r : 0.0;
+    float tMax = MAX_DIST;
+    vec2 analytic = analyticIntersections ? analyticHit(r0, rD) : vec2(100.0, MAX_DIST + 10.0);
+
+    bool hit = true;
+    if (boundsEnabled) {
+        float tEnter, tExit;
+        hit = clipRay(r0, rD, tEnter, tExit);
+        tMin = max(tEnter, tMin);
+        tMax = tExit;
+    }
+    tMax = min(tMax, analytic.y);
+    vec2 s = hit && tMin < tMax ? marchRange(r0, rD, tMin, tMax) : vec2(100.0, MAX_DIST + 10.0);
+    return analyticIntersections && s.y >= MAX_DIST ? analytic : s;
+}
 
-    vec2 s = march(r0, rD);
+// Couleur éclairée du point touché, ou du ciel si s.y >= MAX_DIST. Le modèle d'éclairage, la couleur,
+// la texture et la brillance viennent de la table des matériaux.
+vec3 shadeSurface(vec2 uv, vec3 r0, vec3 rD, vec2 s, vec3 nor) {
     float d = s.y;
 
     vec3 sCol = vec3(0.5, 0.8, 1.0);
     vec3 col = mix(vec3(0.5, 0.8, 1.0), vec3(0.08, 0.3, 1.0), pow(uv.y + 0.5, 2.5));
 
     if (d < MAX_DIST) {
-        col = material(s.x);
+        // Un identifiant hors de la table donne un matériau noir éclairé par basicLighting
+        int id = int(s.x + 0.5);
+        vec4 albedo = vec4(0.0);
+        vec4 params = vec4(float(LIGHTING_BASIC), -1.0, 32.0, 0.0);
+        if (id >= 0 && id < materialCount) {
+            albedo = materials[id].albedo;
+            params = materials[id].params;
+        }
+        col = albedo.rgb;
+        int model = int(params.x);
+        float shininess = params.z;
+
         vec3 p = r0 + rD * d;
-        vec3 nor = normal(p);
+        vec3 viewDir = normalize(-rD);
         
-        if (s.x == 1.0) {
-            vec3 viewDir = normalize(-rD);
+        if (model == LIGHTING_TOON) {
             col = toonLighting(p, nor, viewDir, col);
-        } else if (s.x == 4.0) {
-            vec3 viewDir = normalize(-rD);
-            col = phongLighting(p, nor, viewDir, col);
-        } else if (s.x == 5.0) {
-            vec3 viewDir = normalize(-rD);
-            col = blinnPhongLighting(p, nor, viewDir, col);
-        } else if (s.x == 2.0) {
+        } else if (model == LIGHTING_PHONG) {
+            col = phongLighting(p, nor, viewDir, col, shininess);
+        } else if (model == LIGHTING_BLINN_PHONG) {
+            col = blinnPhongLighting(p, nor, viewDir, col, shininess);
+        } else if (model == LIGHTING_TEXTURED) {
             // Lighting with texture for the box
-            vec3 viewDir = normalize(-rD);
             vec3 lightPos = vec3(cos(iTime) * 2.0, 1.0, sin(iTime) * 2.0);
             vec3 lightColor = vec3(1.0, 1.0, 1.0);
             vec3 lightDir = normalize(lightPos - p);
@@ -311,10 +749,10 @@ void mainImage(out vec4 fragColor, in vec2 fragCoord) {
             vec3 diffuse = diff * lightColor;
 
             vec3 reflectDir = reflect(-lightDir, nor);
-            float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32.0);
+            float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
             vec3 specular = spec * lightColor; // Specular component is usually white
 
-            vec3 lighting = (0.1 * lightColor) + diffuse + specular;
+            vec3 lighting = (0.1 * lightColor) + modelShadow(p, nor, lightPos) * (diffuse + specular);
 
             vec2 texCoords;
             if (abs(nor.y) > 0.99) {
@@ -322,9 +760,11 @@ void mainImage(out vec4 fragColor, in vec2 fragCoord) {
             } else {
                 texCoords = vec2(mod(p.x + p.z, 1.0), mod(p.y, 1.0)); // Side faces
             }
-            col = texture(texture1, texCoords).rgb * lighting;
-        } else if (s.x == 6.0) {
-            col = marbleShader(p); // Appliquer le shader de marbre à la box2
+            // Sans texture, la couleur du matériau est éclairée de la même façon
+            vec3 base = params.y >= 0.0 ? texture(texture1, texCoords).rgb : col;
+            col = base * lighting;
+        } else if (model == LIGHTING_MARBLE) {
+            col = marbleShader(p);
         } else {
             float l = basicLighting(p, nor);
             vec3 a = vec3(5.0, 0.0, 10.0) * 0.03;
@@ -332,43 +772,270 @@ void mainImage(out vec4 fragColor, in vec2 fragCoord) {
             col = col * (a + l + aS);
         }
     }
+    return col;
+}
+
+vec3 postProcess(vec2 uv, vec3 col) {
+    // Post-traitements indépendants de la position : une lecture dans la LUT, entre les centres des texels extrêmes
+#ifdef COLOR_LUT
+    vec3 shaped = sqrt(clamp(col / colorLutRange, 0.0, 1.0));
+    col = texture(colorLut, shaped * ((colorLutSize - 1.0) / colorLutSize) + 0.5 / colorLutSize).rgb;
+#endif
+
+    // Post-traitement : vignette. Appliquée avant la correction gamma, elle en sort élevée à la même puissance
+#ifdef VIGNETTE
+    float vignette = smoothstep(0.8, 0.2, length(uv));
+#ifdef GAMMA_CORRECTION
+    vignette = pow(vignette, 1.0 / 2.2);
+#endif
+    col *= vignette;
+#endif
+    return col;
+}
+
+// Rampe bleu, cyan, vert, jaune, rouge pour une charge de 0 à 1
+vec3 heatColor(float x) {
+    x = clamp(x, 0.0, 1.0);
+    return clamp(vec3(1.5 - abs(4.0 * x - 3.0), 1.5 - abs(4.0 * x - 2.0), 1.5 - abs(4.0 * x - 1.0)), 0.0, 1.0);
+}
 
-    // Post-traitement : sépia
-    if (sepiaEnabled) {
-        vec3 sepiaColor = vec3(0.0);
-        sepiaColor.r = dot(col, vec3(0.393, 0.769, 0.189));
-        sepiaColor.g = dot(col, vec3(0.349, 0.686, 0.168));
-        sepiaColor.b = dot(col, vec3(0.272, 0.534, 0.131));
-        col = sepiaColor;
+// Carte de coût : pas du pixel rapportés au budget de la variante, magenta si un rayon a épuisé le sien
+vec3 stepHeatColor(int primarySteps) {
+    bool exhausted = (stepHeatmap != 2 && marchExhausted) || (stepHeatmap != 1 && shadowExhausted > 0);
+    if (exhausted) {
+        return vec3(1.0, 0.0, 1.0);
     }
+    if (stepHeatmap == 1) {
+        return heatColor(float(primarySteps) / float(STEPS));
+    }
+    if (stepHeatmap == 2) {
+        return heatColor(float(shadowMarchSteps) / float(SHADOW_STEPS));
+    }
+    return heatColor(float(primarySteps + shadowMarchSteps) / float(STEPS + SHADOW_STEPS));
+}
 
-    // Post-traitement : changement de teinte
-    if (hueShiftEnabled) {
-        float angle = 1.0; // Changez cette valeur pour ajuster la teinte
-        float s = sin(angle);
-        float c = cos(angle);
-        mat3 hueRotation = mat3(
-            vec3(0.213 + c * 0.787 - s * 0.213, 0.213 - c * 0.213 + s * 0.143, 0.213 - c * 0.213 - s * 0.787),
-            vec3(0.715 - c * 0.715 - s * 0.715, 0.715 + c * 0.285 + s * 0.140, 0.715 - c * 0.715 + s * 0.715),
-            vec3(0.072 - c * 0.072 + s * 0.928, 0.072 - c * 0.072 - s * 0.283, 0.072 + c * 0.928 + s * 0.072)
-        );
-        col = col * hueRotation;
+void mainImage(out vec4 fragColor, in vec2 fragCoord) {
+    vec2 uv = (fragCoord - (iResolution.xy * 0.5)) / iResolution.y;
+
+    vec3 r0, rD;
+    primaryRay(fragCoord, r0, rD);
+    vec2 s = tracePrimary(fragCoord, r0, rD);
+    int primarySteps = marchSteps;
+
+    vec3 nor = s.y < MAX_DIST ? normal(r0 + rD * s.y) : vec3(0.0, 1.0, 0.0);
+    vec3 col = shadeSurface(uv, r0, rD, s, nor);
+
+    // Damier et anticrénelage : couleur éclairée et surface du pixel, reconstruits ou moyennés avant les
+    // post-traitements
+    if (deferredPass == 4 || deferredPass == 6 || deferredPass == 7) {
+        fragColor = vec4(col, 1.0);
+        gBufferNormalOut = vec4(s.y, s.x, 0.0, 0.0);
+        return;
     }
+    col = postProcess(uv, col);
 
-    // Post-traitement : vignette
-    if (vignetteEnabled) {
-        float dist = length(uv);
-        col *= smoothstep(0.8, 0.2, dist);
+    fragColor = vec4(col.rgb, 1.0);
+
+    // Mode compteur, dans une cible flottante relue par le programme : évaluations SDF, pas du rayon
+    // primaire, pas des rayons d'ombre, et rayons à court de pas (1 pour le primaire + 2 par rayon d'ombre)
+    if (sdfCounterEnabled) {
+        fragColor = vec4(float(sdfEvaluations), float(primarySteps), float(shadowMarchSteps),
+                         float((marchExhausted ? 1 : 0) + 2 * shadowExhausted));
+    } else if (stepHeatmap != 0) {
+        fragColor = vec4(stepHeatColor(primarySteps), 1.0);
     }
+}
 
-    // Post-traitement : correction gamma
-    if (gammaCorrectionEnabled) {
-        col = pow(col, vec3(1.0 / 2.2));
+// Vrai si le pixel est marché dans l'image courante du damier
+bool checkerFresh(ivec2 pixel) {
+    return ((pixel.x + pixel.y + checkerParity) & 1) == 0;
+}
+
+// Échantillon marché au pixel du damier courant : la cible en demi-largeur garde un pixel par paire de colonnes
+void checkerSample(ivec2 pixel, out vec3 col, out vec2 surface) {
+    ivec2 texel = ivec2(pixel.x >> 1, pixel.y);
+    col = texelFetch(checkerColor, texel, 0).rgb;
+    surface = texelFetch(checkerSurface, texel, 0).rg;
+}
+
+// Couleur d'un pixel non marché. Ses quatre voisins directs le sont : leur moyenne sert de repli, et le plus
+// proche d'entre eux donne la surface vue par le pixel. Ce point est reprojeté dans l'image précédente, dont la
+// couleur est reprise si le matériau et la distance y concordent, bornée par les couleurs des voisins.
+vec3 reconstructPixel(vec2 fragCoord, out vec2 surface) {
+    ivec2 pixel = ivec2(fragCoord);
+    ivec2 last = ivec2(iResolution.xy) - 1;
+    // Au bord, le voisin manquant est remplacé par celui d'en face, lui aussi marché
+    ivec2 neighbours[4] = ivec2[4](
+        ivec2(pixel.x > 0 ? pixel.x - 1 : pixel.x + 1, pixel.y),
+        ivec2(pixel.x < last.x ? pixel.x + 1 : pixel.x - 1, pixel.y),
+        ivec2(pixel.x, pixel.y > 0 ? pixel.y - 1 : pixel.y + 1),
+        ivec2(pixel.x, pixel.y < last.y ? pixel.y + 1 : pixel.y - 1));
+
+    vec3 cMin = vec3(1e9);
+    vec3 cMax = vec3(-1e9);
+    vec3 cSum = vec3(0.0);
+    vec2 nearest = vec2(MAX_DIST + 10.0, 100.0);
+    for (int i = 0; i < 4; i++) {
+        vec3 col;
+        vec2 s;
+        checkerSample(clamp(neighbours[i], ivec2(0), last), col, s);
+        cMin = min(cMin, col);
+        cMax = max(cMax, col);
+        cSum += col;
+        if (s.x < nearest.x) {
+            nearest = s;
+        }
     }
+    surface = nearest;
+    vec3 spatial = cSum * 0.25;
 
-    fragColor = vec4(col.rgb, 1.0);
+    // Le ciel ne dépend que de la position à l'écran : rien à reprojeter
+    if (!checkerHistoryValid || nearest.x >= MAX_DIST) {
+        return spatial;
+    }
+
+    vec3 r0, rD;
+    primaryRay(fragCoord, r0, rD);
+    vec3 p = r0 + rD * nearest.x;
+    vec2 previous;
+    vec3 previousOrigin;
+    if (!previousPixel(p, previous, previousOrigin)) {
+        return spatial;
+    }
+
+    // Rejet des échantillons périmés : autre matériau, ou autre distance (surface découverte, objet déplacé)
+    ivec2 texel = ivec2(previous);
+    vec2 history = texelFetch(historySurface, texel, 0).rg;
+    float expected = length(p - previousOrigin);
+    if (history.y != nearest.y || abs(history.x - expected) > 0.02 + 0.02 * expected) {
+        return spatial;
+    }
+    return clamp(texelFetch(historyColor, texel, 0).rgb, cMin, cMax);
+}
+
+// Pyramide des bords (histopyramide, edge_pyramid_fragment_shader.glsl) : compaction des pixels de bord sur le
+// GPU, sans relecture ni compteur atomique. Le niveau 0 est le masque, en puissances de deux ; chaque niveau somme
+// 2x2 texels du précédent, parcourus dans l'ordre (0, 0), (1, 0), (0, 1), (1, 1). Ce même ordre donne le rang de
+// chaque pixel de bord, et donc son texel dans edgeColor.
+const int EDGE_LIST_WIDTH = 256; // Comme kEdgeListWidth : texels par ligne de edgeColor
+
+float edgePyramidCount(ivec2 texel, int level) {
+    return all(lessThan(texel, textureSize(edgePyramid, level))) ? texelFetch(edgePyramid, texel, level).r : 0.0;
+}
+
+// Pixel de bord de rang index, en descendant du sommet vers l'enfant dont les comptes le contiennent
+ivec2 edgePixelAt(int index) {
+    float remaining = float(index);
+    ivec2 texel = ivec2(0);
+    for (int level = edgePyramidTop - 1; level >= 0; level--) {
+        texel *= 2;
+        int child = 0;
+        for (; child < 3; child++) {
+            float count = edgePyramidCount(texel + ivec2(child & 1, child >> 1), level);
+            if (remaining < count) {
+                break;
+            }
+            remaining -= count;
+        }
+        texel += ivec2(child & 1, child >> 1);
+    }
+    return texel;
+}
+
+// Rang d'un pixel de bord : somme des comptes des texels qui le précèdent à chaque niveau
+int edgeRank(ivec2 pixel) {
+    float rank = 0.0;
+    ivec2 texel = pixel;
+    for (int level = 0; level < edgePyramidTop; level++) {
+        int position = (texel.x & 1) + 2 * (texel.y & 1);
+        for (int child = 0; child < position; child++) {
+            rank += edgePyramidCount((texel & ~1) + ivec2(child & 1, child >> 1), level);
+        }
+        texel /= 2;
+    }
+    return int(rank);
+}
+
+// Couleur éclairée du pixel, remplacée par ses quatre rayons moyennés s'il est un bord
+vec3 litPixel(ivec2 pixel) {
+    if (edgeAntialiasing && texelFetch(edgePyramid, pixel, 0).r > 0.0) {
+        int rank = edgeRank(pixel);
+        if (rank < edgeColorTexels) {
+            return texelFetch(edgeColor, ivec2(rank % EDGE_LIST_WIDTH, rank / EDGE_LIST_WIDTH), 0).rgb;
+        }
+    }
+    return texelFetch(shadedColor, pixel, 0).rgb;
+}
+
+// Passes du rendu différé : chacune relit la sortie de la précédente au même pixel
+void deferredMain(vec2 fragCoord) {
+    vec2 uv = (fragCoord - (iResolution.xy * 0.5)) / iResolution.y;
+    ivec2 pixel = ivec2(fragCoord);
+
+    if (deferredPass == 1) {
+        vec3 r0, rD;
+        primaryRay(fragCoord, r0, rD);
+        vec2 s = tracePrimary(fragCoord, r0, rD);
+        vec3 nor = s.y < MAX_DIST ? normal(r0 + rD * s.y) : vec3(0.0, 1.0, 0.0);
+        FragColor = vec4(s.y, s.x, 0.0, 0.0);
+        gBufferNormalOut = vec4(nor, 0.0);
+    } else if (deferredPass == 5) {
+        vec3 col;
+        vec2 surface;
+        if (checkerFresh(pixel)) {
+            checkerSample(pixel, col, surface);
+        } else {
+            col = reconstructPixel(fragCoord, surface);
+        }
+        FragColor = vec4(col, 1.0);
+        gBufferNormalOut = vec4(surface, 0.0, 0.0);
+    } else if (deferredPass == 2) {
+        vec3 r0, rD;
+        primaryRay(fragCoord, r0, rD);
+        vec2 surface = texelFetch(gBufferSurface, pixel, 0).rg;
+        vec3 nor = texelFetch(gBufferNormal, pixel, 0).xyz;
+        FragColor = vec4(shadeSurface(uv, r0, rD, vec2(surface.y, surface.x), nor), 1.0);
+    } else {
+        FragColor = vec4(postProcess(uv, litPixel(pixel)), 1.0);
+    }
 }
 
 void main() {
-    mainImage(FragColor, gl_FragCoord.xy);
+    if (conePrepass) {
+        FragColor = vec4(coneMarch(floor(gl_FragCoord.xy)), 0.0, 1.0);
+        return;
+    }
+    // Damier : le texel de la cible en demi-largeur est le pixel du damier courant de sa ligne. mainImage()
+    // n'est appelée qu'ici, pour que la marche et l'éclairage ne soient compilés qu'une fois.
+    vec2 fragCoord = gl_FragCoord.xy;
+    int samples = 1;
+    if (deferredPass == 4) {
+        ivec2 texel = ivec2(fragCoord);
+        fragCoord = vec2(2 * texel.x + ((texel.y + checkerParity) & 1), texel.y) + 0.5;
+    } else if (deferredPass == 7) {
+        // Anticrénelage : le texel de la cible compacte est le pixel de bord de même rang dans la pyramide
+        ivec2 texel = ivec2(fragCoord);
+        int index = texel.y * EDGE_LIST_WIDTH + texel.x;
+        if (float(index) >= texelFetch(edgePyramid, ivec2(0), edgePyramidTop).r) {
+            discard;
+        }
+        fragCoord = vec2(edgePixelAt(index)) + 0.5;
+        samples = 4;
+    } else if (deferredPass == 6) {
+        samples = 4;
+    } else if (deferredPass != 0) {
+        deferredMain(fragCoord);
+        return;
+    }
+
+    // Anticrénelage : quatre rayons en grille tournée, moyennés avant les post-traitements
+    const vec2 rotatedGrid[4] = vec2[4](vec2(0.125, 0.375), vec2(0.375, -0.125), vec2(-0.125, -0.375),
+                                        vec2(-0.375, 0.125));
+    vec4 color = vec4(0.0);
+    for (int i = 0; i < samples; i++) {
+        vec4 sampleColor;
+        mainImage(sampleColor, samples > 1 ? fragCoord + rotatedGrid[i] : fragCoord);
+        color += sampleColor;
+    }
+    FragColor = color / float(samples);
 }
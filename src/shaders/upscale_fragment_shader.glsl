@@ -0,0 +1,36 @@
+#version 330 core
+
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform sampler2D sceneColor; // Image rendue dans le coin inférieur gauche de la cible réduite
+uniform vec2 sourceSize;      // Taille en pixels de l'image rendue
+
+float luma(vec3 c) {
+    return dot(c, vec3(0.299, 0.587, 0.114));
+}
+
+// Interpolation bilinéaire des quatre texels voisins, dont les poids sont atténués quand leur luminance
+// s'écarte de celle du texel le plus proche : les dégradés restent lisses et les contours ne bavent pas.
+void main() {
+    vec2 pos = TexCoord * sourceSize - 0.5;
+    vec2 base = floor(pos);
+    vec2 f = pos - base;
+    ivec2 maxTexel = ivec2(sourceSize) - 1;
+
+    vec3 c00 = texelFetch(sceneColor, clamp(ivec2(base), ivec2(0), maxTexel), 0).rgb;
+    vec3 c10 = texelFetch(sceneColor, clamp(ivec2(base) + ivec2(1, 0), ivec2(0), maxTexel), 0).rgb;
+    vec3 c01 = texelFetch(sceneColor, clamp(ivec2(base) + ivec2(0, 1), ivec2(0), maxTexel), 0).rgb;
+    vec3 c11 = texelFetch(sceneColor, clamp(ivec2(base) + ivec2(1, 1), ivec2(0), maxTexel), 0).rgb;
+
+    vec2 nearest = step(0.5, f);
+    vec3 cNearest = mix(mix(c00, c10, nearest.x), mix(c01, c11, nearest.x), nearest.y);
+    float lNearest = luma(cNearest);
+
+    vec4 w = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+    vec4 l = vec4(luma(c00), luma(c10), luma(c01), luma(c11));
+    w *= 1.0 / (1.0 + 32.0 * abs(l - lNearest));
+
+    vec3 col = (c00 * w.x + c10 * w.y + c01 * w.z + c11 * w.w) / (w.x + w.y + w.z + w.w);
+    FragColor = vec4(col, 1.0);
+}
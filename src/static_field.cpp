@@ -0,0 +1,231 @@
+#include "static_field.h"
+#include "fnv1a.h"
+#include "cpu/thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// À incrémenter quand le contenu ou le format de la grille change
+static const uint32_t kStaticFieldFormatVersion = 1;
+static const char kStaticFieldMagic[4] = {'S', 'D', 'F', 'G'};
+
+// Marge autour des objets : les rayons entrent dans le volume avant d'approcher les surfaces
+static const float kStaticFieldPadding = 0.2f;
+
+std::vector<SdfFlatObject> staticObjects(const SdfScene& scene) {
+    std::vector<SdfFlatObject> objects = flattenScene(scene);
+    objects.erase(std::remove_if(objects.begin(), objects.end(),
+                                 [](const SdfFlatObject& object) { return object.animated; }),
+                  objects.end());
+    return objects;
+}
+
+bool staticFieldBounds(const std::vector<SdfFlatObject>& objects, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    bool finite = false;
+    boundsMin = glm::vec3(1e30f);
+    boundsMax = glm::vec3(-1e30f);
+    for (const SdfFlatObject& object : objects) {
+        glm::vec3 objectMin, objectMax;
+        if (staticObjectBounds(object, objectMin, objectMax)) {
+            boundsMin = glm::min(boundsMin, objectMin);
+            boundsMax = glm::max(boundsMax, objectMax);
+            finite = true;
+        }
+    }
+    if (!finite) {
+        return false;
+    }
+
+    // Un plan horizontal est inclus pour que les rayons rasants au sol profitent aussi du champ
+    for (const SdfFlatObject& object : objects) {
+        if (object.leaf.primitive == SdfPrimitive::Plane) {
+            SdfAffine affine = composeTransforms(object.chain, SceneParams());
+            float height = -affine.offset.y;
+            if (affine.linear[1][1] > 0.999f && height < boundsMin.y) {
+                boundsMin.y = height;
+            }
+        }
+    }
+
+    boundsMin -= glm::vec3(kStaticFieldPadding);
+    boundsMax += glm::vec3(kStaticFieldPadding);
+    return true;
+}
+
+namespace {
+
+std::string cachePath(const std::string& cacheDirectory, uint64_t hash) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "static_field_%016llx.bin", (unsigned long long)hash);
+    return (fs::path(cacheDirectory) / name).string();
+}
+
+} // namespace
+
+uint64_t staticFieldHash(const std::vector<SdfFlatObject>& objects, int resolution) {
+    Fnv1a hash;
+    hash.add(kStaticFieldFormatVersion);
+    hash.add(resolution);
+    for (const SdfFlatObject& object : objects) {
+        SdfAffine affine = composeTransforms(object.chain, SceneParams());
+        hash.add((int)object.leaf.primitive);
+        hash.add(object.leaf.size.x);
+        hash.add(object.leaf.size.y);
+        hash.add(object.leaf.size.z);
+        hash.add(object.leaf.rounding);
+        hash.add(object.leaf.materialId);
+        for (int column = 0; column < 3; ++column) {
+            hash.add(affine.linear[column].x);
+            hash.add(affine.linear[column].y);
+            hash.add(affine.linear[column].z);
+        }
+        hash.add(affine.offset.x);
+        hash.add(affine.offset.y);
+        hash.add(affine.offset.z);
+    }
+    return hash.value;
+}
+
+void bakeStaticField(const std::vector<SdfFlatObject>& objects, StaticFieldGrid& grid) {
+    int n = grid.resolution;
+    grid.distances.assign((size_t)n * n * n, 0.0f);
+
+    std::vector<SdfAffine> affines;
+    for (const SdfFlatObject& object : objects) {
+        affines.push_back(composeTransforms(object.chain, SceneParams()));
+    }
+
+    glm::vec3 step = (grid.boundsMax - grid.boundsMin) / (float)(n - 1);
+    std::vector<int> slices(n);
+    for (int z = 0; z < n; ++z) {
+        slices[z] = z;
+    }
+
+    cpu::WorkStealingPool pool((int)std::max(1u, std::thread::hardware_concurrency()));
+    pool.run(slices, [&](int z, int) {
+        float* slice = &grid.distances[(size_t)z * n * n];
+        for (int y = 0; y < n; ++y) {
+            for (int x = 0; x < n; ++x) {
+                glm::vec3 p = grid.boundsMin + step * glm::vec3((float)x, (float)y, (float)z);
+                float d = 1e30f;
+                for (size_t i = 0; i < objects.size(); ++i) {
+                    d = std::min(d, evaluatePrimitive(objects[i].leaf, affines[i].linear * p + affines[i].offset).y);
+                }
+                slice[y * n + x] = d;
+            }
+        }
+    });
+}
+
+bool loadStaticFieldCache(const std::string& path, uint64_t hash, StaticFieldGrid& grid) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint64_t fileHash = 0;
+    int32_t resolution = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&fileHash), sizeof(fileHash));
+    file.read(reinterpret_cast<char*>(&resolution), sizeof(resolution));
+    if (!file || std::memcmp(magic, kStaticFieldMagic, sizeof(magic)) != 0 || version != kStaticFieldFormatVersion
+        || fileHash != hash || resolution < 2) {
+        return false;
+    }
+
+    grid.resolution = resolution;
+    file.read(reinterpret_cast<char*>(&grid.boundsMin), sizeof(float) * 3);
+    file.read(reinterpret_cast<char*>(&grid.boundsMax), sizeof(float) * 3);
+    grid.distances.resize((size_t)resolution * resolution * resolution);
+    file.read(reinterpret_cast<char*>(grid.distances.data()), grid.distances.size() * sizeof(float));
+    return (bool)file;
+}
+
+bool saveStaticFieldCache(const std::string& path, uint64_t hash, const StaticFieldGrid& grid) {
+    std::error_code ec;
+    fs::create_directories(fs::path(path).parent_path(), ec);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    int32_t resolution = grid.resolution;
+    file.write(kStaticFieldMagic, sizeof(kStaticFieldMagic));
+    file.write(reinterpret_cast<const char*>(&kStaticFieldFormatVersion), sizeof(kStaticFieldFormatVersion));
+    file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+    file.write(reinterpret_cast<const char*>(&resolution), sizeof(resolution));
+    file.write(reinterpret_cast<const char*>(&grid.boundsMin), sizeof(float) * 3);
+    file.write(reinterpret_cast<const char*>(&grid.boundsMax), sizeof(float) * 3);
+    file.write(reinterpret_cast<const char*>(grid.distances.data()), grid.distances.size() * sizeof(float));
+    return (bool)file;
+}
+
+bool updateStaticField(StaticField& field, const SdfScene& scene, int resolution, const std::string& cacheDirectory) {
+    std::vector<SdfFlatObject> objects = staticObjects(scene);
+    StaticFieldGrid grid;
+    grid.resolution = std::max(2, resolution);
+    if (!staticFieldBounds(objects, grid.boundsMin, grid.boundsMax)) {
+        destroyStaticField(field);
+        return false;
+    }
+
+    uint64_t hash = staticFieldHash(objects, grid.resolution);
+    if (field.texture != 0 && field.hash == hash) {
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::string path = cachePath(cacheDirectory, hash);
+    field.fromCache = loadStaticFieldCache(path, hash, grid);
+    if (!field.fromCache) {
+        bakeStaticField(objects, grid);
+        if (!saveStaticFieldCache(path, hash, grid)) {
+            std::cerr << "Failed to write static field cache " << path << std::endl;
+        }
+    }
+    field.bakeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Static field " << grid.resolution << "^3 " << (field.fromCache ? "loaded from cache" : "baked")
+              << " in " << field.bakeMilliseconds << " ms" << std::endl;
+
+    if (field.texture == 0) {
+        glGenTextures(1, &field.texture);
+    }
+    glBindTexture(GL_TEXTURE_3D, field.texture);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_R16F, grid.resolution, grid.resolution, grid.resolution, 0, GL_RED, GL_FLOAT, grid.distances.data());
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    // L'interpolation trilinéaire d'une SDF s'écarte au plus d'une demi-diagonale de cellule de la distance exacte
+    glm::vec3 cell = (grid.boundsMax - grid.boundsMin) / (float)(grid.resolution - 1);
+    float diagonal = glm::length(cell);
+    field.resolution = grid.resolution;
+    field.boundsMin = grid.boundsMin;
+    field.boundsMax = grid.boundsMax;
+    field.margin = 0.5f * diagonal;
+    field.band = 2.0f * diagonal;
+    field.hash = hash;
+    return true;
+}
+
+void destroyStaticField(StaticField& field) {
+    if (field.texture != 0) {
+        glDeleteTextures(1, &field.texture);
+    }
+    field = StaticField();
+}
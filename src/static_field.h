@@ -0,0 +1,57 @@
+#ifndef STATIC_FIELD_H
+#define STATIC_FIELD_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sdf_scene.h"
+
+// Distances des objets statiques du graphe de scène échantillonnées sur une grille régulière
+struct StaticFieldGrid {
+    int resolution = 0; // Échantillons par axe, aux extrémités comprises
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    std::vector<float> distances; // x le plus rapide, puis y, puis z
+};
+
+// Texture 3D lue par staticFieldDistance() dans le fragment shader
+struct StaticField {
+    GLuint texture = 0;
+    int resolution = 0;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    float band = 0.0f;   // Distance sous laquelle le shader repasse aux SDF analytiques
+    float margin = 0.0f; // Erreur maximale du filtrage trilinéaire, retranchée aux distances lues
+    uint64_t hash = 0;   // Clé du cache : objets statiques, résolution et format
+
+    // Dernière mise à jour
+    double bakeMilliseconds = 0.0;
+    bool fromCache = false;
+};
+
+// Objets du graphe qui ne dépendent d'aucun paramètre animé
+std::vector<SdfFlatObject> staticObjects(const SdfScene& scene);
+
+// Volume échantillonné : boîte des objets statiques finis élargie d'une marge, descendue sous le plan au sol.
+// Renvoie faux s'il n'y a aucun objet statique fini.
+bool staticFieldBounds(const std::vector<SdfFlatObject>& objects, glm::vec3& boundsMin, glm::vec3& boundsMax);
+
+// Hachage FNV-1a des objets statiques, de la résolution et du format du cache
+uint64_t staticFieldHash(const std::vector<SdfFlatObject>& objects, int resolution);
+
+// Échantillonne les objets sur la grille, une tranche z par tâche répartie sur tous les cœurs
+void bakeStaticField(const std::vector<SdfFlatObject>& objects, StaticFieldGrid& grid);
+
+bool loadStaticFieldCache(const std::string& path, uint64_t hash, StaticFieldGrid& grid);
+bool saveStaticFieldCache(const std::string& path, uint64_t hash, const StaticFieldGrid& grid);
+
+// Met à jour field pour les objets statiques de scene. Rien n'est fait si la clé est inchangée ; sinon la grille
+// est lue dans cacheDirectory ou précalculée puis enregistrée, et la texture est envoyée.
+// Renvoie faux (et libère la texture) s'il n'y a aucun objet statique fini.
+bool updateStaticField(StaticField& field, const SdfScene& scene, int resolution, const std::string& cacheDirectory);
+
+void destroyStaticField(StaticField& field);
+
+#endif
@@ -3,30 +3,78 @@
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <string>
+#include <algorithm>
 #include <filesystem>
+#include <chrono>
+#include <cstdio>
 #include "../include/tiny_obj_loader.h"
+#include "uniform_ring.h"
+#include "program_cache.h"
+#include "gpu_profiler.h"
+#include "../include/imgui.h"
+#include "../include/imgui_impl_glfw.h"
+#include "../include/imgui_impl_opengl3.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 namespace fs = std::filesystem;
 
+// Uniform block binding points
+const GLuint kFrameUniformsBinding = 0;
+const GLuint kDrawUniformsBinding = 1;
+
+// std140 mirror of the FrameUniforms block: vec3 values are widened to vec4
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 lightPos;
+    glm::vec4 viewPos;
+    glm::vec4 lightColor;
+};
+static_assert(sizeof(FrameUniforms) == 176, "FrameUniforms must match the std140 layout of the shader block");
+
+// std140 mirror of the DrawUniforms block, the shininess is stored in specularColor.w
+struct DrawUniforms {
+    glm::mat4 model;
+    glm::mat4 normalMatrix;
+    glm::vec4 ambientColor;
+    glm::vec4 diffuseColor;
+    glm::vec4 specularColor;
+};
+static_assert(sizeof(DrawUniforms) == 176, "DrawUniforms must match the std140 layout of the shader block");
+
 // Shader sources
 const char* vertexShaderSource = R"(
 #version 330 core
 layout(location = 0) in vec3 aPos;
 layout(location = 1) in vec3 aNormal;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Per-frame and per-draw constants, written into a persistently mapped ring buffer (uniform_ring.cpp).
+// Member order and padding must match FrameUniforms and DrawUniforms on the C++ side.
+layout(std140) uniform FrameUniforms {
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;   // xyz
+    vec4 viewPos;    // xyz
+    vec4 lightColor; // xyz
+};
+
+layout(std140) uniform DrawUniforms {
+    mat4 model;
+    mat4 normalMatrix; // transpose(inverse(model)), computed once on the CPU instead of per vertex
+    vec4 ambientColor;  // xyz
+    vec4 diffuseColor;  // xyz
+    vec4 specularColor; // xyz, w = shininess
+};
 
 out vec3 FragPos;
 out vec3 Normal;
 
 void main() {
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = mat3(normalMatrix) * aNormal;
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
 )";
@@ -38,27 +86,33 @@ in vec3 Normal;
 
 out vec4 FragColor;
 
-uniform vec3 lightPos;
-uniform vec3 viewPos;
-uniform vec3 lightColor;
-
-// Material properties
-uniform vec3 ambientColor;
-uniform vec3 diffuseColor;
-uniform vec3 specularColor;
-uniform float shininess;
+layout(std140) uniform FrameUniforms {
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 viewPos;
+    vec4 lightColor;
+};
+
+layout(std140) uniform DrawUniforms {
+    mat4 model;
+    mat4 normalMatrix;
+    vec4 ambientColor;
+    vec4 diffuseColor;
+    vec4 specularColor;
+};
 
 // Default material colors
-uniform vec3 defaultAmbientColor = vec3(0.1, 0.1, 0.1);
-uniform vec3 defaultDiffuseColor = vec3(0.8, 0.8, 0.8);
-uniform vec3 defaultSpecularColor = vec3(0.5, 0.5, 0.5);
-uniform float defaultShininess = 32.0;
+const vec3 defaultAmbientColor = vec3(0.1, 0.1, 0.1);
+const vec3 defaultDiffuseColor = vec3(0.8, 0.8, 0.8);
+const vec3 defaultSpecularColor = vec3(0.5, 0.5, 0.5);
+const float defaultShininess = 32.0;
 
 void main() {
-    vec3 ambient = ambientColor;
-    vec3 diffuse = diffuseColor;
-    vec3 specular = specularColor;
-    float shiny = shininess;
+    vec3 ambient = ambientColor.xyz;
+    vec3 diffuse = diffuseColor.xyz;
+    vec3 specular = specularColor.xyz;
+    float shiny = specularColor.w;
 
     if (ambient == vec3(0.0) && diffuse == vec3(0.0) && specular == vec3(0.0) && shiny == 0.0) {
         ambient = defaultAmbientColor;
@@ -68,19 +122,19 @@ void main() {
     }
 
     // Ambient
-    vec3 ambientLight = ambient * lightColor;
+    vec3 ambientLight = ambient * lightColor.xyz;
 
     // Diffuse
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuseLight = diff * diffuse * lightColor;
+    vec3 diffuseLight = diff * diffuse * lightColor.xyz;
 
     // Specular
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), shiny);
-    vec3 specularLight = spec * specular * lightColor;
+    vec3 specularLight = spec * specular * lightColor.xyz;
 
     vec3 result = ambientLight + diffuseLight + specularLight;
     FragColor = vec4(result, 1.0);
@@ -112,6 +166,10 @@ GLuint createShaderProgram(const char* vertexSource, const char* fragmentSource)
     GLuint shaderProgram = glCreateProgram();
     glAttachShader(shaderProgram, vertexShader);
     glAttachShader(shaderProgram, fragmentShader);
+    // Allow the linked binary to be stored in the program cache
+    if (GLEW_ARB_get_program_binary) {
+        glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(shaderProgram);
 
     int success;
@@ -165,6 +223,20 @@ bool loadOBJ(const char* path, std::vector<float>& vertices, std::vector<float>&
     return true;
 }
 
+// On-demand rendering: the last presented frame is kept until an input or a resize requests new ones.
+// ImGui needs a few frames after an event for its widgets to reflect the input.
+const int kFramesAfterEvent = 3;
+bool onDemandRendering = true;
+int framesToRender = kFramesAfterEvent;
+long long renderedFrames = 0;
+
+void requestRedraw() {
+    framesToRender = kFramesAfterEvent;
+}
+
+// Tab releases the cursor so that the profiler overlay can be used, and captures it again for the camera
+bool overlayInteractive = false;
+
 // Camera control variables
 bool firstMouse = true;
 float lastX = 400, lastY = 300;
@@ -173,8 +245,12 @@ float radius = 3.0f;
 float cameraX = 0.0f, cameraY = 0.0f, cameraZ = radius;
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
-    static float lastX = 400, lastY = 300;
-    static bool firstMouse = true;
+    if (overlayInteractive) {
+        // The camera ignores the cursor while it is released; the next captured move restarts from here
+        firstMouse = true;
+        requestRedraw();
+        return;
+    }
     if (firstMouse) {
         lastX = xpos;
         lastY = ypos;
@@ -199,6 +275,10 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
     cameraX = radius * cos(glm::radians(pitch)) * cos(glm::radians(yaw));
     cameraY = radius * sin(glm::radians(pitch));
     cameraZ = radius * cos(glm::radians(pitch)) * sin(glm::radians(yaw));
+
+    if (xoffset != 0.0f || yoffset != 0.0f) {
+        requestRedraw();
+    }
 }
 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
@@ -208,13 +288,45 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
     cameraX = radius * cos(glm::radians(pitch)) * cos(glm::radians(yaw));
     cameraY = radius * sin(glm::radians(pitch));
     cameraZ = radius * cos(glm::radians(pitch)) * sin(glm::radians(yaw));
+    requestRedraw();
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (key == GLFW_KEY_TAB && action == GLFW_PRESS) {
+        overlayInteractive = !overlayInteractive;
+        glfwSetInputMode(window, GLFW_CURSOR, overlayInteractive ? GLFW_CURSOR_NORMAL : GLFW_CURSOR_DISABLED);
+    }
+    requestRedraw();
+}
+
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    requestRedraw();
+}
+
+// The window contents were damaged or resized: the last frame must be presented again
+void refresh_callback(GLFWwindow* window) {
+    requestRedraw();
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    requestRedraw();
 }
 
 int main(int argc, char** argv) {
     if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <OBJ file name>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <OBJ file name> [--continuous] [--profile-csv FILE]" << std::endl;
         return -1;
     }
+    // --continuous restores redrawing every frame, even when nothing changes
+    // --profile-csv writes the GPU and CPU timings of the last frames to FILE on exit
+    std::string profileCsv;
+    for (int i = 2; i < argc; ++i) {
+        if (std::string(argv[i]) == "--continuous") {
+            onDemandRendering = false;
+        } else if (std::string(argv[i]) == "--profile-csv" && i + 1 < argc) {
+            profileCsv = argv[++i];
+        }
+    }
 
     const char* objFileName = argv[1];
     std::string basePath = "../src/ressources/obj/";
@@ -243,6 +355,14 @@ int main(int argc, char** argv) {
     // Set the scroll callback
     glfwSetScrollCallback(window, scroll_callback);
 
+    // Tab toggles the profiler overlay input, clicks redraw it
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
+
+    // Redraw when the window is exposed or resized
+    glfwSetWindowRefreshCallback(window, refresh_callback);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
     // Capture the mouse
     glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
@@ -252,8 +372,36 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    // Build and compile our shader program
-    GLuint shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+    // Build and compile our shader program, or load its binary from a previous launch
+    auto startupStart = std::chrono::steady_clock::now();
+    ProgramCacheStats programCacheStats;
+    uint64_t programKey = programCacheKey(vertexShaderSource, fragmentShaderSource, "tinyobj");
+    GLuint shaderProgram = createCachedProgram("../cache", programKey, []() {
+        return createShaderProgram(vertexShaderSource, fragmentShaderSource);
+    }, &programCacheStats);
+    double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupStart).count();
+    std::cout << "Shader program ready in " << startupMs << " ms ("
+              << (programCacheStats.hits > 0 ? "warm start, loaded from cache" : "cold start, compiled") << ")" << std::endl;
+    glUniformBlockBinding(shaderProgram, glGetUniformBlockIndex(shaderProgram, "FrameUniforms"), kFrameUniformsBinding);
+    glUniformBlockBinding(shaderProgram, glGetUniformBlockIndex(shaderProgram, "DrawUniforms"), kDrawUniformsBinding);
+
+    UniformRing uniformRing;
+    if (!createUniformRing(uniformRing, 64 * 1024)) {
+        std::cerr << "Failed to create uniform ring buffer" << std::endl;
+        return -1;
+    }
+
+    // Profiler overlay, installed after the callbacks above so that ImGui chains them
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    ImGui_ImplOpenGL3_Init("#version 330");
+
+    // GPU and CPU timings of the OBJ and ImGui draws, read a few frames late
+    GpuProfiler profiler;
+    if (!initGpuProfiler(profiler)) {
+        std::cerr << "Failed to create the GPU profiler queries" << std::endl;
+    }
 
     // Load the OBJ file
     std::vector<float> vertices;
@@ -294,7 +442,17 @@ int main(int argc, char** argv) {
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
             glfwSetWindowShouldClose(window, true);
 
+        // Nothing changed since the last presented frame: block until the next event
+        if (onDemandRendering && framesToRender == 0) {
+            glfwWaitEvents();
+            continue;
+        }
+        framesToRender = std::max(0, framesToRender - 1);
+
         // Render
+        beginProfilerFrame(profiler);
+        int objScope = beginProfilerScope(profiler, "OBJ");
+        auto submitStart = std::chrono::steady_clock::now();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // Activate shader
@@ -303,48 +461,88 @@ int main(int argc, char** argv) {
         // Create transformations
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::rotate(model, glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f)); // Rotate 180 degrees around the X axis
-        glm::mat4 view = glm::lookAt(glm::vec3(cameraX, cameraY, cameraZ), glm::vec3(0.0f, 0.2f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
-
-        // Set uniforms
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
 
-        glUniform3f(glGetUniformLocation(shaderProgram, "lightPos"), 1.2f, 1.0f, 2.0f);
-        glUniform3f(glGetUniformLocation(shaderProgram, "viewPos"), cameraX, cameraY, cameraZ);
-        glUniform3f(glGetUniformLocation(shaderProgram, "lightColor"), 1.0f, 1.0f, 1.0f);
-
-        // Set material properties if available, otherwise use default
+        // Per-frame block: one memcpy into the ring and one glBindBufferRange
+        FrameUniforms frame;
+        frame.view = glm::lookAt(glm::vec3(cameraX, cameraY, cameraZ), glm::vec3(0.0f, 0.2f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        frame.projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+        frame.lightPos = glm::vec4(1.2f, 1.0f, 2.0f, 0.0f);
+        frame.viewPos = glm::vec4(cameraX, cameraY, cameraZ, 0.0f);
+        frame.lightColor = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+        bindUniformRingBlock(uniformRing, kFrameUniformsBinding, &frame, sizeof(frame));
+
+        // Per-draw block, with the material properties if available, otherwise the default
+        DrawUniforms draw;
+        draw.model = model;
+        draw.normalMatrix = glm::transpose(glm::inverse(model));
         if (!materials.empty()) {
-            tinyobj::material_t mat = materials[0];
-            glUniform3f(glGetUniformLocation(shaderProgram, "ambientColor"), mat.ambient[0], mat.ambient[1], mat.ambient[2]);
-            glUniform3f(glGetUniformLocation(shaderProgram, "diffuseColor"), mat.diffuse[0], mat.diffuse[1], mat.diffuse[2]);
-            glUniform3f(glGetUniformLocation(shaderProgram, "specularColor"), mat.specular[0], mat.specular[1], mat.specular[2]);
-            glUniform1f(glGetUniformLocation(shaderProgram, "shininess"), mat.shininess);
+            const tinyobj::material_t& mat = materials[0];
+            draw.ambientColor = glm::vec4(mat.ambient[0], mat.ambient[1], mat.ambient[2], 0.0f);
+            draw.diffuseColor = glm::vec4(mat.diffuse[0], mat.diffuse[1], mat.diffuse[2], 0.0f);
+            draw.specularColor = glm::vec4(mat.specular[0], mat.specular[1], mat.specular[2], mat.shininess);
         } else {
-            glUniform3f(glGetUniformLocation(shaderProgram, "ambientColor"), 0.1f, 0.1f, 0.1f);
-            glUniform3f(glGetUniformLocation(shaderProgram, "diffuseColor"), 0.8f, 0.8f, 0.8f);
-            glUniform3f(glGetUniformLocation(shaderProgram, "specularColor"), 0.5f, 0.5f, 0.5f);
-            glUniform1f(glGetUniformLocation(shaderProgram, "shininess"), 32.0f);
+            draw.ambientColor = glm::vec4(0.1f, 0.1f, 0.1f, 0.0f);
+            draw.diffuseColor = glm::vec4(0.8f, 0.8f, 0.8f, 0.0f);
+            draw.specularColor = glm::vec4(0.5f, 0.5f, 0.5f, 32.0f);
         }
+        bindUniformRingBlock(uniformRing, kDrawUniformsBinding, &draw, sizeof(draw));
 
         // Render the OBJ
         glBindVertexArray(VAO);
         glDrawArrays(GL_TRIANGLES, 0, vertices.size() / 3);
         glBindVertexArray(0);
+        double submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submitStart).count();
+        endProfilerScope(profiler, objScope);
+
+        // Profiler overlay
+        int imguiScope = beginProfilerScope(profiler, "ImGui");
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Profiler");
+        ImGui::TextUnformatted(overlayInteractive ? "Tab: capture the cursor for the camera" : "Tab: release the cursor");
+        drawProfilerPanel(profiler, "tinyobj_profile.csv");
+        ImGui::End();
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        endProfilerScope(profiler, imguiScope);
+        endProfilerFrame(profiler);
 
         // Swap buffers
         glfwSwapBuffers(window);
 
+        // Frame counter in the title bar, to check that an idle viewer stops rendering
+        ++renderedFrames;
+        char submitText[32];
+        std::snprintf(submitText, sizeof(submitText), "%.3f", submitMs);
+        std::string title = "OpenGL OBJ Loader - " + std::to_string(renderedFrames) + " frames, CPU submit "
+                          + submitText + " ms";
+        glfwSetWindowTitle(window, title.c_str());
+
         // Poll for and process events
         glfwPollEvents();
     }
 
+    if (!profileCsv.empty()) {
+        collectProfilerResults(profiler, true);
+        if (writeProfilerCsv(profiler, profileCsv)) {
+            std::cout << "Profile written to " << profileCsv << " (" << profiler.history.size() << " frames)" << std::endl;
+        } else {
+            std::cerr << "Failed to write " << profileCsv << std::endl;
+        }
+    }
+
     // Cleanup
+    destroyGpuProfiler(profiler);
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+    ImGui::DestroyContext();
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &NBO);
+    destroyUniformRing(uniformRing);
+    glDeleteProgram(shaderProgram);
 
     glfwDestroyWindow(window);
     glfwTerminate();
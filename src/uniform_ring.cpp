@@ -0,0 +1,94 @@
+#include "uniform_ring.h"
+#include <cstring>
+
+bool createUniformRing(UniformRing& ring, GLsizeiptr segmentSize) {
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &ring.alignment);
+    if (ring.alignment <= 0) {
+        ring.alignment = 256;
+    }
+    // Chaque segment commence sur une frontière d'alignement
+    ring.segmentSize = (segmentSize + ring.alignment - 1) / ring.alignment * ring.alignment;
+    GLsizeiptr totalSize = ring.segmentSize * kUniformRingSegments;
+
+    glGenBuffers(1, &ring.buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, ring.buffer);
+    if (GLEW_ARB_buffer_storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, totalSize, nullptr, flags);
+        ring.mapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags));
+    }
+    if (!ring.mapped) {
+        // glBufferStorage est immuable : un nouveau tampon est nécessaire si le mapping a échoué
+        if (GLEW_ARB_buffer_storage) {
+            glDeleteBuffers(1, &ring.buffer);
+            glGenBuffers(1, &ring.buffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, ring.buffer);
+        }
+        glBufferData(GL_UNIFORM_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    ring.segment = 0;
+    ring.head = 0;
+    return ring.buffer != 0;
+}
+
+// Ferme le segment courant par une fence et attend que le GPU ait fini de lire le suivant
+static void advanceSegment(UniformRing& ring) {
+    ring.fences[ring.segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ring.segment = (ring.segment + 1) % kUniformRingSegments;
+    ring.head = 0;
+
+    GLsync& fence = ring.fences[ring.segment];
+    if (!fence) {
+        return;
+    }
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        ++ring.fenceWaits;
+        // Le premier appel vide la file de commandes pour que la fence finisse par être atteinte
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        do {
+            status = glClientWaitSync(fence, flags, 1000000000);
+            flags = 0;
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void bindUniformRingBlock(UniformRing& ring, GLuint binding, const void* data, GLsizeiptr size) {
+    GLsizeiptr alignedSize = (size + ring.alignment - 1) / ring.alignment * ring.alignment;
+    if (ring.head + alignedSize > ring.segmentSize) {
+        advanceSegment(ring);
+    }
+    GLintptr offset = ring.segment * ring.segmentSize + ring.head;
+    ring.head += alignedSize;
+
+    if (ring.mapped) {
+        std::memcpy(ring.mapped + offset, data, size);
+    } else {
+        glBindBuffer(GL_UNIFORM_BUFFER, ring.buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, ring.buffer, offset, size);
+}
+
+void destroyUniformRing(UniformRing& ring) {
+    for (GLsync& fence : ring.fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (ring.buffer != 0) {
+        if (ring.mapped) {
+            glBindBuffer(GL_UNIFORM_BUFFER, ring.buffer);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            ring.mapped = nullptr;
+        }
+        glDeleteBuffers(1, &ring.buffer);
+        ring.buffer = 0;
+    }
+}
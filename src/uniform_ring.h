@@ -0,0 +1,35 @@
+#ifndef UNIFORM_RING_H
+#define UNIFORM_RING_H
+
+#include <GL/glew.h>
+
+// Nombre de segments de l'anneau : le GPU peut encore lire les deux segments précédents pendant
+// que le CPU écrit dans le segment courant
+const int kUniformRingSegments = 3;
+
+// Tampon d'uniformes en anneau, découpé en segments protégés chacun par une fence. Avec
+// ARB_buffer_storage, le tampon est mappé une fois pour toutes (persistant et cohérent) et chaque bloc
+// est un memcpy dans la mémoire mappée ; sinon les blocs sont envoyés par glBufferSubData.
+// Les blocs sont alignés sur GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT pour glBindBufferRange.
+struct UniformRing {
+    GLuint buffer = 0;
+    unsigned char* mapped = nullptr; // nul sans mapping persistant
+    GLsizeiptr segmentSize = 0;
+    GLint alignment = 256;
+    int segment = 0;      // Segment en cours d'écriture
+    GLsizeiptr head = 0;  // Position d'écriture dans le segment courant
+    GLsync fences[kUniformRingSegments] = {};
+    long long fenceWaits = 0; // Nombre de fois où le CPU a dû attendre le GPU avant de réécrire un segment
+};
+
+// Crée le tampon, segmentSize octets par segment. Un contexte OpenGL doit être courant.
+bool createUniformRing(UniformRing& ring, GLsizeiptr segmentSize);
+
+// Copie size octets de data dans l'anneau et lie la plage écrite au point de liaison binding de
+// GL_UNIFORM_BUFFER. Quand le segment courant est plein, il est fermé par une fence et l'écriture passe
+// au segment suivant, après avoir attendu que le GPU ait fini de le lire.
+void bindUniformRingBlock(UniformRing& ring, GLuint binding, const void* data, GLsizeiptr size);
+
+void destroyUniformRing(UniformRing& ring);
+
+#endif